@@ -356,6 +356,80 @@ WriteSingleLevelPlotfile (const std::string& plotfilename,
 }
 
 
+void
+WriteRawGrids (const std::string& dirname, const std::string& filename,
+               const MultiFab& mf, const Vector<std::string>& varnames,
+               const Box& domain)
+{
+    BL_PROFILE("WriteRawGrids()");
+
+    const int ncomp = static_cast<int>(varnames.size());
+    AMREX_ALWAYS_ASSERT(ncomp <= mf.nComp());
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mf.boxArray().contains(domain),
+                                     "WriteRawGrids: the MultiFab must cover the whole domain");
+
+    // Cut the domain into slabs along the slowest varying direction and give
+    // one to each process.  Each slab is then a contiguous block of the
+    // Fortran-ordered file and can be written with a single seek.
+    constexpr int dir = AMREX_SPACEDIM-1;
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int nslabs = std::min(nprocs, domain.length(dir));
+    BoxList bl;
+    Vector<int> pmap(nslabs);
+    for (int i = 0; i < nslabs; ++i) {
+        Box b = domain;
+        b.setSmall(dir, domain.smallEnd(dir) + static_cast<int>((Long(domain.length(dir))*i)/nslabs));
+        b.setBig(dir, domain.smallEnd(dir) + static_cast<int>((Long(domain.length(dir))*(i+1))/nslabs) - 1);
+        bl.push_back(b);
+        pmap[i] = i;
+    }
+
+    MultiFab slabs(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)), ncomp, 0,
+                   MFInfo().SetArena(The_Pinned_Arena()));
+    slabs.ParallelCopy(mf, 0, 0, ncomp);
+    Gpu::streamSynchronize();
+
+    if (ParallelDescriptor::IOProcessor()) {
+        for (auto const& name : varnames) {
+            const std::string vardir = dirname + "/" + name;
+            if ( ! amrex::UtilCreateDirectory(vardir, 0755)) {
+                amrex::CreateDirectoryFailed(vardir);
+            }
+            const std::string fullname = vardir + "/" + filename;
+            std::ofstream ofs(fullname.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+            if ( ! ofs.good()) { amrex::FileOpenFailed(fullname); }
+        }
+    }
+    ParallelDescriptor::Barrier("WriteRawGrids:create");
+
+    const RealDescriptor little_endian_float(FPC::ieee_float, FPC::reverse_float_order, 4);
+    const Long nperslab = domain.numPts() / domain.length(dir);
+    const int nconcurrent = std::max(1, std::min(VisMF::GetNOutFiles(), nprocs));
+    const int nrounds = (nprocs + nconcurrent - 1) / nconcurrent;
+
+    for (int iround = 0; iround < nrounds; ++iround) {
+        if (ParallelDescriptor::MyProc() % nrounds == iround) {
+            for (MFIter mfi(slabs); mfi.isValid(); ++mfi) {
+                const Box& bx = mfi.validbox();
+                const Long offset = (bx.smallEnd(dir) - domain.smallEnd(dir)) * nperslab * 4;
+                for (int n = 0; n < ncomp; ++n) {
+                    const std::string fullname = dirname + "/" + varnames[n] + "/" + filename;
+                    std::fstream ofs(fullname.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+                    if ( ! ofs.good()) { amrex::FileOpenFailed(fullname); }
+                    ofs.seekp(offset, std::ios::beg);
+                    RealDescriptor::convertFromNativeFormat(ofs, bx.numPts(), slabs[mfi].dataPtr(n),
+                                                            little_endian_float);
+                    if ( ! ofs.good()) {
+                        amrex::Abort("WriteRawGrids: failed to write " + fullname);
+                    }
+                }
+            }
+        }
+        ParallelDescriptor::Barrier("WriteRawGrids:write");
+    }
+}
+
+
 #ifdef AMREX_USE_EB
 void
 EB_WriteSingleLevelPlotfile (const std::string& plotfilename,
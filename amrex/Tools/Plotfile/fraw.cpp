@@ -0,0 +1,113 @@
+#include <AMReX.H>
+#include <AMReX_Print.H>
+#include <AMReX_PlotFileUtil.H>
+#include <string>
+
+// write the variables of plotfiles as raw grids, one file per variable and
+// plotfile, so that they can be read without any AMReX-specific reader.
+
+using namespace amrex;
+
+void main_main()
+{
+    const int narg = amrex::command_argument_count();
+
+    std::string outdir = ".";
+    Vector<std::string> var_names_arg;
+    int level = 0;
+
+    int farg = 1;
+    while (farg <= narg) {
+        const std::string& name = amrex::get_command_argument(farg);
+        if (name == "-o" || name == "--outdir") {
+            outdir = amrex::get_command_argument(++farg);
+        } else if (name == "-v" || name == "--variable") {
+            var_names_arg.push_back(amrex::get_command_argument(++farg));
+        } else if (name == "-l" || name == "--level") {
+            level = std::stoi(amrex::get_command_argument(++farg));
+        } else {
+            break;
+        }
+        ++farg;
+    }
+
+    if (farg > narg) {
+        amrex::Print()
+            << "\n"
+            << " Write the variables of one or more plotfiles as raw grids.\n"
+            << "\n"
+            << " Each plotfile is read once, and variable 'var' of plotfile 'pltNNNNN'\n"
+            << " is written to outdir/var/NNNNN.raw as little-endian 32-bit floats in\n"
+            << " Fortran order (x fastest) covering the whole domain of the level.\n"
+            << " The level has to cover the whole domain.\n"
+            << "\n"
+            << " Usage:\n"
+            << "    fraw [-o outdir] [-v variable ...] [-l level] plotfile [plotfile ...]\n"
+            << "\n"
+            << " args [-o|--outdir]    dir          : output directory (default: .)\n"
+            << "      [-v|--variable]  varname      : write only this variable, may be repeated\n"
+            << "                                      (default: all variables)\n"
+            << "      [-l|--level]     level        : level to write (default: 0)\n"
+            << "\n"
+            << '\n';
+        return;
+    }
+
+    for ( ; farg <= narg; ++farg) {
+        std::string pltfile = amrex::get_command_argument(farg);
+        while (pltfile.size() > 1 && pltfile.back() == '/') {
+            pltfile.pop_back();
+        }
+
+        PlotFileData pf(pltfile);
+
+        if (level < 0 || level > pf.finestLevel()) {
+            amrex::Abort("Error: plotfile " + pltfile + " does not have level " + std::to_string(level));
+        }
+
+        const Vector<std::string>& var_names_pf = pf.varNames();
+        Vector<std::string> var_names = var_names_arg.empty() ? var_names_pf : var_names_arg;
+
+        // the output file is named after the digits at the end of the plotfile name
+
+        std::string base = pltfile.substr(pltfile.find_last_of('/') + 1);
+        auto pos = base.find_last_not_of("0123456789");
+        std::string filename = ((pos == std::string::npos) ? base : base.substr(pos + 1)) + ".raw";
+        if (filename == ".raw") {
+            filename = base + ".raw";
+        }
+
+        amrex::Print() << " " << pltfile << " -> " << outdir << "/<variable>/" << filename << "\n";
+
+        // read all variables in a single pass over the FABs, and then select the
+        // requested ones
+
+        const int nvars = static_cast<int>(var_names.size());
+        MultiFab mf_all = pf.get(level);
+        MultiFab mf(mf_all.boxArray(), mf_all.DistributionMap(), nvars, 0);
+
+        for (int n = 0; n < nvars; ++n) {
+            int icomp = -1;
+            for (int m = 0; m < pf.nComp(); ++m) {
+                if (var_names_pf[m] == var_names[n]) {
+                    icomp = m;
+                    break;
+                }
+            }
+            if (icomp < 0) {
+                amrex::Abort("Error: invalid variable name " + var_names[n]);
+            }
+            MultiFab::Copy(mf, mf_all, icomp, n, 1, 0);
+        }
+
+        WriteRawGrids(outdir, filename, mf, var_names, pf.probDomain(level));
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::SetVerbose(0);
+    amrex::Initialize(argc, argv, false);
+    main_main();
+    amrex::Finalize();
+}
@@ -31,6 +31,7 @@ SELFGRAVITY                                   # switch to enable self-gravity of
 #EXTRAPOTTERM                                 # this computes an extra multipole term for the potential which is not needed for the forces
 #EXTRA_HIGH_EWALD_ACCURACY                    # this uses third-order instead of second-order Taylor expansion to interpolate Ewald corrections from table 
 #ALLOW_DIRECT_SUMMATION                       # allows calculation of direct summation gravity force if only a tiny number of particles as active 
+#GRAVITY_TREE_REUSE                           # keeps the gravity tree between domain decompositions and only updates it for the new positions
 #EXTERNALGRAVITY                              # switches on inclusion of external gravitational potential
 #EXTERNALGRAVITY_STATICHQ                     # example for a simple external potential due to a Hernquist halo
 
@@ -44,6 +45,8 @@ SELFGRAVITY                                   # switch to enable self-gravity of
 #HRPMGRID=512                                 # dimension of high-res PM grid (optional, default is HRPMGRID=PMGRID)
 #FFT_COLUMN_BASED                             # uses a column-based FFT algorithm instead of the default slab-based one
 #PM_ZOOM_OPTIMIZED                            # selects a communication strategy in the PM code that is better balanced for zoom simulations
+#PM_SPECTRAL_DIFFERENCING                     # obtains the periodic PM forces by spectral differentiation instead of finite differencing
+#PM_ASSIGNMENT_ORDER=3                        # mass assignment of the periodic PM mesh: 2 = CIC (default), 3 = TSC, 4 = PCS
 #TREE_NUM_BEFORE_NODESPLIT=4                  # number of particles are are at most allowed in a tree node before it is split (can be 1)
 
 
@@ -69,6 +72,7 @@ SELFGRAVITY                                   # switch to enable self-gravity of
 #GAMMA=1.4                                    # sets the adiabatic index
 #ISOTHERM_EQS                                 # selects an isothermal equation of state
 #IMPROVED_VELOCITY_GRADIENTS                  # use higher-order gradients of the velocities according to Hu et. al (2014)
+#SPH_KNN_HSML                                 # selects the smoothing lengths from the candidate neighbours of a single enlarged walk
 
 
 #--------------------------------------- SPH kernels
@@ -90,6 +94,7 @@ SELFGRAVITY                                   # switch to enable self-gravity of
 #--------------------------------------- Extra physics
 
 #COOLING                                      # Enables radiative atomic cooling by hydrogen and helium
+#COOLING_EQUILIBRIUM_TABLE                    # cools all active gas particles together with a table of equilibrium rates in (log u, log nH)
 #STARFORMATION                                # Enables star formation with the Springel & Hernquist (2003) model
 
 
@@ -128,7 +133,10 @@ INITIAL_CONDITIONS_CONTAIN_ENTROPY
 #OUTPUT_ACCELERATIONS_IN_HALF_PRECISION       # special option to store acclerations in reduced precision
 #OUTPUT_COORDINATES_AS_INTEGERS               # special option to store coordinates as integers that are used internally
 #POWERSPEC_ON_OUTPUT                          # computes a matter power spectrum when the code writes a snapshot output
-#ALLOW_HDF5_COMPRESSION                       # applies HDF5 loss-less compression to selected output fields
+#DENSITYGRID_ON_OUTPUT                        # deposits selected fields onto uniform grids and writes them when the code writes a snapshot output
+#ALLOW_HDF5_COMPRESSION                       # applies HDF5 compression to selected output fields, configurable per dataset with HDF5CompressionPolicy
+#ASYNC_SNAPSHOT_OUTPUT                        # stages HDF5 snapshot files in memory and writes them in a background thread while the run continues
+#SNAPSHOT_PHKEY_INDEX                         # stores a Peano-Hilbert key index in HDF5 snapshots, allows reading only selected fields and a region
 #REDUCE_FLUSH                                 # do not flush the I/O streams of the log-files every system step
 
 
@@ -148,6 +156,7 @@ INITIAL_CONDITIONS_CONTAIN_ENTROPY
 #SUBFIND_HBT                                  # use previous subhalo catalogue instead of density excursions to define subhalo candidates
 #SUBFIND_STORE_LOCAL_DENSITY                  # calculates local densities and velocity dispersions for all particles and stores them in snapshots
 #SUBFIND_ORPHAN_TREATMENT                     # creates special snapshots with formerly most bound particles
+#SUBFIND_UNBIND_DELTA_UPDATES                 # only corrects the potential for removed particles during unbinding, no final recomputation
 
 
 #---------------------------------------- Merger tree code
@@ -185,8 +194,11 @@ INITIAL_CONDITIONS_CONTAIN_ENTROPY
 #IMPOSE_PINNING                               # enables pinning of MPI processes to CPU cores
 #IMPOSE_PINNING_OVERRIDE_MODE                 # tries to do the pinning even if a prior pinning is detected
 #PRESERVE_SHMEM_BINARY_INVARIANCE             # preserve binary invariance of results despite machine weather, at the price of more tree walk overhead 
-#EXPLICIT_VECTORIZATION                       # use AVX at selected places in SPH kernels through the vectorclass C++ library
+#EXPLICIT_VECTORIZATION                       # use AVX at selected places in SPH kernels and the gravity tree walk through the vectorclass C++ library
+#THREADS_PER_MPI_RANK=4                       # carry out the gravity tree walk and SUBFIND unbinding with this many threads on each MPI rank
+#GRAVITY_GROUPWALK=16                         # let up to this many active particles of the same tree node share one gravity tree walk
 #SIMPLE_DOMAIN_AGGREGATION                    # this is an experimental modification of the domain decomposition algorithm (can either help or harm performance)
+#DOMAIN_MEASURED_COST_MODEL                   # balance domains on measured per-particle time of gravity/SPH/cooling, and gas and collisionless counts separately
 
 
 #---------------------------------------- MPI related settings
@@ -194,11 +206,11 @@ INITIAL_CONDITIONS_CONTAIN_ENTROPY
 #NUMBER_OF_MPI_LISTENERS_PER_NODE=1           # set such that the number of MPI-ranks per node and listener is maller than MAX_NUMBER_OF_RANKS_WITH_SHARED_MEMORY 
 #MAX_NUMBER_OF_RANKS_WITH_SHARED_MEMORY=64    # default is 64, but can also be set to 32
 #NUMPART_PER_TASK_LARGE                       # set this if the number of particles per task is so large that more than 2 GB are comprised just by particle data
-#USE_MPIALLTOALLV_IN_DOMAINDECOMP             # replaces hypercube communication in domain particle exchance with a single MPI_Allgatherv (can be less stable)
+#USE_MPIALLTOALLV_IN_DOMAINDECOMP             # replaces sparse communication in domain particle exchance with a single MPI_Allgatherv (can be less stable)
 #MPI_HYPERCUBE_ALLGATHERV                     # if your MPI-library uses too much internal storage for MPI_Allgatherv, this uses a hypercube as a work-around
 #MPI_MESSAGE_SIZELIMIT_IN_MB=200              # limit the message size of very large MPI transfers
 #MPI_HYPERCUBE_ALLTOALL                       # use a robust hyercube for MPI_Alltoall instead the native algorithm if the MPI library
-#ISEND_IRECV_IN_DOMAIN                        # uses asynchronous communication instead of synchronous communication in hypercube pattern (can be less stable)
+#ISEND_IRECV_IN_DOMAIN                        # posts all messages of the domain exchange at once instead of using bounded windows of requests (can be less stable)
 #ALLOCATE_SHARED_MEMORY_VIA_POSIX             # if this is set, do use POSIX directly to allocated shared memory instead of MPI-3 calls
 #OLDSTYLE_SHARED_MEMORY_ALLOCATION            # disables new memory allocation mechanism via memfd_create()
 
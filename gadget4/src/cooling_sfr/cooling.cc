@@ -669,6 +669,12 @@ void coolsfr::InitCool(void)
   /* read photo tables */
   ReadIonizeParams(All.TreecoolFile);
 
+#ifdef COOLING_EQUILIBRIUM_TABLE
+  /* the equilibrium table is computed when it is first needed */
+  CoolTab     = (cool_table_entry *)Mem.mymalloc("CoolTab", NCOOLTAB_U * NCOOLTAB_NH * sizeof(cool_table_entry));
+  CoolTabTime = -1;
+#endif
+
   All.Time = All.TimeBegin;
   All.set_cosmo_factors_for_current_time();
 
@@ -686,6 +692,9 @@ void coolsfr::cooling_only(simparticles *Sp) /* normal cooling routine when star
   gas_state gs        = GasState;
   do_cool_data DoCool = DoCoolData;
 
+  int *list = (int *)Mem.mymalloc("list", Sp->TimeBinsHydro.NActiveParticles * sizeof(int));
+  int n     = 0;
+
   for(int i = 0; i < Sp->TimeBinsHydro.NActiveParticles; i++)
     {
       int target = Sp->TimeBinsHydro.ActiveParticleList[i];
@@ -694,9 +703,14 @@ void coolsfr::cooling_only(simparticles *Sp) /* normal cooling routine when star
           if(Sp->P[target].getMass() == 0 && Sp->P[target].ID.get() == 0)
             continue; /* skip particles that have been swallowed or eliminated */
 
-          cool_sph_particle(Sp, target, &gs, &DoCool);
+          list[n++] = target;
         }
     }
+
+  cool_sph_particles(Sp, list, n, &gs, &DoCool);
+
+  Mem.myfree(list);
+
   TIMER_STOP(CPU_COOLING_SFR);
 }
 
@@ -722,6 +736,77 @@ void coolsfr::cool_sph_particle(simparticles *Sp, int i, gas_state *gs, do_cool_
   double unew    = DoCooling(std::max<double>(All.MinEgySpec, utherm), dens * All.cf_a3inv, dtime, &ne, gs, DoCool);
   Sp->SphP[i].Ne = ne;
 
+  update_utherm_after_cooling(Sp, i, utherm, unew, dtime);
+}
+
+/** \brief Apply the isochoric cooling to a list of gas particles.
+ *
+ *  With COOLING_EQUILIBRIUM_TABLE, the particles are processed together with the tabulated equilibrium rates, provided the
+ *  table is available for the current time or it pays off to compute it. Otherwise, cool_sph_particle() is called for each
+ *  of them. This function has to be called by all tasks of the communicator.
+ *
+ *  \param list indices of the gas particles to which cooling is applied
+ *  \param n number of these particles
+ */
+void coolsfr::cool_sph_particles(simparticles *Sp, int *list, int n, gas_state *gs, do_cool_data *DoCool)
+{
+#ifdef COOLING_EQUILIBRIUM_TABLE
+  long long ntot = n;
+  MPI_Allreduce(MPI_IN_PLACE, &ntot, 1, MPI_LONG_LONG, MPI_SUM, Communicator);
+
+  if(cooling_table_update(ntot))
+    {
+      double *u      = (double *)Mem.mymalloc("u", n * sizeof(double));
+      double *utherm = (double *)Mem.mymalloc("utherm", n * sizeof(double));
+      double *rho    = (double *)Mem.mymalloc("rho", n * sizeof(double));
+      double *dtime  = (double *)Mem.mymalloc("dtime", n * sizeof(double));
+      double *ne     = (double *)Mem.mymalloc("ne", n * sizeof(double));
+
+      for(int k = 0; k < n; k++)
+        {
+          int i = list[k];
+
+          double dt = (Sp->P[i].getTimeBinHydro() ? (((integertime)1) << Sp->P[i].getTimeBinHydro()) : 0) * All.Timebase_interval;
+
+          dtime[k]  = All.cf_atime * dt / All.cf_atime_hubble_a;
+          utherm[k] = Sp->get_utherm_from_entropy(i);
+          u[k]      = std::max<double>(All.MinEgySpec, utherm[k]);
+          rho[k]    = Sp->SphP[i].Density * All.cf_a3inv;
+          ne[k]     = Sp->SphP[i].Ne;
+        }
+
+      DoCoolingBatch(n, u, rho, dtime, ne, gs, DoCool);
+
+      for(int k = 0; k < n; k++)
+        {
+          Sp->SphP[list[k]].Ne = ne[k];
+
+          update_utherm_after_cooling(Sp, list[k], utherm[k], u[k], dtime[k]);
+        }
+
+      Mem.myfree(ne);
+      Mem.myfree(dtime);
+      Mem.myfree(rho);
+      Mem.myfree(utherm);
+      Mem.myfree(u);
+
+      return;
+    }
+#endif
+
+  for(int k = 0; k < n; k++)
+    cool_sph_particle(Sp, list[k], gs, DoCool);
+}
+
+/** \brief Update the thermodynamic state of a gas particle after cooling.
+ *
+ *  \param i index of the gas particle
+ *  \param utherm internal energy per unit mass before cooling
+ *  \param unew internal energy per unit mass after cooling
+ *  \param dtime the physical duration of the time step
+ */
+void coolsfr::update_utherm_after_cooling(simparticles *Sp, int i, double utherm, double unew, double dtime)
+{
   if(unew < 0)
     Terminate("invalid temperature: i=%d unew=%g\n", i, unew);
 
@@ -19,6 +19,17 @@
 #include "../data/simparticles.h"
 #include "../mpi_utils/setcomm.h"
 
+#ifdef COOLING_EQUILIBRIUM_TABLE
+#define NCOOLTAB_U 2048 /* number of points of the equilibrium table in log10 of the specific internal energy */
+#define NCOOLTAB_NH 61  /* number of points of the equilibrium table in log10 of the hydrogen number density */
+#define COOLTAB_LOGNH_MIN -9.0
+#define COOLTAB_LOGNH_MAX 3.0
+/* rough number of table points that cost as much to compute as the direct solution for one particle; the table is only
+ * (re)computed when there are enough particles to cool for this to pay off
+ */
+#define COOLTAB_POINTS_PER_PARTICLE 16
+#endif
+
 class coolsfr : public setcomm
 {
  public:
@@ -85,6 +96,21 @@ class coolsfr : public setcomm
     double u_old_input, rho_input, dt_input, ne_guess_input;
   };
 
+#ifdef COOLING_EQUILIBRIUM_TABLE
+  /* net cooling rate and electron abundance of gas in ionization equilibrium */
+  struct cool_table_entry
+  {
+    double lambda; /* (heating rate - cooling rate)/n_h^2 in cgs units */
+    double ne;     /* electron number density relative to hydrogen number density */
+  };
+
+  cool_table_entry *CoolTab; /**< equilibrium table, point (iu, inh) is stored at index inh * NCOOLTAB_U + iu */
+  double CoolTabLogUMin;     /**< log10 of the smallest tabulated specific internal energy in cgs units */
+  double CoolTabDeltaLogU;   /**< spacing of the table in log10 of the specific internal energy */
+  double CoolTabDeltaLogNH;  /**< spacing of the table in log10 of the hydrogen number density */
+  double CoolTabTime = -1;   /**< time for which the table was computed, negative if there is no valid table */
+#endif
+
   gas_state GasState;      /**< gas state */
   do_cool_data DoCoolData; /**< cooling data */
 
@@ -101,6 +127,8 @@ class coolsfr : public setcomm
   double DoCooling(double u_old, double rho, double dt, double *ne_guess, gas_state *gs, do_cool_data *DoCool);
   double GetCoolingTime(double u_old, double rho, double *ne_guess, gas_state *gs, do_cool_data *DoCool);
   void cool_sph_particle(simparticles *Sp, int i, gas_state *gs, do_cool_data *DoCool);
+  void cool_sph_particles(simparticles *Sp, int *list, int n, gas_state *gs, do_cool_data *DoCool);
+  void update_utherm_after_cooling(simparticles *Sp, int i, double utherm, double unew, double dtime);
 
   void SetZeroIonization(void);
 #endif
@@ -117,6 +145,19 @@ class coolsfr : public setcomm
 
   void MakeRateTable(void);
 
+#ifdef COOLING_EQUILIBRIUM_TABLE
+  bool cooling_table_update(long long ntot);
+  void cooling_table_build(void);
+  void DoCoolingBatch(int n, double *u, const double *rho, const double *dt, double *ne, gas_state *gs, do_cool_data *DoCool);
+  double DoCoolingTable(double u_old, double rho, double dt, double *ne, bool *outside);
+  inline bool cooling_table_column(double nHcgs, int *inh, double *fnh);
+  inline double cooling_table_rate(double u, int inh, double fnh, bool *outside, double *ne = NULL);
+#ifdef EXPLICIT_VECTORIZATION
+  void DoCoolingTableVector(double *u, const double *rho, const double *dt, double *ne, bool *outside);
+  inline Vec4d cooling_table_rate(Vec4d u, Vec4q inh, Vec4d fnh, Vec4db &outside);
+#endif
+#endif
+
 #ifdef STARFORMATION
   const int WriteMiscFiles = 1;
 
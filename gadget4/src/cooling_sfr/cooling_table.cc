@@ -0,0 +1,451 @@
+/*******************************************************************************
+ * \copyright   This file is part of the GADGET4 N-body/SPH code developed
+ * \copyright   by Volker Springel. Copyright (C) 2014-2020 by Volker Springel
+ * \copyright   (vspringel@mpa-garching.mpg.de) and all contributing authors.
+ *******************************************************************************/
+
+/*! \file cooling_table.cc
+ *
+ *  \brief tabulated equilibrium cooling rates, and an implicit cooling solver for many gas particles that uses them
+ */
+
+#include "gadgetconfig.h"
+
+#if defined(COOLING) && defined(COOLING_EQUILIBRIUM_TABLE)
+
+#include <gsl/gsl_math.h>
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "../cooling_sfr/cooling.h"
+#include "../data/allvars.h"
+#include "../data/dtypes.h"
+#include "../data/mymalloc.h"
+#include "../logs/logs.h"
+#include "../logs/timer.h"
+#include "../mpi_utils/mpi_utils.h"
+#include "../system/system.h"
+
+#ifdef EXPLICIT_VECTORIZATION
+#include "../vectorclass/vectormath_exp.h"
+#endif
+
+/** \brief Make sure that the equilibrium table is valid for the current time.
+ *
+ *  In comoving runs, the UV background and the Compton cooling change with redshift, hence the table has to be recomputed
+ *  for every new time. This is only done if the total number of particles that need to be cooled is large enough for the
+ *  table to be cheaper than solving for the ionization state of each of them directly.
+ *
+ *  \param ntot total number of gas particles to be cooled on all tasks
+ *  \return true if the table can be used
+ */
+bool coolsfr::cooling_table_update(long long ntot)
+{
+  if(CoolTabTime >= 0 && (!All.ComovingIntegrationOn || CoolTabTime == All.Time))
+    return true;
+
+  if(ntot * COOLTAB_POINTS_PER_PARTICLE < ((long long)NCOOLTAB_U) * NCOOLTAB_NH)
+    return false;
+
+  cooling_table_build();
+
+  return true;
+}
+
+/** \brief Compute the net cooling rate and the electron abundance in ionization equilibrium on a grid.
+ *
+ *  The grid is uniform in log10 of the specific internal energy and of the hydrogen number density, both in physical cgs
+ *  units. The energy range covers neutral gas at 10^(Tmin+1) K up to fully ionized gas at 10^Tmax K, the lower limit stays
+ *  clear of Tmin, where the temperature iteration does not converge. The points are computed with CoolingRateFromU(), the
+ *  columns of different density are distributed over all tasks.
+ */
+void coolsfr::cooling_table_build(void)
+{
+  TIMER_START(CPU_COOLING_TABLE);
+
+  double t0 = Logs.second();
+
+  double yhelium = GasState.yhelium;
+  double mu_ion  = (1 + 4 * yhelium) / (2 + 3 * yhelium); /* mean molecular weight of fully ionized gas */
+
+  CoolTabLogUMin    = log10(GasState.ethmin) + 1.0;
+  CoolTabDeltaLogU  = (Tmax - log10(mu_ion * GasState.mhboltz * GAMMA_MINUS1) - CoolTabLogUMin) / (NCOOLTAB_U - 1);
+  CoolTabDeltaLogNH = (COOLTAB_LOGNH_MAX - COOLTAB_LOGNH_MIN) / (NCOOLTAB_NH - 1);
+
+  gas_state gs        = GasState;
+  do_cool_data DoCool = DoCoolData;
+
+  int first, count;
+  subdivide_evenly(NCOOLTAB_NH, NTask, ThisTask, &first, &count);
+
+  for(int inh = first; inh < first + count; inh++)
+    {
+      double rho = pow(10.0, COOLTAB_LOGNH_MIN + inh * CoolTabDeltaLogNH) * PROTONMASS / gs.XH;
+      double ne  = 1.0; /* the solution at the previous energy serves as a starting guess for the next one */
+
+      for(int iu = 0; iu < NCOOLTAB_U; iu++)
+        {
+          double u = pow(10.0, CoolTabLogUMin + iu * CoolTabDeltaLogU);
+
+          DoCool.u_old_input    = u;
+          DoCool.rho_input      = rho;
+          DoCool.dt_input       = 0;
+          DoCool.ne_guess_input = ne;
+
+          cool_table_entry *ct = &CoolTab[inh * NCOOLTAB_U + iu];
+
+          ct->lambda = CoolingRateFromU(u, rho, &ne, &gs, &DoCool);
+          ct->ne     = ne;
+        }
+    }
+
+  int *recvcounts  = (int *)Mem.mymalloc("recvcounts", NTask * sizeof(int));
+  int *recvoffsets = (int *)Mem.mymalloc("recvoffsets", NTask * sizeof(int));
+
+  for(int task = 0; task < NTask; task++)
+    {
+      int task_first, task_count;
+      subdivide_evenly(NCOOLTAB_NH, NTask, task, &task_first, &task_count);
+
+      recvcounts[task]  = task_count * NCOOLTAB_U * sizeof(cool_table_entry);
+      recvoffsets[task] = task_first * NCOOLTAB_U * sizeof(cool_table_entry);
+    }
+
+  myMPI_Allgatherv(MPI_IN_PLACE, recvcounts[ThisTask], MPI_BYTE, CoolTab, recvcounts, recvoffsets, MPI_BYTE, Communicator);
+
+  Mem.myfree(recvoffsets);
+  Mem.myfree(recvcounts);
+
+  CoolTabTime = All.Time;
+
+  mpi_printf("COOLING: computed equilibrium table for time %g, took %g sec\n", All.Time, Logs.timediff(t0, Logs.second()));
+
+  TIMER_STOP(CPU_COOLING_TABLE);
+}
+
+/** \brief Find the table column and interpolation weight for a given hydrogen number density.
+ *
+ *  \param nHcgs hydrogen number density in cgs units
+ *  \param inh index of the table column below the density
+ *  \param fnh interpolation weight of the column above
+ *  \return false if the density lies outside of the table
+ */
+inline bool coolsfr::cooling_table_column(double nHcgs, int *inh, double *fnh)
+{
+  double s = (log10(nHcgs) - COOLTAB_LOGNH_MIN) / CoolTabDeltaLogNH;
+
+  if(!(s >= 0 && s <= NCOOLTAB_NH - 1))
+    return false;
+
+  *inh = std::min<int>((int)s, NCOOLTAB_NH - 2);
+  *fnh = s - *inh;
+
+  return true;
+}
+
+/** \brief Interpolate the net cooling rate (heating rate-cooling rate)/n_h^2 in cgs units from the equilibrium table.
+ *
+ *  \param u specific internal energy in cgs units
+ *  \param inh index of the table column, see cooling_table_column()
+ *  \param fnh interpolation weight of the next column
+ *  \param outside set to true if the energy lies outside of the table
+ *  \param ne if not NULL, the interpolated electron abundance is stored here
+ *  \return the net cooling rate
+ */
+inline double coolsfr::cooling_table_rate(double u, int inh, double fnh, bool *outside, double *ne)
+{
+  double t = (log10(u) - CoolTabLogUMin) / CoolTabDeltaLogU;
+
+  if(!(t >= 0 && t <= NCOOLTAB_U - 1))
+    {
+      *outside = true;
+      t        = (t > 0) ? NCOOLTAB_U - 1 : 0;
+    }
+
+  int iu    = std::min<int>((int)t, NCOOLTAB_U - 2);
+  double fu = t - iu;
+
+  cool_table_entry *ct = &CoolTab[inh * NCOOLTAB_U + iu];
+
+  if(ne)
+    *ne = (1 - fnh) * ((1 - fu) * ct[0].ne + fu * ct[1].ne) + fnh * ((1 - fu) * ct[NCOOLTAB_U].ne + fu * ct[NCOOLTAB_U + 1].ne);
+
+  return (1 - fnh) * ((1 - fu) * ct[0].lambda + fu * ct[1].lambda) +
+         fnh * ((1 - fu) * ct[NCOOLTAB_U].lambda + fu * ct[NCOOLTAB_U + 1].lambda);
+}
+
+/** \brief Compute the new internal energy per unit mass with the tabulated equilibrium rates.
+ *
+ *  This carries out the same implicit Euler step with bracketing and bisection as DoCooling(), but the net cooling rate
+ *  is interpolated from the table instead of being obtained from an iteration for the temperature and the ionization
+ *  state. Arguments are passed in code units.
+ *
+ *  \param u_old the internal energy per unit mass before cooling is applied
+ *  \param rho the proper density of the gas particle
+ *  \param dt the duration of the time step
+ *  \param ne set to the equilibrium electron abundance at the new energy
+ *  \param outside set to true if the particle leaves the table, the result is invalid then
+ *  \return the new internal energy per unit mass of the gas particle
+ */
+double coolsfr::DoCoolingTable(double u_old, double rho, double dt, double *ne, bool *outside)
+{
+  rho *= All.UnitDensity_in_cgs * All.HubbleParam * All.HubbleParam; /* convert to physical cgs units */
+  u_old *= All.UnitPressure_in_cgs / All.UnitDensity_in_cgs;
+  dt *= All.UnitTime_in_s / All.HubbleParam;
+
+  double nHcgs    = GasState.XH * rho / PROTONMASS; /* hydrogen number dens in cgs units */
+  double ratefact = nHcgs * nHcgs / rho;
+
+  int inh;
+  double fnh;
+  if(!cooling_table_column(nHcgs, &inh, &fnh))
+    {
+      *outside = true;
+      return 0;
+    }
+
+  double u       = u_old;
+  double u_lower = u;
+  double u_upper = u;
+
+  double LambdaNet = cooling_table_rate(u, inh, fnh, outside);
+
+  /* bracketing */
+
+  if(u - u_old - ratefact * LambdaNet * dt < 0) /* heating */
+    {
+      u_upper *= sqrt(1.1);
+      u_lower /= sqrt(1.1);
+      while(!*outside && u_upper - u_old - ratefact * cooling_table_rate(u_upper, inh, fnh, outside) * dt < 0)
+        {
+          u_upper *= 1.1;
+          u_lower *= 1.1;
+        }
+    }
+
+  if(u - u_old - ratefact * LambdaNet * dt > 0)
+    {
+      u_lower /= sqrt(1.1);
+      u_upper *= sqrt(1.1);
+      while(!*outside && u_lower - u_old - ratefact * cooling_table_rate(u_lower, inh, fnh, outside) * dt > 0)
+        {
+          u_upper /= 1.1;
+          u_lower /= 1.1;
+        }
+    }
+
+  int iter = 0;
+  double du;
+  do
+    {
+      u = 0.5 * (u_lower + u_upper);
+
+      LambdaNet = cooling_table_rate(u, inh, fnh, outside);
+
+      if(u - u_old - ratefact * LambdaNet * dt > 0)
+        u_upper = u;
+      else
+        u_lower = u;
+
+      du = u_upper - u_lower;
+
+      iter++;
+    }
+  while(!*outside && fabs(du / u) > 1.0e-6 && iter < MAXITER);
+
+  if(*outside)
+    return 0;
+
+  if(iter >= MAXITER)
+    Terminate("failed to converge in DoCoolingTable(): u_old=%g rho=%g dt=%g\n", u_old, rho, dt);
+
+  cooling_table_rate(u, inh, fnh, outside, ne);
+
+  u *= All.UnitDensity_in_cgs / All.UnitPressure_in_cgs; /* to internal units */
+
+  return u;
+}
+
+#ifdef EXPLICIT_VECTORIZATION
+/** \brief Interpolate the net cooling rate from the equilibrium table for four particles at once.
+ *
+ *  \param u specific internal energies in cgs units
+ *  \param inh indices of the table columns, see cooling_table_column()
+ *  \param fnh interpolation weights of the next columns
+ *  \param outside set for the lanes where the energy lies outside of the table
+ *  \return the net cooling rates
+ */
+inline Vec4d coolsfr::cooling_table_rate(Vec4d u, Vec4q inh, Vec4d fnh, Vec4db &outside)
+{
+  const int n = 2 * NCOOLTAB_U * NCOOLTAB_NH; /* number of doubles in the table */
+
+  Vec4d t = (log10(u) - CoolTabLogUMin) * (1.0 / CoolTabDeltaLogU);
+
+  outside = (t < 0) | (t > NCOOLTAB_U - 1);
+
+  t         = min(max(t, 0.0), NCOOLTAB_U - 1.0);
+  Vec4d tfl = min(floor(t), NCOOLTAB_U - 2.0);
+  Vec4d fu  = t - tfl;
+
+  /* the table entries hold two doubles, of which the rate is the first */
+  Vec4q i00 = (inh * NCOOLTAB_U + truncate_to_int64(tfl)) * 2;
+
+  const double *tab = &CoolTab[0].lambda;
+
+  Vec4d l00 = lookup<n>(i00, tab);
+  Vec4d l10 = lookup<n>(i00 + 2, tab);
+  Vec4d l01 = lookup<n>(i00 + 2 * NCOOLTAB_U, tab);
+  Vec4d l11 = lookup<n>(i00 + 2 * NCOOLTAB_U + 2, tab);
+
+  return (1.0 - fnh) * ((1.0 - fu) * l00 + fu * l10) + fnh * ((1.0 - fu) * l01 + fu * l11);
+}
+
+/** \brief Compute the new internal energy per unit mass for four particles at once with the tabulated rates.
+ *
+ *  This is the vectorized version of DoCoolingTable(). The bracketing and the bisection are done in lockstep, where the
+ *  lanes that are finished already are masked out, so that each lane sees the same sequence of steps as in the scalar
+ *  version. The results are stored in u and ne for all lanes that did not leave the table.
+ *
+ *  \param u on input the internal energies per unit mass before cooling, on output the new ones
+ *  \param rho the proper densities of the gas particles
+ *  \param dt the durations of the time steps
+ *  \param ne set to the equilibrium electron abundances at the new energies
+ *  \param outside set for the lanes that left the table, these are left untouched
+ */
+void coolsfr::DoCoolingTableVector(double *u, const double *rho, const double *dt, double *ne, bool *outside)
+{
+  Vec4d rhov  = Vec4d().load(rho) * (All.UnitDensity_in_cgs * All.HubbleParam * All.HubbleParam);
+  Vec4d u_old = Vec4d().load(u) * (All.UnitPressure_in_cgs / All.UnitDensity_in_cgs);
+  Vec4d dtv   = Vec4d().load(dt) * (All.UnitTime_in_s / All.HubbleParam);
+
+  Vec4d nHcgs    = GasState.XH * rhov / PROTONMASS;
+  Vec4d ratefact = nHcgs * nHcgs / rhov;
+
+  Vec4d s         = (log10(nHcgs) - COOLTAB_LOGNH_MIN) * (1.0 / CoolTabDeltaLogNH);
+  Vec4db out_lane = ~((s >= 0) & (s <= NCOOLTAB_NH - 1));
+  s               = min(max(s, 0.0), NCOOLTAB_NH - 1.0);
+  Vec4d sfl       = min(floor(s), NCOOLTAB_NH - 2.0);
+  Vec4d fnh       = s - sfl;
+  Vec4q inh       = truncate_to_int64(sfl);
+
+  Vec4db out;
+
+  Vec4d LambdaNet = cooling_table_rate(u_old, inh, fnh, out);
+  out_lane |= out;
+
+  Vec4d f0 = -ratefact * LambdaNet * dtv;
+
+  Vec4d u_lower = select(f0 != 0, u_old / sqrt(1.1), u_old);
+  Vec4d u_upper = select(f0 != 0, u_old * sqrt(1.1), u_old);
+
+  /* bracketing in case of heating */
+  Vec4db todo = (f0 < 0) & ~out_lane;
+  while(horizontal_or(todo))
+    {
+      LambdaNet = cooling_table_rate(u_upper, inh, fnh, out);
+      out_lane |= out & todo;
+      todo &= (u_upper - u_old - ratefact * LambdaNet * dtv < 0) & ~out_lane;
+      u_upper = if_mul(todo, u_upper, 1.1);
+      u_lower = if_mul(todo, u_lower, 1.1);
+    }
+
+  /* bracketing in case of cooling */
+  todo = (f0 > 0) & ~out_lane;
+  while(horizontal_or(todo))
+    {
+      LambdaNet = cooling_table_rate(u_lower, inh, fnh, out);
+      out_lane |= out & todo;
+      todo &= (u_lower - u_old - ratefact * LambdaNet * dtv > 0) & ~out_lane;
+      u_upper = select(todo, u_upper / 1.1, u_upper);
+      u_lower = select(todo, u_lower / 1.1, u_lower);
+    }
+
+  Vec4d unew    = u_old;
+  Vec4db active = ~out_lane;
+  int iter      = 0;
+  do
+    {
+      unew = select(active, 0.5 * (u_lower + u_upper), unew);
+
+      LambdaNet = cooling_table_rate(unew, inh, fnh, out);
+      out_lane |= out & active;
+
+      Vec4db upper = (unew - u_old - ratefact * LambdaNet * dtv > 0);
+      u_upper      = select(active & upper, unew, u_upper);
+      u_lower      = select(active & ~upper, unew, u_lower);
+
+      active &= (abs((u_upper - u_lower) / unew) > 1.0e-6) & ~out_lane;
+
+      iter++;
+    }
+  while(horizontal_or(active) && iter < MAXITER);
+
+  if(iter >= MAXITER)
+    Terminate("failed to converge in DoCoolingTableVector()\n");
+
+  for(int j = 0; j < 4; j++)
+    {
+      outside[j] = out_lane.extract(j);
+
+      if(!outside[j])
+        {
+          int inh_j = inh.extract(j);
+          cooling_table_rate(unew.extract(j), inh_j, fnh.extract(j), &outside[j], &ne[j]);
+          u[j] = unew.extract(j) * (All.UnitDensity_in_cgs / All.UnitPressure_in_cgs); /* to internal units */
+        }
+    }
+}
+#endif
+
+/** \brief Apply the implicit cooling step to many gas particles.
+ *
+ *  The particles are processed with the equilibrium table, four at a time if EXPLICIT_VECTORIZATION is set. Particles
+ *  whose density or energy leaves the table are treated with DoCooling() instead. Arguments are passed in code units.
+ *
+ *  \param n number of particles
+ *  \param u on input the internal energies per unit mass before cooling, on output the new ones
+ *  \param rho the proper densities of the gas particles
+ *  \param dt the durations of the time steps
+ *  \param ne electron abundances, which serve as a starting guess and are updated
+ */
+void coolsfr::DoCoolingBatch(int n, double *u, const double *rho, const double *dt, double *ne, gas_state *gs, do_cool_data *DoCool)
+{
+  for(int k = 0; k < n; k++)
+    if(!gsl_finite(u[k]) || u[k] < 0 || rho[k] < 0)
+      Terminate("invalid input: u_old=%g  rho=%g  dt=%g  All.MinEgySpec=%g\n", u[k], rho[k], dt[k], All.MinEgySpec);
+
+  int k = 0;
+
+#ifdef EXPLICIT_VECTORIZATION
+  for(; k + 4 <= n; k += 4)
+    {
+      bool outside[4];
+      DoCoolingTableVector(&u[k], &rho[k], &dt[k], &ne[k], outside);
+
+      for(int j = 0; j < 4; j++)
+        if(outside[j])
+          u[k + j] = DoCooling(u[k + j], rho[k + j], dt[k + j], &ne[k + j], gs, DoCool);
+    }
+#endif
+
+  for(; k < n; k++)
+    {
+      bool outside = false;
+      double ne_k  = ne[k];
+      double unew  = DoCoolingTable(u[k], rho[k], dt[k], &ne_k, &outside);
+
+      if(outside)
+        u[k] = DoCooling(u[k], rho[k], dt[k], &ne[k], gs, DoCool);
+      else
+        {
+          u[k]  = unew;
+          ne[k] = ne_k;
+        }
+    }
+}
+
+#endif
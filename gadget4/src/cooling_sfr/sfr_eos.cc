@@ -22,6 +22,7 @@
 #include "../cooling_sfr/cooling.h"
 #include "../data/allvars.h"
 #include "../data/dtypes.h"
+#include "../data/mymalloc.h"
 #include "../logs/logs.h"
 #include "../system/system.h"
 #include "../time_integration/timestep.h"
@@ -49,6 +50,10 @@ void coolsfr::cooling_and_starformation(simparticles *Sp)
   gas_state gs    = GasState;
   do_cool_data dc = DoCoolData;
 
+  /* the cells that are subject to normal cooling are collected and processed together afterwards */
+  int *list = (int *)Mem.mymalloc("list", Sp->TimeBinsHydro.NActiveParticles * sizeof(int));
+  int n     = 0;
+
   for(int i = 0; i < Sp->TimeBinsHydro.NActiveParticles; i++)
     {
       int target = Sp->TimeBinsHydro.ActiveParticleList[i];
@@ -82,7 +87,7 @@ void coolsfr::cooling_and_starformation(simparticles *Sp)
           if(flag == 1) /* normal implicit isochoric cooling */
             {
               Sp->SphP[target].Sfr = 0;
-              cool_sph_particle(Sp, target, &gs, &dc);
+              list[n++]            = target;
             }
 
           if(flag == 0) /* active star formation */
@@ -163,6 +168,10 @@ void coolsfr::cooling_and_starformation(simparticles *Sp)
         }
     } /* end of main loop over active particles */
 
+  cool_sph_particles(Sp, list, n, &gs, &dc);
+
+  Mem.myfree(list);
+
   TIMER_STOP(CPU_COOLING_SFR);
 }
 
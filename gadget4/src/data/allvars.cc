@@ -201,6 +201,20 @@ void global_data_all_processes::register_parameters(void)
   add_param("GridSize", &GridSize, PARAM_INT, PARAM_FIXED);
 #endif
 
+#ifdef ALLOW_HDF5_COMPRESSION
+  add_param("HDF5CompressionPolicy", HDF5CompressionPolicy, PARAM_STRING, PARAM_CHANGEABLE);
+#endif
+
+#ifdef SNAPSHOT_PHKEY_INDEX
+  add_param("SnapshotReadFields", SnapshotReadFields, PARAM_STRING, PARAM_CHANGEABLE);
+  add_param("SnapshotReadRegion", SnapshotReadRegion, PARAM_STRING, PARAM_CHANGEABLE);
+#endif
+
+#ifdef DENSITYGRID_ON_OUTPUT
+  add_param("DensityGridResolution", &DensityGridResolution, PARAM_INT, PARAM_CHANGEABLE);
+  add_param("DensityGridFields", DensityGridFields, PARAM_STRING, PARAM_CHANGEABLE);
+#endif
+
 #ifdef EXTERNALGRAVITY_STATICHQ
   add_param("A_StaticHQHalo", &A_StaticHQHalo, PARAM_DOUBLE, PARAM_FIXED);
   add_param("Mass_StaticHQHalo", &Mass_StaticHQHalo, PARAM_DOUBLE, PARAM_FIXED);
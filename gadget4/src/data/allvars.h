@@ -351,6 +351,20 @@ struct global_data_all_processes : public parameters
   int GridSize;
 #endif
 
+#ifdef ALLOW_HDF5_COMPRESSION
+  char HDF5CompressionPolicy[MAXLEN_PATH]; /**< comma-separated list of <datasetname>:<method> overrides of the compression */
+#endif
+
+#ifdef SNAPSHOT_PHKEY_INDEX
+  char SnapshotReadFields[MAXLEN_PATH]; /**< comma-separated list of the datasets read from the initial snapshot, or 'all' */
+  char SnapshotReadRegion[MAXLEN_PATH]; /**< center and side length 'x,y,z,len' of the cube read from the initial snapshot, or 'all' */
+#endif
+
+#ifdef DENSITYGRID_ON_OUTPUT
+  int DensityGridResolution;             /**< number of cells per dimension of the grids written at output times */
+  char DensityGridFields[MAXLEN_PATH];   /**< comma-separated list of the fields that are written as grids */
+#endif
+
 #ifdef EXTERNALGRAVITY_STATICHQ
   double A_StaticHQHalo;
   double Mass_StaticHQHalo;
@@ -35,6 +35,14 @@
 
 #define MAX_THREADS 128
 
+#ifndef THREADS_PER_MPI_RANK
+#define THREADS_PER_MPI_RANK 1
+#endif
+
+#ifndef PM_ASSIGNMENT_ORDER
+#define PM_ASSIGNMENT_ORDER 2 /* number of mesh cells per dimension a particle is assigned to in the periodic PM, 2 is CIC */
+#endif
+
 #ifndef DIRECT_SUMMATION_THRESHOLD
 #define DIRECT_SUMMATION_THRESHOLD 500
 #endif
@@ -213,6 +221,14 @@
 #error "The option POWERSPEC_ON_OUTPUT requires PMGRID and PERIODIC."
 #endif
 
+#if defined(DENSITYGRID_ON_OUTPUT) && !(defined(PERIODIC) && defined(PMGRID))
+#error "The option DENSITYGRID_ON_OUTPUT requires PMGRID and PERIODIC."
+#endif
+
+#if defined(PM_SPECTRAL_DIFFERENCING) && (!(defined(PERIODIC) && defined(PMGRID)) || defined(GRAVITY_TALLBOX))
+#error "The option PM_SPECTRAL_DIFFERENCING requires PMGRID and PERIODIC, and cannot be combined with GRAVITY_TALLBOX."
+#endif
+
 #if defined(CREATE_GRID) && !defined(NGENIC)
 #error "CREATE_GRID only makes sense with NGENIC"
 #endif
@@ -221,10 +237,18 @@
 #error "The OUTPUT_COORDINATES_AS_INTEGERS option is only allowed when PERIODIC is on"
 #endif
 
+#if defined(SNAPSHOT_PHKEY_INDEX) && !defined(PERIODIC)
+#error "The SNAPSHOT_PHKEY_INDEX option is only allowed when PERIODIC is on"
+#endif
+
 #if defined(ALLOW_DIRECT_SUMMATION) && !defined(HIERARCHICAL_GRAVITY)
 #error "The option ALLOW_DIRECT_SUMMATION is only availble when HIERARCHICAL_GRAVITY is used"
 #endif
 
+#if defined(GRAVITY_TREE_REUSE) && (defined(HIERARCHICAL_GRAVITY) || defined(FORCETEST))
+#error "The option GRAVITY_TREE_REUSE cannot be combined with HIERARCHICAL_GRAVITY or FORCETEST"
+#endif
+
 #if defined(PMGRID) && !defined(PERIODIC) && !defined(TREEPM_NOTIMESPLIT)
 #error "If PMGRID is used without PERIODIC, TREEPM_NOTIMESPLIT needs to be activated"
 #endif
@@ -233,6 +257,14 @@
 #error "If PMGRID is used together with HIERARCHICAL_GRAVITY, you also need to use TREEPM_NOTIMESPLIT"
 #endif
 
+#if defined(GRAVITY_GROUPWALK) && ((GRAVITY_GROUPWALK < 2) || (GRAVITY_GROUPWALK > 32))
+#error "GRAVITY_GROUPWALK needs to lie in the range 2-32"
+#endif
+
+#if defined(GRAVITY_GROUPWALK) && (defined(PLACEHIGHRESREGION) || defined(PRESERVE_SHMEM_BINARY_INVARIANCE))
+#error "GRAVITY_GROUPWALK cannot be combined with PLACEHIGHRESREGION or PRESERVE_SHMEM_BINARY_INVARIANCE"
+#endif
+
 #if defined(OUTPUT_NON_SYNCHRONIZED_ALLOWED) && defined(FOF)
 #error "if OUTPUT_NON_SYNCHRONIZED_ALLOWED is activated, FOF is currently not supported"
 #endif
@@ -357,6 +389,22 @@ typedef int integertime;
 #error "NSOFTCLASSES must be at least 1"
 #endif
 
+#if THREADS_PER_MPI_RANK < 1 || THREADS_PER_MPI_RANK > MAX_THREADS
+#error "THREADS_PER_MPI_RANK must lie in the range 1 to MAX_THREADS"
+#endif
+
+#if THREADS_PER_MPI_RANK > 1 && defined(PRESERVE_SHMEM_BINARY_INVARIANCE)
+#error "THREADS_PER_MPI_RANK > 1 cannot be combined with PRESERVE_SHMEM_BINARY_INVARIANCE"
+#endif
+
+#if PM_ASSIGNMENT_ORDER < 2 || PM_ASSIGNMENT_ORDER > 4
+#error "PM_ASSIGNMENT_ORDER must be 2 (CIC), 3 (TSC), or 4 (PCS)"
+#endif
+
+#if PM_ASSIGNMENT_ORDER != 2 && (defined(PM_ZOOM_OPTIMIZED) || defined(FFT_COLUMN_BASED))
+#error "PM_ASSIGNMENT_ORDER other than 2 is only supported by the slab-based PM algorithm for uniformly loaded boxes"
+#endif
+
 #ifdef GADGET2_HEADER
 #if NTYPES > 6
 #error "NTYPES may not be larger than 6 if GADGET2_HEADER is set"
@@ -324,7 +324,8 @@ enum restart_options
   RST_MAKETREES,
   RST_IOBANDWIDTH,
   RST_LCREARRANGE,
-  RST_SNPREARRANGE
+  RST_SNPREARRANGE,
+  RST_LAYOUTTEST
 };
 
 struct data_partlist
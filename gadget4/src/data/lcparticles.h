@@ -154,7 +154,7 @@ class lcparticles : public intposconvert, public setcomm
 
 #ifdef FOF
   MyIDStorage *MinID;
-  int *Head, *Len, *Next, *Tail, *MinIDTask;
+  int *Head, *Len, *MinIDTask;
   MyFloat *fof_nearest_distance;
   MyFloat *fof_nearest_hsml;
 #if defined(LIGHTCONE_PARTICLES_GROUPS)
@@ -163,49 +163,53 @@ class lcparticles : public intposconvert, public setcomm
 
   struct bit_flags
   {
-    unsigned char Nonlocal : 2, MinIDChanged : 2, Marked : 2, Changed : 2;
+    unsigned char Nonlocal : 2, LinkNode : 2, Marked : 2, Changed : 2;
   } * Flags;
 
   double LinkL;
 
-  void link_two_particles(int target, int j)
+  /*! Returns the root of the local union-find tree of particle i. Head[] stores the parent of each particle, and every
+   *  other link on the path is short-cut on the way up (path halving), which keeps the trees flat.
+   */
+  inline int get_head(int i)
   {
-    if(Head[target] != Head[j]) /* only if not yet linked */
+    while(Head[i] != i)
       {
-        int p, s;
-        if(Len[Head[target]] > Len[Head[j]]) /* p group is longer */
-          {
-            p = target;
-            s = j;
-          }
-        else
+        Head[i] = Head[Head[i]];
+        i       = Head[i];
+      }
+
+    return i;
+  }
+
+  inline void link_two_particles(int target, int j)
+  {
+    int p = get_head(target);
+    int s = get_head(j);
+
+    if(p != s) /* only if not yet linked */
+      {
+        if(Len[p] < Len[s]) /* the smaller tree is attached to the root of the larger one */
           {
-            p = j;
-            s = target;
+            int tmp = p;
+            p       = s;
+            s       = tmp;
           }
-        Next[Tail[Head[p]]] = Head[s];
 
-        Tail[Head[p]] = Tail[Head[s]];
+        Head[s] = p;
 
-        Len[Head[p]] += Len[Head[s]];
+        Len[p] += Len[s];
 
-        if(MinID[Head[s]].get() < MinID[Head[p]].get())
+        if(MinID[s].get() < MinID[p].get())
           {
-            MinID[Head[p]]     = MinID[Head[s]];
-            MinIDTask[Head[p]] = MinIDTask[Head[s]];
+            MinID[p]     = MinID[s];
+            MinIDTask[p] = MinIDTask[s];
           }
 
 #if defined(LIGHTCONE_PARTICLES_GROUPS)
-        if(DistanceOrigin[Head[p]] < DistanceOrigin[Head[s]])
-          DistanceOrigin[Head[s]] = DistanceOrigin[Head[p]];
-        else
-          DistanceOrigin[Head[p]] = DistanceOrigin[Head[s]];
+        if(DistanceOrigin[s] < DistanceOrigin[p])
+          DistanceOrigin[p] = DistanceOrigin[s];
 #endif
-
-        int ss = Head[s];
-        do
-          Head[ss] = Head[p];
-        while((ss = Next[ss]) >= 0);
       }
   }
 
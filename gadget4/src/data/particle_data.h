@@ -39,16 +39,30 @@ struct particle_data
 
   particle_data() {}
 
-  MyIntPosType IntPos[3];    /**< particle position at its current time, stored as an integer type */
-  MyFloat Vel[3];            /**< particle velocity at its current time */
+  /* The fields touched by every drift and kick come first, so that the drift of a particle (position, velocity, time and the
+   * type/lock needed to decide what else to do) only needs the first cache line of the structure. The rarely used fields follow.
+   */
+
+  MyIntPosType IntPos[3];                  /**< particle position at its current time, stored as an integer type */
+  MyFloat Vel[3];                          /**< particle velocity at its current time */
+  copyable_atomic<integertime> Ti_Current; /**< current time on integer timeline */
+  signed char TimeBinGrav;                 // 1-byte
+#ifndef LEAN
+  signed char TimeBinHydro;
+
+ private:
+  unsigned char Type; /**< flags particle type.  0=gas, 1=halo, 2=disk, 3=bulge, 4=stars, 5=bndry */
+ public:
+  copyable_atomic_flag access;
+#endif
+
   vector<MyFloat> GravAccel; /**< particle acceleration due to gravity */
 #if defined(PMGRID) && defined(PERIODIC) && !defined(TREEPM_NOTIMESPLIT)
   MyFloat GravPM[3]; /**< particle acceleration due to long-range PM gravity force */
 #endif
 
-  copyable_atomic<integertime> Ti_Current; /**< current time on integer timeline */
-  float OldAcc;                            /**< magnitude of old gravitational force. Used in relative opening criterion */
-  int GravCost;                            /**< weight factors used for balancing the work-load */
+  float OldAcc; /**< magnitude of old gravitational force. Used in relative opening criterion */
+  int GravCost; /**< weight factors used for balancing the work-load */
 
 #ifndef LEAN
  private:
@@ -56,27 +70,13 @@ struct particle_data
  public:
 #endif
 
-  MyIDStorage ID;           // 6-byte
-  signed char TimeBinGrav;  // 1-byte
-#ifndef LEAN
-  signed char TimeBinHydro;
-#endif
+  MyIDStorage ID;  // 6-byte
 #if defined(MERGERTREE) && defined(SUBFIND)
   compactrank_t PrevRankInSubhalo;  // 1-byte
   MyHaloNrType PrevSubhaloNr;       // 6-byte
   approxlen PrevSizeOfSubhalo;      // 2-byte
 #endif
 
-#ifndef LEAN
- private:
-  unsigned char Type; /**< flags particle type.  0=gas, 1=halo, 2=disk, 3=bulge, 4=stars, 5=bndry */
- public:
-#endif
-
-#ifndef LEAN
-  copyable_atomic_flag access;
-#endif
-
 #ifdef REARRANGE_OPTION
   unsigned long long TreeID;
 #endif
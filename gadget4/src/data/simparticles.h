@@ -89,48 +89,54 @@ class simparticles : public intposconvert, public setcomm
 #ifdef FOF
   MyIDStorage *MinID;
   int *Len;  // this is here enough in 32bit because only the group segments on the local processor are treated
-  int *Head, *Next, *Tail, *MinIDTask;
+  int *Head, *MinIDTask;
   MyFloat *fof_nearest_distance;
   MyFloat *fof_nearest_hsml;
 
   struct bit_flags
   {
-    unsigned char Nonlocal : 2, MinIDChanged : 2, Marked : 2;
+    unsigned char Nonlocal : 2, LinkNode : 2, Marked : 2;
   } * Flags;
 
   double LinkL;
 
+  /*! Returns the root of the local union-find tree of particle i. Head[] stores the parent of each particle, and every
+   *  other link on the path is short-cut on the way up (path halving), which keeps the trees flat.
+   */
+  inline int get_head(int i)
+  {
+    while(Head[i] != i)
+      {
+        Head[i] = Head[Head[i]];
+        i       = Head[i];
+      }
+
+    return i;
+  }
+
   inline void link_two_particles(int target, int j)
   {
-    if(Head[target] != Head[j]) /* only if not yet linked */
+    int p = get_head(target);
+    int s = get_head(j);
+
+    if(p != s) /* only if not yet linked */
       {
-        int p, s;
-        if(Len[Head[target]] > Len[Head[j]]) /* p group is longer */
+        if(Len[p] < Len[s]) /* the smaller tree is attached to the root of the larger one */
           {
-            p = target;
-            s = j;
+            int tmp = p;
+            p       = s;
+            s       = tmp;
           }
-        else
-          {
-            p = j;
-            s = target;
-          }
-        Next[Tail[Head[p]]] = Head[s];
 
-        Tail[Head[p]] = Tail[Head[s]];
+        Head[s] = p;
 
-        Len[Head[p]] += Len[Head[s]];
+        Len[p] += Len[s];
 
-        if(MinID[Head[s]].get() < MinID[Head[p]].get())
+        if(MinID[s].get() < MinID[p].get())
           {
-            MinID[Head[p]]     = MinID[Head[s]];
-            MinIDTask[Head[p]] = MinIDTask[Head[s]];
+            MinID[p]     = MinID[s];
+            MinIDTask[p] = MinIDTask[s];
           }
-
-        int ss = Head[s];
-        do
-          Head[ss] = Head[p];
-        while((ss = Next[ss]) >= 0);
       }
   }
 
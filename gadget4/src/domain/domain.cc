@@ -204,6 +204,121 @@ void domain<partset>::domain_printf(char *buf)
     }
 }
 
+#ifdef DOMAIN_MEASURED_COST_MODEL
+
+/*! This function is called once per step, before the timers of the step are reset, and adds the time spent in the
+ *  particle-based parts of the gravity, SPH and cooling/star formation computations, as well as the cost units processed
+ *  by them, to a decaying record that is kept separately for each highest active timebin. From this record the seconds
+ *  per cost unit are derived at the next domain decomposition.
+ */
+template <>
+void domain<simparticles>::domain_measure_step_cost(void)
+{
+  const double decay = 0.75; /* weight of the previous record when a new measurement for the same timebin comes in */
+
+  double time[COST_NSUB], units[COST_NSUB];
+
+  time[COST_GRAV]    = Logs.CPU_Step[logs::CPU_TREEWALK];
+  time[COST_SPH]     = Logs.CPU_Step[logs::CPU_DENSWALK] + Logs.CPU_Step[logs::CPU_HYDROWALK];
+  time[COST_SFRCOOL] = 0;
+#if defined(COOLING) || defined(STARFORMATION)
+  time[COST_SFRCOOL] += Logs.CPU_Step[logs::CPU_COOLING_SFR];
+#endif
+#ifdef COOLING_EQUILIBRIUM_TABLE
+  time[COST_SFRCOOL] += Logs.CPU_Step[logs::CPU_COOLING_TABLE];
+#endif
+
+  units[COST_GRAV] = 0;
+#ifdef HIERARCHICAL_GRAVITY
+  /* the particles that were active on this step have been moved to the synchronized timebins by now */
+  for(int i = 0; i < Tp->NumPart; i++)
+    if(Tp->P[i].TimeBinGrav <= All.HighestSynchronizedTimeBin)
+      units[COST_GRAV] += Tp->P[i].GravCost;
+#else
+  for(int i = 0; i < Tp->TimeBinsGravity.NActiveParticles; i++)
+    units[COST_GRAV] += Tp->P[Tp->TimeBinsGravity.ActiveParticleList[i]].GravCost;
+#endif
+  units[COST_SPH]     = Tp->TimeBinsHydro.NActiveParticles;
+  units[COST_SFRCOOL] = Tp->TimeBinsHydro.NActiveParticles;
+
+  int bin = All.HighestActiveTimeBin;
+
+  for(int k = 0; k < COST_NSUB; k++)
+    {
+      MeasuredTime[k][bin]  = decay * MeasuredTime[k][bin] + time[k];
+      MeasuredUnits[k][bin] = decay * MeasuredUnits[k][bin] + units[k];
+
+      IntervalTime += time[k];
+    }
+
+  IntervalSteps++;
+}
+
+/*! This function turns the measured record into seconds per cost unit for the timebins that are going to be balanced.
+ *  Timebins without measurements of their own fall back to the average over all timebins. If nothing has been measured
+ *  yet, the cost model stays inactive and the decomposition is done with the interaction counts alone. In addition, the
+ *  balance of the modelled time achieved since the last decomposition is determined.
+ */
+template <>
+void domain<simparticles>::domain_measured_cost_coefficients(void)
+{
+  double sum[2 * COST_NSUB * TIMEBINS + 1];
+
+  double *time  = &sum[0];
+  double *units = &sum[COST_NSUB * TIMEBINS];
+
+  memcpy(time, MeasuredTime, COST_NSUB * TIMEBINS * sizeof(double));
+  memcpy(units, MeasuredUnits, COST_NSUB * TIMEBINS * sizeof(double));
+  sum[2 * COST_NSUB * TIMEBINS] = IntervalTime;
+
+  MPI_Allreduce(MPI_IN_PLACE, sum, 2 * COST_NSUB * TIMEBINS + 1, MPI_DOUBLE, MPI_SUM, Communicator);
+
+  double max_interval = IntervalTime;
+  MPI_Allreduce(MPI_IN_PLACE, &max_interval, 1, MPI_DOUBLE, MPI_MAX, Communicator);
+
+  double avg_interval = sum[2 * COST_NSUB * TIMEBINS] / NTask;
+  IntervalBalance     = avg_interval > 0 ? max_interval / avg_interval : 0;
+
+  double secs_all[COST_NSUB], secs_tot = 0;
+
+  for(int k = 0; k < COST_NSUB; k++)
+    {
+      double t = 0, u = 0;
+
+      for(int bin = 0; bin < TIMEBINS; bin++)
+        {
+          t += time[k * TIMEBINS + bin];
+          u += units[k * TIMEBINS + bin];
+        }
+
+      secs_all[k] = u > 0 ? t / u : 0;
+      secs_tot += secs_all[k];
+    }
+
+  if(secs_tot <= 0)
+    return;
+
+  for(int n = 0; n < NumTimeBinsToBeBalanced; n++)
+    {
+      int bin = ListOfTimeBinsToBeBalanced[n];
+
+      double secs[COST_NSUB];
+
+      for(int k = 0; k < COST_NSUB; k++)
+        secs[k] = units[k * TIMEBINS + bin] > 0 ? time[k * TIMEBINS + bin] / units[k * TIMEBINS + bin] : secs_all[k];
+
+      GravSecPerUnit[n] = secs[COST_GRAV];
+      GasSecPerUnit[n]  = secs[COST_SPH] + secs[COST_SFRCOOL];
+
+      domain_printf("DOMAIN: measured cost model for timebin %2d: grav=%g  sph=%g  sfrcool=%g  sec per unit\n", bin,
+                    secs[COST_GRAV], secs[COST_SPH], secs[COST_SFRCOOL]);
+    }
+
+  MeasuredCostModelActive = 1;
+}
+
+#endif
+
 template <>
 void domain<simparticles>::domain_find_total_cost(void)
 {
@@ -248,8 +363,24 @@ void domain<simparticles>::domain_find_total_cost(void)
 
   MPI_Allreduce(MPI_IN_PLACE, sum, 2, MPI_LONG_LONG, MPI_SUM, Communicator);
 
-  NormFactorLoad    = 1.0 / sum[0];
-  NormFactorLoadSph = sum[1] > 0.0 ? 1.0 / sum[1] : 0.0;
+  NormFactorLoad          = 1.0 / sum[0];
+  NormFactorLoadSph       = sum[1] > 0.0 ? 1.0 / sum[1] : 0.0;
+  NormFactorLoadDm        = 0.0;
+  NormFactorLoadGasMemory = 0.0;
+
+#ifdef DOMAIN_MEASURED_COST_MODEL
+  if(Mode == STANDARD && sum[1] > 0 && sum[0] > sum[1])
+    {
+      /* with gas and collisionless particles present, balance the memory footprint in bytes, and in addition
+       * the number of collisionless particles as a constraint of its own
+       */
+      double mem = sum[0] * sizeof(particle_data) + sum[1] * sizeof(sph_particle_data);
+
+      NormFactorLoad          = sizeof(particle_data) / mem;
+      NormFactorLoadGasMemory = sizeof(sph_particle_data) / mem;
+      NormFactorLoadDm        = 1.0 / (sum[0] - sum[1]);
+    }
+#endif
 
   MultipleDomains = 0;
   TotalCost       = 0.0;
@@ -266,6 +397,12 @@ void domain<simparticles>::domain_find_total_cost(void)
       TotalCost += 1.0;
     }
 
+  if(NormFactorLoadDm > 0.0)
+    {
+      MultipleDomains += 1;
+      TotalCost += 1.0;
+    }
+
   MPI_Allreduce(MPI_IN_PLACE, GravCostPerListedTimeBin, NumTimeBinsToBeBalanced, MPI_DOUBLE, MPI_SUM, Communicator);
   MPI_Allreduce(MPI_IN_PLACE, HydroCostPerListedTimeBin, NumTimeBinsToBeBalanced, MPI_DOUBLE, MPI_SUM, Communicator);
 
@@ -273,8 +410,42 @@ void domain<simparticles>::domain_find_total_cost(void)
 
   double limit = 1.0 / (All.TopNodeFactor * NTask);
 
+  MeasuredCostModelActive = 0;
+
+#ifdef DOMAIN_MEASURED_COST_MODEL
+  if(Mode == STANDARD)
+    domain_measured_cost_coefficients();
+#endif
+
   for(int n = 0; n < NumTimeBinsToBeBalanced; n++)
     {
+#ifdef DOMAIN_MEASURED_COST_MODEL
+      if(MeasuredCostModelActive)
+        {
+          /* gravity and hydro work of the timebin form a single constraint, in which the cost units of
+           * the two are weighted with the measured time they take
+           */
+          double work = GravSecPerUnit[n] * GravCostPerListedTimeBin[n] + GasSecPerUnit[n] * HydroCostPerListedTimeBin[n];
+          double maxwork =
+              GravSecPerUnit[n] * MaxGravCostPerListedTimeBin[n] + (HydroCostPerListedTimeBin[n] > 0.0 ? GasSecPerUnit[n] : 0.0);
+
+          double fac = work > 0.0 ? 1.0 / work : 0.0;
+
+          if(maxwork * fac > limit)
+            fac = limit / maxwork;
+
+          if(work > 0.0)
+            MultipleDomains += 1;
+
+          GravCostNormFactors[n]  = GravSecPerUnit[n] * fac;
+          HydroCostNormFactors[n] = GasSecPerUnit[n] * fac;
+
+          TotalCost += GravCostPerListedTimeBin[n] * GravCostNormFactors[n];
+          TotalCost += HydroCostPerListedTimeBin[n] * HydroCostNormFactors[n];
+          continue;
+        }
+#endif
+
       if(GravCostPerListedTimeBin[n] > 0.0)
         MultipleDomains += 1;
 
@@ -303,8 +474,10 @@ void domain<lcparticles>::domain_find_total_cost(void)
 
   MPI_Allreduce(MPI_IN_PLACE, sum, 2, MPI_LONG_LONG, MPI_SUM, Communicator);
 
-  NormFactorLoad    = 1.0 / sum[0];
-  NormFactorLoadSph = sum[1] > 0.0 ? 1.0 / sum[1] : 0.0;
+  NormFactorLoad          = 1.0 / sum[0];
+  NormFactorLoadSph       = sum[1] > 0.0 ? 1.0 / sum[1] : 0.0;
+  NormFactorLoadDm        = 0.0;
+  NormFactorLoadGasMemory = 0.0;
 
   MultipleDomains = 0;
   TotalCost       = 0.0;
@@ -415,6 +588,29 @@ void domain<simparticles>::domain_report_balance(void)
   MPI_Reduce(loc_max_data, glob_sum_data, 2 * TIMEBINS, MPI_DOUBLE, MPI_SUM, 0, Communicator);
   MPI_Reduce(loc_max_data, glob_max_data, 2 * TIMEBINS + 3, MPI_DOUBLE, MPI_MAX, 0, Communicator);
 
+#ifdef DOMAIN_MEASURED_COST_MODEL
+  /* predicted modelled time of each task until the next decomposition, with each balanced timebin counted as often as
+   * it is going to be executed
+   */
+  double loc_work = 0, max_work = 0, sum_work = 0;
+
+  if(MeasuredCostModelActive)
+    for(int i = 0; i < Tp->NumPart; i++)
+      for(int n = 0; n < NumTimeBinsToBeBalanced; n++)
+        {
+          int bin = ListOfTimeBinsToBeBalanced[n];
+
+          if(bin >= Tp->P[i].TimeBinGrav)
+            loc_work += domain_grav_weight[bin] * GravSecPerUnit[n] * Tp->P[i].GravCost;
+
+          if(Tp->P[i].getType() == 0 && bin >= Tp->P[i].getTimeBinHydro())
+            loc_work += domain_hydro_weight[bin] * GasSecPerUnit[n];
+        }
+
+  MPI_Reduce(&loc_work, &max_work, 1, MPI_DOUBLE, MPI_MAX, 0, Communicator);
+  MPI_Reduce(&loc_work, &sum_work, 1, MPI_DOUBLE, MPI_SUM, 0, Communicator);
+#endif
+
   if(ThisTask == 0)
     {
       double max_tot = glob_max_data[2 * TIMEBINS + 0];
@@ -508,6 +704,27 @@ void domain<simparticles>::domain_report_balance(void)
                max_dm / (tot - tot_sph + SMALLNUM) * NTask, max_sph / (tot_sph + SMALLNUM) * NTask, max_tot / (tot + SMALLNUM) * NTask,
                max_gravcost / (tot_gravcost + SMALLNUM), max_hydrocost / (tot_hydrocost + SMALLNUM));
       domain_printf(buf);
+#ifdef DOMAIN_MEASURED_COST_MODEL
+      if(PredictedBalance > 0 && IntervalSteps > 0)
+        {
+          snprintf(buf, MAXLEN_PATH, "MEASURED,  previous decomposition over %d steps:  predicted %6.3f  achieved %6.3f\n",
+                   IntervalSteps, PredictedBalance, IntervalBalance);
+          domain_printf(buf);
+        }
+
+      PredictedBalance = sum_work > 0 ? max_work / (sum_work / NTask) : 0;
+
+      if(MeasuredCostModelActive)
+        {
+          snprintf(buf, MAXLEN_PATH, "MEASURED,  current decomposition:  predicted %6.3f\n", PredictedBalance);
+          domain_printf(buf);
+        }
+      else
+        {
+          snprintf(buf, MAXLEN_PATH, "MEASURED,  no timings recorded yet, cost model not used\n");
+          domain_printf(buf);
+        }
+#endif
       snprintf(buf, MAXLEN_PATH, "-------------------------------------------------------------------------------------\n");
       domain_printf(buf);
       snprintf(buf, MAXLEN_PATH, "\n");
@@ -515,6 +732,11 @@ void domain<simparticles>::domain_report_balance(void)
       myflush(Logs.FdDomain);
     }
 
+#ifdef DOMAIN_MEASURED_COST_MODEL
+  IntervalTime  = 0;
+  IntervalSteps = 0;
+#endif
+
   TIMER_STOPSTART(CPU_LOGS, CPU_DOMAIN);
 }
 
@@ -530,6 +752,18 @@ void domain<lcparticles>::domain_report_balance(void)
 {
 }
 
+#ifdef DOMAIN_MEASURED_COST_MODEL
+template <>
+void domain<lcparticles>::domain_measure_step_cost(void)
+{
+}
+
+template <>
+void domain<lcparticles>::domain_measured_cost_coefficients(void)
+{
+}
+#endif
+
 #endif
 
 #include "../data/simparticles.h"
@@ -85,6 +85,10 @@ class domain : public setcomm
   void domain_free(void);
   void domain_resize_storage(int count_get, int count_get_sph, int option_flag);
 
+#ifdef DOMAIN_MEASURED_COST_MODEL
+  void domain_measure_step_cost(void);
+#endif
+
   size_t domain_sizeof_topnode_data(void) { return sizeof(topnode_data); }
 
  private:
@@ -123,6 +127,7 @@ class domain : public setcomm
     double bin_HydroCost[TIMEBINS];
     double load;
     double loadsph;
+    double loaddm;
   };
 
   // domain_segments_data *domainAssign;
@@ -142,8 +147,34 @@ class domain : public setcomm
   double HydroCostNormFactors[TIMEBINS];
   double NormFactorLoad;
   double NormFactorLoadSph;
+  double NormFactorLoadDm;        /**< non-zero only if the collisionless particles are balanced as a constraint of their own */
+  double NormFactorLoadGasMemory; /**< extra memory load of a gas particle, non-zero only if the memory is balanced in bytes */
   double TotalCost;
 
+  int MeasuredCostModelActive = 0; /**< if set, gravity and hydro cost of a timebin are combined into one measured work constraint */
+
+#ifdef DOMAIN_MEASURED_COST_MODEL
+  /** the subsystems whose measured time per particle enters the cost model */
+  enum
+  {
+    COST_GRAV,
+    COST_SPH,
+    COST_SFRCOOL,
+    COST_NSUB
+  };
+
+  double MeasuredTime[COST_NSUB][TIMEBINS]  = {}; /**< decaying sum of the time spent per subsystem on steps with given top bin */
+  double MeasuredUnits[COST_NSUB][TIMEBINS] = {}; /**< decaying sum of the cost units processed on these steps */
+  double IntervalTime                       = 0;  /**< modelled time spent since the last domain decomposition */
+  int IntervalSteps                         = 0;  /**< number of steps done since the last domain decomposition */
+  double IntervalBalance                    = 0;  /**< achieved balance of the modelled time since the last decomposition */
+  double PredictedBalance                   = 0;  /**< balance of the modelled time predicted for the current decomposition */
+  double GravSecPerUnit[TIMEBINS];                /**< measured seconds per unit of GravCost for the listed timebins */
+  double GasSecPerUnit[TIMEBINS];                 /**< measured seconds per active gas particle for the listed timebins */
+
+  void domain_measured_cost_coefficients(void);
+#endif
+
   int domain_grav_weight[TIMEBINS];
   int domain_hydro_weight[TIMEBINS];
   int domain_to_be_balanced[TIMEBINS];
@@ -128,12 +128,14 @@ void domain<partset>::domain_combine_multipledomains(void)
    * later on efficiently for different choices of nextra
    */
 
-  double *cost_data = (double *)Mem.mymalloc_clear("cost_data", sizeof(double) * 2 * NTopleaves * (NumTimeBinsToBeBalanced + 1));
+  int ncost_data     = NTopleaves * (3 + 2 * NumTimeBinsToBeBalanced);
+  double *cost_data = (double *)Mem.mymalloc_clear("cost_data", sizeof(double) * ncost_data);
 
   double *load         = cost_data;
   double *loadsph      = cost_data + NTopleaves;
-  double *binGravCost  = cost_data + 2 * NTopleaves;
-  double *binHydroCost = cost_data + 2 * NTopleaves + NTopleaves * NumTimeBinsToBeBalanced;
+  double *loaddm       = cost_data + 2 * NTopleaves;
+  double *binGravCost  = cost_data + 3 * NTopleaves;
+  double *binHydroCost = cost_data + 3 * NTopleaves + NTopleaves * NumTimeBinsToBeBalanced;
 
   for(int i = 0; i < Tp->NumPart; i++)
     {
@@ -162,14 +164,25 @@ void domain<partset>::domain_combine_multipledomains(void)
             }
 
           loadsph[no] += NormFactorLoadSph;
+          load[no] += NormFactorLoadGasMemory;
         }
+      else
+        loaddm[no] += NormFactorLoadDm;
     }
 
-  allreduce_sum<double>(cost_data, 2 * NTopleaves * (NumTimeBinsToBeBalanced + 1), Communicator);
+  allreduce_sum<double>(cost_data, ncost_data, Communicator);
   /*
-  MPI_Allreduce(MPI_IN_PLACE, cost_data, 2 * NTopleaves * (NumTimeBinsToBeBalanced + 1), MPI_DOUBLE, MPI_SUM, Communicator);
+  MPI_Allreduce(MPI_IN_PLACE, cost_data, ncost_data, MPI_DOUBLE, MPI_SUM, Communicator);
 */
 
+  /* with the measured cost model, gravity and hydro work of a timebin are balanced as a single constraint */
+  if(MeasuredCostModelActive)
+    for(int i = 0; i < NTopleaves * NumTimeBinsToBeBalanced; i++)
+      {
+        binGravCost[i] += binHydroCost[i];
+        binHydroCost[i] = 0;
+      }
+
 #ifdef DOMAIN_SPECIAL_CHECK
   if(All.NumCurrentTiStep == 0 || All.NumCurrentTiStep == 2 || All.NumCurrentTiStep == 4)
     {
@@ -306,9 +319,10 @@ void domain<partset>::domain_combine_multipledomains(void)
                   {
                     domainAssign[n].load += load[no];
                     domainAssign[n].loadsph += loadsph[no];
+                    domainAssign[n].loaddm += loaddm[no];
 
-                    total_load += load[no] + loadsph[no];
-                    total_cost += load[no] + loadsph[no];
+                    total_load += load[no] + loadsph[no] + loaddm[no];
+                    total_cost += load[no] + loadsph[no] + loaddm[no];
 
                     for(int i = 0; i < NumTimeBinsToBeBalanced; i++)
                       {
@@ -340,13 +354,14 @@ void domain<partset>::domain_combine_multipledomains(void)
             double bin_HydroCost[TIMEBINS];
             double load;
             double loadsph;
+            double loaddm;
           };
 
           tasklist_data *tasklist = (tasklist_data *)Mem.mymalloc_clear("tasklist", NTask * sizeof(tasklist_data));
 
           int n_cost_items = 0;
-          cost_queue_data *cost_queues[2 * TIMEBINS + 2];
-          int first_unusued_in_cost_queue[2 * TIMEBINS + 2];
+          cost_queue_data *cost_queues[2 * TIMEBINS + 3];
+          int first_unusued_in_cost_queue[2 * TIMEBINS + 3];
 
           for(int n = 0; n < NumTimeBinsToBeBalanced; n++)
             {
@@ -367,7 +382,7 @@ void domain<partset>::domain_combine_multipledomains(void)
                   n_cost_items++;
                 }
 
-              if(HydroCostNormFactors[n] > 0.0)
+              if(HydroCostNormFactors[n] > 0.0 && !MeasuredCostModelActive)
                 {
                   cost_queues[n_cost_items] = (cost_queue_data *)Mem.mymalloc("cost_queues", ndomains * sizeof(cost_queue_data));
                   for(int i = 0; i < ndomains; i++)
@@ -419,6 +434,23 @@ void domain<partset>::domain_combine_multipledomains(void)
               n_cost_items++;
             }
 
+          if(NormFactorLoadDm > 0.0)
+            {
+              cost_queues[n_cost_items] = (cost_queue_data *)Mem.mymalloc("cost_queues", ndomains * sizeof(cost_queue_data));
+              for(int i = 0; i < ndomains; i++)
+                {
+                  cost_queues[n_cost_items][i].value = domainAssign[i].loaddm;
+                  cost_queues[n_cost_items][i].index = i;
+                }
+#ifdef SIMPLE_DOMAIN_AGGREGATION
+              domain_determinate_aggregated_value(cost_queues[n_cost_items], ndomains);
+#endif
+              mycxxsort(cost_queues[n_cost_items], cost_queues[n_cost_items] + ndomains, domain_sort_cost_queue_data);
+              first_unusued_in_cost_queue[n_cost_items] = 0;
+
+              n_cost_items++;
+            }
+
           int nextqueue     = 0;
           int ndomains_left = ndomains;
           int target        = 0;
@@ -454,6 +486,9 @@ void domain<partset>::domain_combine_multipledomains(void)
                   if(max_cost < tasklist[target].loadsph + domainAssign[n].loadsph)
                     max_cost = tasklist[target].loadsph + domainAssign[n].loadsph;
 
+                  if(max_cost < tasklist[target].loaddm + domainAssign[n].loaddm)
+                    max_cost = tasklist[target].loaddm + domainAssign[n].loaddm;
+
                   for(int bin = 0; bin < NumTimeBinsToBeBalanced; bin++)
                     {
                       if(max_cost < tasklist[target].bin_GravCost[bin] + domainAssign[n].bin_GravCost[bin])
@@ -484,6 +519,7 @@ void domain<partset>::domain_combine_multipledomains(void)
 
                   tasklist[target].load += domainAssign[n].load;
                   tasklist[target].loadsph += domainAssign[n].loadsph;
+                  tasklist[target].loaddm += domainAssign[n].loaddm;
                   for(int bin = 0; bin < NumTimeBinsToBeBalanced; bin++)
                     {
                       tasklist[target].bin_GravCost[bin] += domainAssign[n].bin_GravCost[bin];
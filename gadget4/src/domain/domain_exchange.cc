@@ -221,8 +221,8 @@ void domain<partset>::domain_exchange(void)
 #ifdef USE_MPIALLTOALLV_IN_DOMAINDECOMP
   int method = 0;
 #else
-#ifndef ISEND_IRECV_IN_DOMAIN /* synchronous communication */
-  int method = 1;
+#ifndef ISEND_IRECV_IN_DOMAIN /* non-blocking communication with the tasks that exchange data only */
+  int method = 3;
 #else
   int method = 2; /* asynchronous communication */
 #endif
@@ -611,21 +611,8 @@ void domain<partset>::particle_exchange_based_on_PS(MPI_Comm Communicator)
                      max_loadsph < (1.0 - 3 * ALLOC_TOLERANCE) * Tp->MaxPartSph)
                     Tp->reallocate_memory_maxpartsph(max_loadsph / (1.0 - 2 * ALLOC_TOLERANCE));
 
-                  for(int ngrp = 1; ngrp < (1 << CommPTask); ngrp++)
-                    {
-                      int target = CommThisTask ^ ngrp;
-
-                      if(target < CommNTask)
-                        {
-                          if(Send_count[target] > 0 || Recv_count[target] > 0)
-                            {
-                              myMPI_Sendrecv(sphBuf + Send_offset[target], Send_count[target] * sizeof(sph_particle_data), MPI_BYTE,
-                                             target, TAG_SPHDATA, Tp->SphP + Recv_offset[target] + nstay,
-                                             Recv_count[target] * sizeof(sph_particle_data), MPI_BYTE, target, TAG_SPHDATA,
-                                             Communicator, MPI_STATUS_IGNORE);
-                            }
-                        }
-                    }
+                  myMPI_Sparse_alltoallv(sphBuf, Send_count, Send_offset, Tp->SphP + nstay, Recv_count, Recv_offset,
+                                         sizeof(sph_particle_data), TAG_SPHDATA, Communicator);
 
                   Mem.myfree(sphBuf);
                 }
@@ -716,20 +703,8 @@ void domain<partset>::particle_exchange_based_on_PS(MPI_Comm Communicator)
                           (nstay - nlocal) * sizeof(pdata));
                 }
 
-              for(int ngrp = 1; ngrp < (1 << CommPTask); ngrp++)
-                {
-                  int target = CommThisTask ^ ngrp;
-
-                  if(target < CommNTask)
-                    {
-                      if(Send_count[target] > 0 || Recv_count[target] > 0)
-                        {
-                          myMPI_Sendrecv(partBuf + Send_offset[target], Send_count[target] * sizeof(pdata), MPI_BYTE, target,
-                                         TAG_PDATA, Tp->P + Recv_offset[target] + nlocal, Recv_count[target] * sizeof(pdata), MPI_BYTE,
-                                         target, TAG_PDATA, Communicator, MPI_STATUS_IGNORE);
-                        }
-                    }
-                }
+              myMPI_Sparse_alltoallv(partBuf, Send_count, Send_offset, Tp->P + nlocal, Recv_count, Recv_offset, sizeof(pdata),
+                                     TAG_PDATA, Communicator);
 
               Mem.myfree(partBuf);
             }
@@ -814,20 +789,8 @@ void domain<partset>::particle_exchange_based_on_PS(MPI_Comm Communicator)
                   memmove(Tp->PS + nlocal + nimport, Tp->PS + nlocal, (nstay - nlocal) * sizeof(subfind_data));
                 }
 
-              for(int ngrp = 1; ngrp < (1 << CommPTask); ngrp++)
-                {
-                  int target = CommThisTask ^ ngrp;
-
-                  if(target < CommNTask)
-                    {
-                      if(Send_count[target] > 0 || Recv_count[target] > 0)
-                        {
-                          myMPI_Sendrecv(subBuf + Send_offset[target], Send_count[target] * sizeof(subfind_data), MPI_BYTE, target,
-                                         TAG_KEY, Tp->PS + Recv_offset[target] + nlocal, Recv_count[target] * sizeof(subfind_data),
-                                         MPI_BYTE, target, TAG_KEY, Communicator, MPI_STATUS_IGNORE);
-                        }
-                    }
-                }
+              myMPI_Sparse_alltoallv(subBuf, Send_count, Send_offset, Tp->PS + nlocal, Recv_count, Recv_offset, sizeof(subfind_data),
+                                     TAG_KEY, Communicator);
 
               Mem.myfree(subBuf);
             }
@@ -192,7 +192,9 @@ void domain<partset>::domain_determineTopTree(void)
       mp[i].cost += NormFactorLoad;
 
       if(Tp->P[i].getType() == 0)
-        mp[i].cost += NormFactorLoadSph;
+        mp[i].cost += NormFactorLoadSph + NormFactorLoadGasMemory;
+      else
+        mp[i].cost += NormFactorLoadDm;
 
       sum += mp[i].cost;
     }
@@ -669,21 +669,8 @@ void fof<partset>::fof_compile_catalogue(double inner_distance)
   fof_group_list *get_FOF_GList = (fof_group_list *)Mem.mymalloc("get_FOF_GList", nimport * sizeof(fof_group_list));
 
   /* get them */
-  for(int ngrp = 1; ngrp < (1 << PTask); ngrp++)
-    {
-      int recvTask = ThisTask ^ ngrp;
-
-      if(recvTask < NTask)
-        {
-          if(Send_count[recvTask] > 0 || Recv_count[recvTask] > 0)
-            {
-              /* get the group info */
-              myMPI_Sendrecv(&FOF_GList[Send_offset[recvTask]], Send_count[recvTask] * sizeof(fof_group_list), MPI_BYTE, recvTask,
-                             TAG_DENS_A, &get_FOF_GList[Recv_offset[recvTask]], Recv_count[recvTask] * sizeof(fof_group_list),
-                             MPI_BYTE, recvTask, TAG_DENS_A, Communicator, MPI_STATUS_IGNORE);
-            }
-        }
-    }
+  myMPI_Sparse_alltoallv(FOF_GList, Send_count, Send_offset, get_FOF_GList, Recv_count, Recv_offset, sizeof(fof_group_list),
+                         TAG_DENS_A, Communicator);
 
   /* for the incoming pieces, we re-purpose MinIDTask and set it in ascending order in order to use this later to reestablish the order
    * we had */
@@ -745,21 +732,8 @@ void fof<partset>::fof_compile_catalogue(double inner_distance)
     get_FOF_GList[i].MinIDTask = ThisTask;
 
   /* bring the data back to the originating processors */
-  for(int ngrp = 1; ngrp < (1 << PTask); ngrp++)
-    {
-      int recvTask = ThisTask ^ ngrp;
-
-      if(recvTask < NTask)
-        {
-          if(Send_count[recvTask] > 0 || Recv_count[recvTask] > 0)
-            {
-              /* get the group info */
-              myMPI_Sendrecv(&get_FOF_GList[Recv_offset[recvTask]], Recv_count[recvTask] * sizeof(fof_group_list), MPI_BYTE, recvTask,
-                             TAG_DENS_A, &FOF_GList[Send_offset[recvTask]], Send_count[recvTask] * sizeof(fof_group_list), MPI_BYTE,
-                             recvTask, TAG_DENS_A, Communicator, MPI_STATUS_IGNORE);
-            }
-        }
-    }
+  myMPI_Sparse_alltoallv(get_FOF_GList, Recv_count, Recv_offset, FOF_GList, Send_count, Send_offset, sizeof(fof_group_list),
+                         TAG_DENS_A, Communicator);
 
   /* free our temporary list */
   Mem.myfree(get_FOF_GList);
@@ -1045,21 +1019,8 @@ void fof<partset>::fof_add_in_properties_of_group_segments(void)
 
   group_properties *get_Group = (group_properties *)Mem.mymalloc("get_Group", sizeof(group_properties) * nimport);
 
-  for(int ngrp = 1; ngrp < (1 << PTask); ngrp++)
-    {
-      int recvTask = ThisTask ^ ngrp;
-
-      if(recvTask < NTask)
-        {
-          if(Send_count[recvTask] > 0 || Recv_count[recvTask] > 0)
-            {
-              /* get the group data */
-              myMPI_Sendrecv(&Group[Send_offset[recvTask]], Send_count[recvTask] * sizeof(group_properties), MPI_BYTE, recvTask,
-                             TAG_DENS_A, &get_Group[Recv_offset[recvTask]], Recv_count[recvTask] * sizeof(group_properties), MPI_BYTE,
-                             recvTask, TAG_DENS_A, Communicator, MPI_STATUS_IGNORE);
-            }
-        }
-    }
+  myMPI_Sparse_alltoallv(Group, Send_count, Send_offset, get_Group, Recv_count, Recv_offset, sizeof(group_properties), TAG_DENS_A,
+                         Communicator);
 
   /* sort the groups again according to MinID */
   mycxxsort(Group, Group + NgroupsExt, fof_compare_Group_MinID);
@@ -459,6 +459,16 @@ class fof : public setcomm
   long long count_decisions;
   long long count_different_decisions;
 
+  /* statistics of the work done in subfind_unbind(), reported once all halos have been processed */
+  long long unbind_count_calls;
+  long long unbind_count_phases_full;
+  long long unbind_count_phases_delta;
+  long long unbind_count_pot_full;  /* number of particles for which the potential was computed from scratch */
+  long long unbind_count_pot_delta; /* number of particles whose potential was corrected for removed particles */
+  double unbind_time_pot_full;
+  double unbind_time_pot_delta;
+  double unbind_time_energies;
+
   struct sort_density_data
   {
     MyFloat density;
@@ -63,8 +63,12 @@
  *
  *  The correction fields are stored on disk once they are computed. If a
  *  corresponding file is found, they are loaded from disk to speed up the
- *  initialization. The Ewald summation issrc/gravtree_forcetest.c done in parallel, i.e. the
+ *  initialization. The Ewald summation is done in parallel, i.e. the
  *  processors share the work to compute the tables if needed.
+ *
+ *  The table is held only once per shared memory node (see ewald_allocate_table()),
+ *  and the MPI ranks of a node access it directly. Only the first rank of each node
+ *  takes part in the exchange of the table between the nodes.
  */
 void ewald::ewald_init(void)
 {
@@ -74,7 +78,19 @@ void ewald::ewald_init(void)
   FacCoordToInt = pow(2.0, BITS_FOR_POSITIONS) / RegionLen;
   FacIntToCoord = RegionLen / pow(2.0, BITS_FOR_POSITIONS);
 
-  Ewd = (ewald_data *)Mem.mymalloc("Ewd", sizeof(ewald_data) * (ENX + 1) * (ENY + 1) * (ENZ + 1));
+  ewald_allocate_table();
+
+  /* communicator of the simulation ranks that share the table, and one that links the first ranks of all nodes */
+  MPI_Comm node_comm, leader_comm;
+  int node_thistask, node_ntask;
+
+  MPI_Comm_split(Communicator, Shmem.Island_Smallest_WorldTask, ThisTask, &node_comm);
+  MPI_Comm_rank(node_comm, &node_thistask);
+  MPI_Comm_size(node_comm, &node_ntask);
+
+  MPI_Comm_split(Communicator, node_thistask == 0 ? 0 : MPI_UNDEFINED, ThisTask, &leader_comm);
+
+  int size = (ENX + 1) * (ENY + 1) * (ENZ + 1);
 
   char buf[MAXLEN_PATH_EXTRA];
   snprintf(buf, MAXLEN_PATH_EXTRA, "ewald_table_%d-%d-%d_%d-%d-%d_precision%d-order%d.dat", LONG_X, LONG_Y, LONG_Z, ENX, ENY, ENZ,
@@ -105,7 +121,7 @@ void ewald::ewald_init(void)
             }
           else
             {
-              my_fread(Ewd, sizeof(ewald_data), (ENX + 1) * (ENY + 1) * (ENZ + 1), fd);
+              my_fread(Ewd, sizeof(ewald_data), size, fd);
 
               recomputeflag = 0;
             }
@@ -121,12 +137,30 @@ void ewald::ewald_init(void)
     {
       mpi_printf("\nEWALD: No usable Ewald tables in file `%s' found. Recomputing them...\n", buf);
 
-      /* ok, let's recompute things. Actually, we do that in parallel. */
+      /* ok, let's recompute things. Actually, we do that in parallel. The ranks are enumerated node by node
+       * such that each node computes a contiguous piece of the table.
+       */
 
-      int size = (ENX + 1) * (ENY + 1) * (ENZ + 1);
-      int first, count;
+      int nnodes = 0, node_first_task = 0;
+      int *node_ntasks = NULL;
 
-      subdivide_evenly(size, NTask, ThisTask, &first, &count);
+      if(node_thistask == 0)
+        {
+          int leader_thistask;
+          MPI_Comm_rank(leader_comm, &leader_thistask);
+          MPI_Comm_size(leader_comm, &nnodes);
+
+          node_ntasks = (int *)Mem.mymalloc("node_ntasks", nnodes * sizeof(int));
+          MPI_Allgather(&node_ntask, 1, MPI_INT, node_ntasks, 1, MPI_INT, leader_comm);
+
+          for(int n = 0; n < leader_thistask; n++)
+            node_first_task += node_ntasks[n];
+        }
+
+      MPI_Bcast(&node_first_task, 1, MPI_INT, 0, node_comm);
+
+      int first, count;
+      subdivide_evenly(size, NTask, node_first_task + node_thistask, &first, &count);
 
       for(int n = first; n < first + count; n++)
         {
@@ -245,21 +279,31 @@ void ewald::ewald_init(void)
 #endif
         }
 
-      int *recvcnts = (int *)Mem.mymalloc("recvcnts", NTask * sizeof(int));
-      int *recvoffs = (int *)Mem.mymalloc("recvoffs", NTask * sizeof(int));
+      /* wait until the ranks of the node have filled in their pieces */
+      MPI_Barrier(node_comm);
 
-      for(int i = 0; i < NTask; i++)
+      if(node_thistask == 0)
         {
-          int off, cnt;
-          subdivide_evenly(size, NTask, i, &off, &cnt);
-          recvcnts[i] = cnt * sizeof(ewald_data);
-          recvoffs[i] = off * sizeof(ewald_data);
-        }
+          int *recvcnts = (int *)Mem.mymalloc("recvcnts", nnodes * sizeof(int));
+          int *recvoffs = (int *)Mem.mymalloc("recvoffs", nnodes * sizeof(int));
 
-      myMPI_Allgatherv(MPI_IN_PLACE, size * sizeof(ewald_data), MPI_BYTE, Ewd, recvcnts, recvoffs, MPI_BYTE, Communicator);
+          for(int n = 0, task = 0; n < nnodes; task += node_ntasks[n++])
+            {
+              int off_first, cnt_first, off_last, cnt_last;
+              subdivide_evenly(size, NTask, task, &off_first, &cnt_first);
+              subdivide_evenly(size, NTask, task + node_ntasks[n] - 1, &off_last, &cnt_last);
+              recvcnts[n] = (off_last + cnt_last - off_first) * sizeof(ewald_data);
+              recvoffs[n] = off_first * sizeof(ewald_data);
+            }
 
-      Mem.myfree(recvoffs);
-      Mem.myfree(recvcnts);
+          myMPI_Allgatherv(MPI_IN_PLACE, size * sizeof(ewald_data), MPI_BYTE, Ewd, recvcnts, recvoffs, MPI_BYTE, leader_comm);
+
+          Mem.myfree(recvoffs);
+          Mem.myfree(recvcnts);
+          Mem.myfree(node_ntasks);
+        }
+
+      MPI_Barrier(node_comm);
 
       mpi_printf("\nEWALD: writing Ewald tables to file `%s'\n", buf);
       if(ThisTask == 0)
@@ -279,7 +323,7 @@ void ewald::ewald_init(void)
 #endif
               my_fwrite(&tabh, sizeof(ewald_header), 1, fd);
 
-              my_fwrite(Ewd, sizeof(ewald_data), (ENX + 1) * (ENY + 1) * (ENZ + 1), fd);
+              my_fwrite(Ewd, sizeof(ewald_data), size, fd);
               fclose(fd);
             }
           else
@@ -288,68 +332,91 @@ void ewald::ewald_init(void)
     }
   else
     {
-      /* here we got them from disk */
-      int len = (ENX + 1) * (ENY + 1) * (ENZ + 1) * sizeof(ewald_data);
-      MPI_Bcast(Ewd, len, MPI_BYTE, 0, Communicator);
+      /* here we got them from disk, and only the other nodes need a copy */
+      if(node_thistask == 0)
+        MPI_Bcast(Ewd, size * sizeof(ewald_data), MPI_BYTE, 0, leader_comm);
     }
 
+  /* make sure that the table is complete (and written to disk) before it gets rescaled */
+  MPI_Barrier(node_comm);
+
   Ewd_fac_intp[0] = 2.0 * EN * LONG_X / All.BoxSize;
   Ewd_fac_intp[1] = 2.0 * EN * LONG_Y / All.BoxSize;
   Ewd_fac_intp[2] = 2.0 * EN * LONG_Z / All.BoxSize;
 
-  /* now scale things to the boxsize that is actually used */
-  for(int i = 0; i <= ENX; i++)
-    for(int j = 0; j <= ENY; j++)
-      for(int k = 0; k <= ENZ; k++)
-        {
-          ewald_data *ewdp = Ewd + ewd_offset(i, j, k);
+  /* now scale things to the boxsize that is actually used, the ranks of a node share this work */
+  int first, count;
+  subdivide_evenly(size, node_ntask, node_thistask, &first, &count);
+
+  for(int n = first; n < first + count; n++)
+    {
+      ewald_data *ewdp = Ewd + n;
 
-          ewdp->D0phi *= 1 / All.BoxSize; /* potential */
-          ewdp->D1phi *= 1 / pow(All.BoxSize, 2);
-          ewdp->D2phi *= 1 / pow(All.BoxSize, 3);
-          ewdp->D3phi *= 1 / pow(All.BoxSize, 4);
+      ewdp->D0phi *= 1 / All.BoxSize; /* potential */
+      ewdp->D1phi *= 1 / pow(All.BoxSize, 2);
+      ewdp->D2phi *= 1 / pow(All.BoxSize, 3);
+      ewdp->D3phi *= 1 / pow(All.BoxSize, 4);
 #if(HIGHEST_NEEDEDORDER_EWALD_DPHI + EWALD_TAYLOR_ORDER) >= 4
-          ewdp->D4phi *= 1 / pow(All.BoxSize, 5);
+      ewdp->D4phi *= 1 / pow(All.BoxSize, 5);
 #endif
 #if(HIGHEST_NEEDEDORDER_EWALD_DPHI + EWALD_TAYLOR_ORDER) >= 5
-          ewdp->D5phi *= 1 / pow(All.BoxSize, 6);
+      ewdp->D5phi *= 1 / pow(All.BoxSize, 6);
 #endif
 #if(HIGHEST_NEEDEDORDER_EWALD_DPHI + EWALD_TAYLOR_ORDER) >= 6
-          ewdp->D6phi *= 1 / pow(All.BoxSize, 7);
+      ewdp->D6phi *= 1 / pow(All.BoxSize, 7);
 #endif
 #if(HIGHEST_NEEDEDORDER_EWALD_DPHI + EWALD_TAYLOR_ORDER) >= 7
-          ewdp->D7phi *= 1 / pow(All.BoxSize, 8);
+      ewdp->D7phi *= 1 / pow(All.BoxSize, 8);
 #endif
-        }
+    }
+
+  MPI_Barrier(node_comm);
+
+  if(node_thistask == 0)
+    MPI_Comm_free(&leader_comm);
+  MPI_Comm_free(&node_comm);
 
   mpi_printf("EWALD: Initialization of periodic boundaries finished.\n");
 
   ewald_is_initialized = 1;
 
+#ifdef EWALD_TEST
+  test_interpolation_accuracy();
+#endif
+}
+
+/*! \brief Allocates the Ewald table once per shared memory node and points Ewd to it
+ *
+ *  If we have multiple shared memory nodes, one MPI rank on each of them is set aside for shared memory communication, and
+ *  this rank hosts the table. Otherwise, the table is stored by the first MPI rank. In both cases, all other ranks on the
+ *  node access the table directly through the shared memory window.
+ */
+void ewald::ewald_allocate_table(void)
+{
+  size_t tab_len = sizeof(ewald_data) * (ENX + 1) * (ENY + 1) * (ENZ + 1);
+  ptrdiff_t off;
+
   if(Shmem.Island_NTask != Shmem.World_NTask)
     {
-      // We actually have multiple shared memory nodes in which we set aside one MPI rank for shared memory communication.
-      // In this case, move the ewaldtable to the communication rank in order to consume this memory only once on the node
-
       if(Shmem.Island_ThisTask == 0)
-        {
-          size_t tab_len = sizeof(ewald_data) * (ENX + 1) * (ENY + 1) * (ENZ + 1);
+        MPI_Send(&tab_len, sizeof(tab_len), MPI_BYTE, Shmem.MyShmRankInGlobal, TAG_EWALD_ALLOC, MPI_COMM_WORLD);
 
-          MPI_Send(&tab_len, sizeof(tab_len), MPI_BYTE, Shmem.MyShmRankInGlobal, TAG_EWALD_ALLOC, MPI_COMM_WORLD);
-          MPI_Send(Ewd, tab_len, MPI_BYTE, Shmem.MyShmRankInGlobal, TAG_DMOM, MPI_COMM_WORLD);
-        }
-
-      Mem.myfree(Ewd);
-
-      ptrdiff_t off;
       MPI_Bcast(&off, sizeof(ptrdiff_t), MPI_BYTE, Shmem.Island_NTask - 1, Shmem.SharedMemComm);
 
       Ewd = (ewald_data *)((char *)Shmem.SharedMemBaseAddr[Shmem.Island_NTask - 1] + off);
     }
+  else
+    {
+      if(Shmem.Island_ThisTask == 0)
+        {
+          Ewd = (ewald_data *)Mem.mymalloc("Ewd", tab_len);
+          off = ((char *)Ewd - Mem.Base);
+        }
 
-#ifdef EWALD_TEST
-  test_interpolation_accuracy();
-#endif
+      MPI_Bcast(&off, sizeof(ptrdiff_t), MPI_BYTE, 0, Shmem.SharedMemComm);
+
+      Ewd = (ewald_data *)((char *)Shmem.SharedMemBaseAddr[0] + off);
+    }
 }
 
 void ewald::ewald_gridlookup(const MyIntPosType *p_intpos, const MyIntPosType *target_intpos, enum interpolate_options flag,
@@ -90,6 +90,8 @@ class ewald : public intposconvert, public io_streamcount, public setcomm
  private:
   ewald_data *Ewd;  // points to an [ENX + 1][ENY + 1][ENZ + 1] array
 
+  void ewald_allocate_table(void);
+
   inline int ewd_offset(int i, int j, int k) { return (i * (ENY + 1) + j) * (ENZ + 1) + k; }
   inline double specerf(double z, double k, double alpha);
   inline double d_specerf(double z, double k, double alpha);
@@ -218,13 +218,22 @@ void sim::gravity(int timebin)
   else
 #endif
     {
-      GravTree.treeallocate(Sp.NumPart, &Sp, &Domain);
+#ifdef GRAVITY_TREE_REUSE
+      /* if the tree of the last force calculation is still there, try to update it for the current positions */
+      if(GravTree.TreeIsKept && GravTree.treeupdate() < 0)
+        gravity_free_kept_tree();
+
+      if(!GravTree.TreeIsKept)
+#endif
+        {
+          GravTree.treeallocate(Sp.NumPart, &Sp, &Domain);
 
 #ifdef HIERARCHICAL_GRAVITY
-      GravTree.treebuild(Sp.TimeBinsGravity.NActiveParticles, Sp.TimeBinsGravity.ActiveParticleList);
+          GravTree.treebuild(Sp.TimeBinsGravity.NActiveParticles, Sp.TimeBinsGravity.ActiveParticleList);
 #else
-    GravTree.treebuild(Sp.NumPart, NULL);
+        GravTree.treebuild(Sp.NumPart, NULL);
 #endif
+        }
 
 #ifdef FMM
       GravTree.gravity_fmm(timebin);
@@ -232,7 +241,11 @@ void sim::gravity(int timebin)
     GravTree.gravity_tree(timebin);
 #endif
 
+#ifdef GRAVITY_TREE_REUSE
+      GravTree.TreeIsKept = 1; /* the tree is only freed once the particle set or the domain decomposition changes */
+#else
       GravTree.treefree();
+#endif
     }
 
   /* now multplify with G and add things for comoving integration */
@@ -245,6 +258,22 @@ void sim::gravity(int timebin)
 #endif
 }
 
+#ifdef GRAVITY_TREE_REUSE
+/*! \brief frees the gravity tree kept from the last force calculation
+ *
+ *  This needs to be called before the domain decomposition, or the particle storage, is changed, and before any memory
+ *  allocated earlier than the tree is released.
+ */
+void sim::gravity_free_kept_tree(void)
+{
+  if(GravTree.TreeIsKept)
+    {
+      GravTree.treefree();
+      GravTree.TreeIsKept = 0;
+    }
+}
+#endif
+
 void sim::gravity_set_oldacc(int timebin)
 {
 #ifdef HIERARCHICAL_GRAVITY
@@ -137,6 +137,9 @@ void sim::second_order_ic_correction(void)
 
   /* put in an extra domain decomposition because particle positions have been shifted */
 
+#ifdef GRAVITY_TREE_REUSE
+  gravity_free_kept_tree();
+#endif
   NgbTree.treefree();
   Domain.domain_free();
   Domain.domain_decomposition(STANDARD);
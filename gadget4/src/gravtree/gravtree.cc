@@ -178,21 +178,8 @@ void gravtree<partset>::gravity_exchange_forces(void)
       (resultsactiveimported_data *)Mem.mymalloc("tmp_results", Nexport * sizeof(resultsactiveimported_data));
 
   /* exchange  data */
-  for(int ngrp = 1; ngrp < (1 << D->PTask); ngrp++)
-    {
-      int recvTask = D->ThisTask ^ ngrp;
-
-      if(recvTask < D->NTask)
-        {
-          if(send_count[recvTask] > 0 || recv_count[recvTask] > 0)
-            {
-              myMPI_Sendrecv(&ResultsActiveImported[recv_offset[recvTask]], recv_count[recvTask] * sizeof(resultsactiveimported_data),
-                             MPI_BYTE, recvTask, TAG_FOF_A, &tmp_results[send_offset[recvTask]],
-                             send_count[recvTask] * sizeof(resultsactiveimported_data), MPI_BYTE, recvTask, TAG_FOF_A, D->Communicator,
-                             MPI_STATUS_IGNORE);
-            }
-        }
-    }
+  myMPI_Sparse_alltoallv(ResultsActiveImported, recv_count, recv_offset, tmp_results, send_count, send_offset,
+                         sizeof(resultsactiveimported_data), TAG_FOF_A, D->Communicator);
   for(int i = 0; i < Nexport; i++)
     {
       int target = tmp_results[i].index;
@@ -290,6 +290,10 @@ class gravtree : public tree<gravnode, partset, gravpoint_data, foreign_gravpoin
 
   char MeasureCostFlag;
 
+#ifdef GRAVITY_TREE_REUSE
+  char TreeIsKept = 0; /**< set if the tree of the last force calculation is still allocated and may be updated */
+#endif
+
   resultsactiveimported_data *ResultsActiveImported;
 
   ewald_data PotTaylor;
@@ -42,7 +42,8 @@
  *  short-range part.
  */
 
-inline void gwalk::evaluate_particle_particle_interaction(const pinfo &pdat, const int no, const char jtype, int shmrank)
+inline void gwalk::evaluate_particle_particle_interaction(gwalk_thread_data &wt, const pinfo &pdat, const int no, const char jtype,
+                                                          int shmrank)
 {
 #ifdef PRESERVE_SHMEM_BINARY_INVARIANCE
   if(skip_actual_force_computation)
@@ -125,6 +126,19 @@ inline void gwalk::evaluate_particle_particle_interaction(const pinfo &pdat, con
   vector<MyReal> dxyz;
   Tp->nearest_image_intpos_to_pos(intpos, pdat.intpos, dxyz.da);
 
+#ifdef EXPLICIT_VECTORIZATION
+  int mesh = 0;
+#ifdef PMGRID
+  if((DoPM & (TREE_ACTIVE_CUTTOFF_BASE_PM + TREE_ACTIVE_CUTTOFF_HIGHRES_PM)))
+    {
+      if(dxyz.r2() >= mfp->rcut2)
+        return;  // if we are outside the cut-off radius, we have no interaction
+    }
+  mesh = mfp - mf;
+#endif
+
+  add_to_interaction_list(wt, pdat, dxyz, mass, hmax, mesh);
+#else
   MyReal r2   = dxyz.r2();
   MyReal r    = sqrt(r2);
   MyReal rinv = (r > 0) ? 1 / r : 0;
@@ -145,6 +159,7 @@ inline void gwalk::evaluate_particle_particle_interaction(const pinfo &pdat, con
   *pdat.pot -= mass * gfac.fac0;
 #endif
   *pdat.acc -= (mass * gfac.fac1 * rinv) * dxyz;
+#endif
 
   if(DoEwald)
     {
@@ -162,10 +177,148 @@ inline void gwalk::evaluate_particle_particle_interaction(const pinfo &pdat, con
   if(MeasureCostFlag)
     *pdat.GravCost += 1;
 
-  interactioncountPP += 1;
+  wt.interactioncountPP += 1;
+}
+
+#ifdef EXPLICIT_VECTORIZATION
+/*! Evaluates the monopole interactions collected in the interaction list of the current target, four partners at a time
+ *  with AVX instructions, and adds the resulting acceleration (and potential) to the target. The calculation is the same as
+ *  that of get_gfactors_monopole() and modify_gfactors_pm_monopole(), only the order of the summation differs. The list is
+ *  empty afterwards.
+ */
+void gwalk::evaluate_interaction_list(gwalk_thread_data &wt, const pinfo &pdat)
+{
+  interaction_list &il = wt.ilist;
+
+  /* fill up the list to a multiple of the vector length with massless partners */
+  while(il.n & 3)
+    {
+      il.dx[il.n]   = 1;
+      il.dy[il.n]   = 0;
+      il.dz[il.n]   = 0;
+      il.mass[il.n] = 0;
+      il.hmax[il.n] = 1;
+#ifdef PMGRID
+      il.mesh[il.n] = 0;
+#endif
+      il.n++;
+    }
+
+  Vec4d accx(0), accy(0), accz(0);
+#ifdef EVALPOTENTIAL
+  Vec4d pot(0);
+#endif
+
+  for(int k = 0; k < il.n; k += 4)
+    {
+      Vec4d dx, dy, dz, mass, hmax;
+      dx.load(il.dx + k);
+      dy.load(il.dy + k);
+      dz.load(il.dz + k);
+      mass.load(il.mass + k);
+      hmax.load(il.hmax + k);
+
+      Vec4d r2 = dx * dx + dy * dy + dz * dz;
+      Vec4d r  = sqrt(r2);
+
+      Vec4db decision_r_gt_0 = (r > 0);
+      Vec4d rinv             = select(decision_r_gt_0, 1.0 / select(decision_r_gt_0, r, 1.0), 0);
+
+      Vec4d h_inv  = 1.0 / hmax;
+      Vec4d h2_inv = h_inv * h_inv;
+      Vec4d u      = r * h_inv;
+      Vec4d u2     = u * u;
+      Vec4d u3     = u2 * u;
+      Vec4d u_safe = select(decision_r_gt_0, u, 1.0); /* the outer softening polynomial is not used for u=0 */
+
+      Vec4db decision_unsoftened = (r > hmax);
+      Vec4db decision_inner      = (u < 0.5);
+
+      Vec4d fac1_inner = -h2_inv * u * (SOFTFAC1 + u2 * (SOFTFAC2 * u + SOFTFAC3));
+      Vec4d fac1_outer =
+          -h2_inv * u * (SOFTFAC8 + SOFTFAC9 * u + SOFTFAC10 * u2 + SOFTFAC11 * u3 + SOFTFAC12 / (u_safe * u_safe * u_safe));
+      Vec4d fac1 = select(decision_unsoftened, -rinv * rinv, select(decision_inner, fac1_inner, fac1_outer));
+
+#ifdef EVALPOTENTIAL
+      Vec4d fac0_inner = -h_inv * (SOFTFAC4 + u2 * (SOFTFAC5 + u2 * (SOFTFAC6 * u + SOFTFAC7)));
+      Vec4d fac0_outer =
+          -h_inv * (SOFTFAC13 + SOFTFAC14 / u_safe + u2 * (SOFTFAC1 + u * (SOFTFAC15 + u * (SOFTFAC16 + SOFTFAC17 * u))));
+      Vec4d fac0 = select(decision_unsoftened, rinv, select(decision_inner, fac0_inner, fac0_outer));
+#endif
+
+#ifdef PMGRID
+      if((DoPM & (TREE_ACTIVE_CUTTOFF_BASE_PM + TREE_ACTIVE_CUTTOFF_HIGHRES_PM)))
+        {
+          /* the short-range correction is interpolated from a table, which is done element by element */
+          double rr[4], pmfac1[4];
+#ifdef EVALPOTENTIAL
+          double pmfac0[4];
+#endif
+          r.store(rr);
+
+          for(int l = 0; l < 4; l++)
+            {
+              mesh_factors *mfp = &mf[il.mesh[k + l]];
+
+              double tabentry = mfp->asmthfac * rr[l];
+              int tabindex    = std::min<int>((int)tabentry, NTAB - 1); /* partners were selected with r < Rcut */
+
+              double w1 = tabentry - tabindex;
+              double w0 = 1 - w1;
+
+#ifdef EVALPOTENTIAL
+              pmfac0[l] = mfp->asmthinv1 * (w0 * shortrange_factors[tabindex].fac0 + w1 * shortrange_factors[tabindex + 1].fac0);
+#endif
+              pmfac1[l] = mfp->asmthinv2 * (w0 * shortrange_factors[tabindex].fac1 + w1 * shortrange_factors[tabindex + 1].fac1);
+            }
+
+          fac1 += Vec4d().load(pmfac1);
+#ifdef EVALPOTENTIAL
+          fac0 += Vec4d().load(pmfac0);
+#endif
+        }
+#endif
+
+      Vec4d g1 = mass * fac1 * rinv;
+
+      accx += g1 * dx;
+      accy += g1 * dy;
+      accz += g1 * dz;
+#ifdef EVALPOTENTIAL
+      pot += mass * fac0;
+#endif
+    }
+
+  (*pdat.acc)[0] -= horizontal_add(accx);
+  (*pdat.acc)[1] -= horizontal_add(accy);
+  (*pdat.acc)[2] -= horizontal_add(accz);
+#ifdef EVALPOTENTIAL
+  *pdat.pot -= horizontal_add(pot);
+#endif
+
+  il.n = 0;
 }
+#endif
 
-inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(const pinfo &pdat, gravnode *nop)
+inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(gwalk_thread_data &wt, const pinfo &pdat, gravnode *nop)
+{
+  vector<MyReal> dxyz;
+  MyReal r2, hmax;
+  mesh_factors *mfp;
+
+  int openflag = evaluate_particle_node_opening_criterion(pdat, nop, dxyz, r2, hmax, mfp);
+
+  if(openflag != NODE_USE)
+    return openflag;
+
+  return evaluate_particle_node_interaction(wt, pdat, nop, dxyz, r2, hmax, mfp);
+}
+
+/*! Applies the opening criterion of the target to a node. If the node can be used, the distance vector to its center of mass,
+ *  the square of the distance, the softening length and the mesh factors for the interaction are returned as well.
+ */
+inline int gwalk::evaluate_particle_node_opening_criterion(const pinfo &pdat, gravnode *nop, vector<MyReal> &dxyz, MyReal &r2,
+                                                           MyReal &hmax, mesh_factors *&mfp)
 {
   if(nop->level <= LEVEL_ALWAYS_OPEN)  // always open the root node (note: full node length does not fit in the integer type)
     return NODE_OPEN;
@@ -185,7 +338,7 @@ inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(const
 #endif
 
 #ifdef PMGRID
-  mesh_factors *mfp = &mf[LOW_MESH];
+  mfp = &mf[LOW_MESH];
 
   if((DoPM & (TREE_ACTIVE_CUTTOFF_BASE_PM + TREE_ACTIVE_CUTTOFF_HIGHRES_PM)))
     {
@@ -224,10 +377,9 @@ inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(const
 #endif
 
   /* converts the integer distance to floating point */
-  vector<MyReal> dxyz;
   Tp->nearest_image_intpos_to_pos(nop->s.da, pdat.intpos, dxyz.da);
 
-  MyReal r2 = dxyz.r2();
+  r2 = dxyz.r2();
 
   MyReal mass = nop->mass;
 
@@ -259,7 +411,7 @@ inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(const
         return NODE_OPEN;
     }
 
-  MyReal hmax = pdat.h_i;
+  hmax = pdat.h_i;
 
 #if NSOFTCLASSES > 1
   MyReal h_j = All.ForceSoftening[nop->maxsofttype];
@@ -275,15 +427,41 @@ inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(const
     }
 #endif
 
-    /**************************/
+#ifndef PMGRID
+  mfp = NULL; /* not used */
+#endif
 
-    // now evaluate the multipole moment interaction
+  return NODE_USE;
+}
+
+/*! Evaluates the multipole interaction of an accepted node with the target. The distance vector to the center of mass of the
+ *  node, its square, the softening length and the mesh factors to use have already been determined by the caller. Returns
+ *  NODE_DISCARD if the node turns out to lie outside of the short-range cut-off, and NODE_USE otherwise.
+ */
+inline int gwalk::evaluate_particle_node_interaction(gwalk_thread_data &wt, const pinfo &pdat, gravnode *nop, vector<MyReal> dxyz,
+                                                     MyReal r2, MyReal hmax, mesh_factors *mfp)
+{
+  MyReal mass = nop->mass;
 
 #ifdef PRESERVE_SHMEM_BINARY_INVARIANCE
   if(skip_actual_force_computation)
     return NODE_USE;
 #endif
 
+#if defined(EXPLICIT_VECTORIZATION) && !((MULTIPOLE_ORDER >= 3) || (MULTIPOLE_ORDER >= 2 && defined(EXTRAPOTTERM)))
+  /* the node acts as a point mass, hence it can be evaluated together with the particle interactions of the target */
+  int mesh = 0;
+#ifdef PMGRID
+  if((DoPM & (TREE_ACTIVE_CUTTOFF_BASE_PM + TREE_ACTIVE_CUTTOFF_HIGHRES_PM)))
+    {
+      if(r2 >= mfp->rcut2)
+        return NODE_DISCARD;  // if we are outside the cut-off radius, we have no interaction
+    }
+  mesh = mfp - mf;
+#endif
+
+  add_to_interaction_list(wt, pdat, dxyz, mass, hmax, mesh);
+#else
   MyReal r    = sqrt(r2);
   MyReal rinv = (r > 0) ? 1 / r : 0;
 
@@ -390,6 +568,7 @@ inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(const
   // now compute the triakontadipole  potential term
   *pdat.pot -= static_cast<MyReal>(1.0 / 120) * (g3 * 15 * Q5dxyzTtrace + g4 * 10 * Q5dxyz3.trace() + g5 * Q5dxyz5);
 #endif
+#endif /* EXPLICIT_VECTORIZATION */
 
   if(DoEwald)
     {
@@ -425,7 +604,7 @@ inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(const
 #endif
     }
 
-  interactioncountPN += 1;
+  wt.interactioncountPN += 1;
 
   if(MeasureCostFlag)
     *pdat.GravCost += 1;
@@ -433,7 +612,9 @@ inline int gwalk::evaluate_particle_node_opening_criterion_and_interaction(const
   return NODE_USE;
 }
 
-inline void gwalk::gwalk_open_node(const pinfo &pdat, int i, char ptype, gravnode *nop, int mintopleafnode, int committed)
+/*! Calls func(p, type, shmrank) for all daughter nodes and particles of the node nop, i.e. it opens the node. */
+template <typename Func>
+inline void gwalk::gwalk_traverse_daughters(gravnode *nop, Func func)
 {
   /* open node */
   int p                 = nop->nextnode;
@@ -496,19 +677,27 @@ inline void gwalk::gwalk_open_node(const pinfo &pdat, int i, char ptype, gravnod
               p, MaxPart, MaxNodes, ImportedNodeOffset, EndOfTreePoints, EndOfForeignNodes, shmrank);
         }
 
-      gravity_force_interact(pdat, i, p, ptype, type, shmrank, mintopleafnode, committed);
+      func(p, type, shmrank);
 
       p       = next;
       shmrank = next_shmrank;
     }
 }
 
-void gwalk::gravity_force_interact(const pinfo &pdat, int i, int no, char ptype, char no_type, unsigned char shmrank,
-                                   int mintopleafnode, int committed)
+inline void gwalk::gwalk_open_node(gwalk_thread_data &wt, const pinfo &pdat, int i, char ptype, gravnode *nop, int mintopleafnode,
+                                   int committed)
+{
+  gwalk_traverse_daughters(nop, [&](int p, char type, unsigned char shmrank) {
+    gravity_force_interact(wt, pdat, i, p, ptype, type, shmrank, mintopleafnode, committed);
+  });
+}
+
+void gwalk::gravity_force_interact(gwalk_thread_data &wt, const pinfo &pdat, int i, int no, char ptype, char no_type,
+                                   unsigned char shmrank, int mintopleafnode, int committed)
 {
   if(no_type <= NODE_TYPE_FETCHED_PARTICLE)  // we are interacting with a particle
     {
-      evaluate_particle_particle_interaction(pdat, no, no_type, shmrank);
+      evaluate_particle_particle_interaction(wt, pdat, no, no_type, shmrank);
     }
   else  // we are interacting with a node
     {
@@ -531,7 +720,7 @@ void gwalk::gravity_force_interact(const pinfo &pdat, int i, int no, char ptype,
 #endif
           }
 
-      int openflag = evaluate_particle_node_opening_criterion_and_interaction(pdat, nop);
+      int openflag = evaluate_particle_node_opening_criterion_and_interaction(wt, pdat, nop);
 
       if(openflag == NODE_OPEN) /* cell can't be used, need to open it */
         {
@@ -544,28 +733,439 @@ void gwalk::gravity_force_interact(const pinfo &pdat, int i, int no, char ptype,
                 }
               else
                 {
-                  tree_add_to_fetch_stack(nop, no, shmrank);  // will only add unique copies
+                  tree_add_to_fetch_stack(wt, nop, no, shmrank);  // will only add unique copies
 
-                  tree_add_to_work_stack(i, no, shmrank, mintopleafnode);
+                  tree_add_to_work_stack(wt, i, no, shmrank, mintopleafnode);
                 }
             }
           else
             {
-              int min_buffer_space =
-                  std::min<int>(MaxOnWorkStack - (NumOnWorkStack + NewOnWorkStack), MaxOnFetchStack - NumOnFetchStack);
+              int min_buffer_space = tree_get_free_stack_space(wt);
 
               if(min_buffer_space >= committed + 8 * TREE_NUM_BEFORE_NODESPLIT)
-                gwalk_open_node(pdat, i, ptype, nop, mintopleafnode, committed + 8 * TREE_NUM_BEFORE_NODESPLIT);
+                gwalk_open_node(wt, pdat, i, ptype, nop, mintopleafnode, committed + 8 * TREE_NUM_BEFORE_NODESPLIT);
               else
-                tree_add_to_work_stack(i, no, shmrank, mintopleafnode);
+                tree_add_to_work_stack(wt, i, no, shmrank, mintopleafnode);
+            }
+        }
+    }
+}
+
+#ifdef GRAVITY_GROUPWALK
+/*! Returns the tree node that defines the group to which the target of a work stack item may belong, or -1 if the item has to
+ *  be processed on its own. Only pristine local particles are grouped, and the group node is the parent of the leaf node that
+ *  holds the particle (or the leaf itself, if the parent is a top-level node).
+ */
+int gwalk::gravity_group_key(int item)
+{
+  int target = WorkStack[item].Target;
+
+  if(WorkStack[item].Node != MaxPart || target >= Tp->NumPart)
+    return -1;
+
+  int leaf = Father[target];
+
+  if(leaf < MaxPart + D->NTopnodes)
+    return -1;
+
+  int parent = get_nodep(leaf)->father;
+
+  if(parent < MaxPart + D->NTopnodes)
+    return leaf;
+
+  return parent;
+}
+
+/*! Splits the work stack into groups of consecutive items that can share one tree walk. Since the work stack is sorted by
+ *  target index, and the particles are stored in Peano-Hilbert order, particles of the same tree node mostly follow each other.
+ */
+void gwalk::gravity_form_groups(void)
+{
+  NumGroups = 0;
+
+  for(int i = 0; i < NumOnWorkStack;)
+    {
+      GroupStart[NumGroups++] = i;
+
+      int n   = 1;
+      int key = gravity_group_key(i);
+
+      if(key >= 0)
+        while(i + n < NumOnWorkStack && n < GRAVITY_GROUPWALK && gravity_group_key(i + n) == key)
+          n++;
+
+      i += n;
+    }
+
+  GroupStart[NumGroups] = NumOnWorkStack;
+}
+
+/*! Decides whether a node can be used for all members of a group, whether it can be discarded for all of them, or whether the
+ *  members have to decide individually. The distances in the opening criterion are measured from the bounding box of the group,
+ *  so that every member would have accepted (or discarded) the node in its own walk as well.
+ */
+int gwalk::evaluate_group_node_opening_criterion(const group_data &grp, gravnode *nop)
+{
+  if(nop->level <= LEVEL_ALWAYS_OPEN)  // always open the root node (note: full node length does not fit in the integer type)
+    return NODE_OPEN;
+
+  MyIntPosType halflen = ((MyIntPosType)1) << ((BITS_FOR_POSITIONS - 1) - nop->level);
+  MyIntPosType intlen  = halflen << 1;
+
+  MyReal len  = intlen * Tp->FacIntToCoord;
+  MyReal len2 = len * len;
+
+  /* distances of the geometric center and the center of mass of the node from the bounding box of the group */
+  vector<MyReal> dcenter, dcom;
+  Tp->nearest_image_intpos_to_pos(nop->center.da, grp.pdat[0].intpos, dcenter.da);
+  Tp->nearest_image_intpos_to_pos(nop->s.da, grp.pdat[0].intpos, dcom.da);
+
+  MyReal dist[3], r2 = 0;
+
+  for(int j = 0; j < 3; j++)
+    {
+      dist[j] = std::max<MyReal>(0, std::abs(dcenter[j] - grp.center[j]) - grp.halflen[j]);
+
+      MyReal d = std::max<MyReal>(0, std::abs(dcom[j] - grp.center[j]) - grp.halflen[j]);
+      r2 += d * d;
+    }
+
+#ifndef TREE_NO_SAFETY_BOX
+  // if one of the members may be close to the node, we open it to protect against worst-case force errors
+  if(dist[0] < len && dist[1] < len && dist[2] < len)
+    return NODE_OPEN;
+#endif
+
+#ifdef PMGRID
+  if((DoPM & (TREE_ACTIVE_CUTTOFF_BASE_PM + TREE_ACTIVE_CUTTOFF_HIGHRES_PM)))
+    {
+      /* check whether we can stop walking along this branch for all members */
+      MyReal rcut = sqrt(mf[LOW_MESH].rcut2) + halflen * Tp->FacIntToCoord;
+
+      if(dist[0] > rcut || dist[1] > rcut || dist[2] > rcut)
+        return NODE_DISCARD;
+    }
+#endif
+
+  MyReal mass = nop->mass;
+
+  if(All.RelOpeningCriterionInUse == 0) /* check Barnes-Hut opening criterion */
+    {
+      if(len2 > r2 * theta2)
+        return NODE_OPEN;
+    }
+  else /* check relative opening criterion */
+    {
+#if(MULTIPOLE_ORDER <= 2)
+      if(mass * len2 > r2 * r2 * errTolForceAcc * grp.aold_min)
+        return NODE_OPEN;
+#elif(MULTIPOLE_ORDER == 3)
+      if(square(mass * len * len2) > r2 * square(r2 * r2 * errTolForceAcc * grp.aold_min))
+        return NODE_OPEN;
+#elif(MULTIPOLE_ORDER == 4)
+      if(mass * len2 * len2 > r2 * r2 * r2 * errTolForceAcc * grp.aold_min)
+        return NODE_OPEN;
+#elif(MULTIPOLE_ORDER == 5)
+      if(square(mass * len2 * len2 * len) > r2 * square(r2 * r2 * r2 * errTolForceAcc * grp.aold_min))
+        return NODE_OPEN;
+#endif
+      // carry out an additional test to protect against pathological force errors for very large opening angles
+      if(len2 > r2 * thetamax2)
+        return NODE_OPEN;
+    }
+
+#if NSOFTCLASSES > 1
+  MyReal h_j = All.ForceSoftening[nop->maxsofttype];
+
+  if(h_j > grp.h_min && r2 < h_j * h_j)
+    {
+      if(All.ForceSoftening[nop->minsofttype] < All.ForceSoftening[nop->maxsofttype])
+        return NODE_OPEN;
+    }
+#endif
+
+  return NODE_USE;
+}
+
+void gwalk::gravity_group_add_to_list(gwalk_thread_data &wt, group_data &grp, int no, char no_type, unsigned char shmrank,
+                                      unsigned int mask)
+{
+  wt.GroupList[grp.nlist].no      = no;
+  wt.GroupList[grp.nlist].type    = no_type;
+  wt.GroupList[grp.nlist].shmrank = shmrank;
+  wt.GroupList[grp.nlist].mask    = mask;
+  grp.nlist++;
+
+  if(grp.nlist == GRAVITY_GROUPWALK_LIST_LENGTH)
+    gravity_group_evaluate_list(wt, grp);
+}
+
+/*! Evaluates the shared interaction list of a group for each of its members, and empties the list afterwards. */
+void gwalk::gravity_group_evaluate_list(gwalk_thread_data &wt, group_data &grp)
+{
+  for(int m = 0; m < grp.n; m++)
+    {
+      pinfo &pdat      = grp.pdat[m];
+      unsigned int bit = 1u << m;
+
+      for(int k = 0; k < grp.nlist; k++)
+        {
+          group_interaction &gi = wt.GroupList[k];
+
+          if(!(gi.mask & bit))
+            continue;
+
+          if(gi.type <= NODE_TYPE_FETCHED_PARTICLE)
+            evaluate_particle_particle_interaction(wt, pdat, gi.no, gi.type, gi.shmrank);
+          else
+            {
+              gravnode *nop = get_nodep(gi.no, gi.shmrank);
+
+              vector<MyReal> dxyz;
+              Tp->nearest_image_intpos_to_pos(nop->s.da, pdat.intpos, dxyz.da);
+
+              MyReal hmax = pdat.h_i;
+#if NSOFTCLASSES > 1
+              hmax = std::max<MyReal>(hmax, All.ForceSoftening[nop->maxsofttype]);
+#endif
+              evaluate_particle_node_interaction(wt, pdat, nop, dxyz, dxyz.r2(), hmax, &mf[LOW_MESH]);
             }
         }
+
+#ifdef EXPLICIT_VECTORIZATION
+      if(wt.ilist.n > 0)
+        evaluate_interaction_list(wt, pdat);
+#endif
+    }
+
+  grp.nlist = 0;
+}
+
+/*! The group analogue of gravity_force_interact(). The bit mask selects the members of the group that still walk along this
+ *  branch. Nodes that are accepted for the whole group are checked only once, otherwise each of these members applies its own
+ *  opening criterion, so that everybody ends up with the same interactions as in a walk of its own. Nodes that have to be opened
+ *  but are not available locally yet are put on the fetch stack, and the walk is continued separately for each member concerned
+ *  once they have arrived.
+ */
+void gwalk::gravity_group_interact(gwalk_thread_data &wt, group_data &grp, int no, char no_type, unsigned char shmrank,
+                                   int mintopleafnode, int committed, unsigned int mask)
+{
+  if(no_type <= NODE_TYPE_FETCHED_PARTICLE)  // we are interacting with a particle
+    {
+      gravity_group_add_to_list(wt, grp, no, no_type, shmrank, mask);
+      return;
+    }
+
+  gravnode *nop = get_nodep(no, shmrank);
+
+  if(nop->not_empty == 0)
+    return;
+
+  if(no < MaxPart + MaxNodes)                // we have a top-level node
+    if(nop->nextnode >= MaxPart + MaxNodes)  // if the next node is not a top-level, we have a leaf node
+      mintopleafnode = no;
+
+  int openflag = evaluate_group_node_opening_criterion(grp, nop);
+
+  if(openflag == NODE_DISCARD)
+    return;
+
+  if(openflag == NODE_USE)
+    {
+      gravity_group_add_to_list(wt, grp, no, no_type, shmrank, mask);
+      return;
+    }
+
+  unsigned int usemask = 0, openmask = 0;
+
+  for(int m = 0; m < grp.n; m++)
+    if(mask & (1u << m))
+      {
+        vector<MyReal> dxyz;
+        MyReal r2, hmax;
+        mesh_factors *mfp;
+
+        int flag = evaluate_particle_node_opening_criterion(grp.pdat[m], nop, dxyz, r2, hmax, mfp);
+
+        if(flag == NODE_USE)
+          usemask |= 1u << m;
+        else if(flag == NODE_OPEN)
+          openmask |= 1u << m;
+      }
+
+  if(usemask)
+    gravity_group_add_to_list(wt, grp, no, no_type, shmrank, usemask);
+
+  if(openmask == 0)
+    return;
+
+  int nopen = 0;
+  for(int m = 0; m < grp.n; m++)
+    if(openmask & (1u << m))
+      nopen++;
+
+  if(nop->cannot_be_opened_locally.load(std::memory_order_acquire))
+    {
+      // are we in the same shared memory node?
+      if(Shmem.GetNodeIDForSimulCommRank[nop->OriginTask] == Shmem.GetNodeIDForSimulCommRank[D->ThisTask])
+        Terminate("this should not happen any more");
+
+      tree_add_to_fetch_stack(wt, nop, no, shmrank);  // will only add unique copies
+
+      for(int m = 0; m < grp.n; m++)
+        if(openmask & (1u << m))
+          tree_add_to_work_stack(wt, grp.target[m], no, shmrank, mintopleafnode);
+    }
+  else
+    {
+      int need = 8 * TREE_NUM_BEFORE_NODESPLIT * nopen;
+
+      if(tree_get_free_stack_space(wt) >= committed + need)
+        gwalk_traverse_daughters(nop, [&](int p, char type, unsigned char shmrank) {
+          gravity_group_interact(wt, grp, p, type, shmrank, mintopleafnode, committed + need, openmask);
+        });
+      else
+        for(int m = 0; m < grp.n; m++)
+          if(openmask & (1u << m))
+            tree_add_to_work_stack(wt, grp.target[m], no, shmrank, mintopleafnode);
     }
 }
 
-/*
+/*! Carries out one tree walk for the n pristine targets of the work stack items first...first+n-1, and evaluates the resulting
+ *  interaction list for each of them.
+ */
+void gwalk::gravity_group_walk(gwalk_thread_data &wt, int first, int n)
+{
+  group_data grp;
 
-*/
+  grp.n     = n;
+  grp.nlist = 0;
+
+  MyReal pmin[3] = {0, 0, 0}, pmax[3] = {0, 0, 0};
+
+  for(int m = 0; m < n; m++)
+    {
+      grp.target[m]               = WorkStack[first + m].Target;
+      WorkStack[first + m].Target = -1;
+
+      get_pinfo(grp.target[m], grp.pdat[m]);
+
+#if THREADS_PER_MPI_RANK > 1
+      start_partial_sums(grp.pdat[m]);
+#endif
+
+      MyReal off[3];
+      Tp->nearest_image_intpos_to_pos(grp.pdat[m].intpos, grp.pdat[0].intpos, off);
+
+      for(int j = 0; j < 3; j++)
+        {
+          pmin[j] = std::min<MyReal>(pmin[j], off[j]);
+          pmax[j] = std::max<MyReal>(pmax[j], off[j]);
+        }
+
+      if(m == 0 || grp.pdat[m].aold < grp.aold_min)
+        grp.aold_min = grp.pdat[m].aold;
+      if(m == 0 || grp.pdat[m].h_i < grp.h_min)
+        grp.h_min = grp.pdat[m].h_i;
+    }
+
+  for(int j = 0; j < 3; j++)
+    {
+      grp.center[j]  = 0.5 * (pmin[j] + pmax[j]);
+      grp.halflen[j] = 0.5 * (pmax[j] - pmin[j]);
+    }
+
+  gravity_group_interact(wt, grp, MaxPart, NODE_TYPE_LOCAL_NODE, WorkStack[first].ShmRank, WorkStack[first].MinTopLeafNode,
+                         8 * TREE_NUM_BEFORE_NODESPLIT * n, (1u << n) - 1);
+
+  if(grp.nlist > 0)
+    gravity_group_evaluate_list(wt, grp);
+
+#if THREADS_PER_MPI_RANK > 1
+  for(int m = 0; m < n; m++)
+    add_partial_sums(grp.target[m], grp.pdat[m]);
+#endif
+
+  wt.groupcount += 1;
+  wt.grouptargets += n;
+}
+#endif
+
+/*! This function is executed by each of the threads that carry out a cycle of the tree walk. Work stack items are
+ *  requested from the scheduler as long as there is enough space left in the thread's slices of the work and fetch stacks.
+ *  Items that have been processed are marked by setting their target to -1. With GRAVITY_GROUPWALK, the scheduler hands out
+ *  groups of items instead, and groups of more than one target share a single walk if there is enough stack space for it.
+ */
+void gwalk::gravity_walk_thread(gwalk_thread_data &wt, int thread, workstealing_scheduler &sched)
+{
+  int committed = 8 * TREE_NUM_BEFORE_NODESPLIT;
+
+#ifdef GRAVITY_GROUPWALK
+  int group;
+
+  while(tree_get_free_stack_space(wt) >= committed && sched.get_next(thread, group))
+    {
+      int first = GroupStart[group];
+      int n     = GroupStart[group + 1] - first;
+
+      if(n > 1 && tree_get_free_stack_space(wt) >= committed * n)
+        gravity_group_walk(wt, first, n);
+      else
+        for(int m = 0; m < n && tree_get_free_stack_space(wt) >= committed; m++)
+          gravity_walk_item(wt, first + m, committed);
+    }
+#else
+  int item;
+
+  while(tree_get_free_stack_space(wt) >= committed && sched.get_next(thread, item))
+    gravity_walk_item(wt, item, committed);
+#endif
+}
+
+/*! Processes a single work stack item, i.e. continues the walk for its target at the node given by the item. */
+void gwalk::gravity_walk_item(gwalk_thread_data &wt, int item, int committed)
+{
+  int target     = WorkStack[item].Target;
+  int no         = WorkStack[item].Node;
+  int shmrank    = WorkStack[item].ShmRank;
+  int mintopleaf = WorkStack[item].MinTopLeafNode;
+
+  WorkStack[item].Target = -1;
+
+  pinfo pdat;
+  int ptype = get_pinfo(target, pdat);
+
+#if THREADS_PER_MPI_RANK > 1
+  start_partial_sums(pdat);
+#endif
+
+  if(no == MaxPart)
+    {
+      // we have a pristine particle that's processed for the first time
+      gravity_force_interact(wt, pdat, target, no, ptype, NODE_TYPE_LOCAL_NODE, shmrank, mintopleaf, committed);
+    }
+  else
+    {
+      // we have a node that we previously could not open
+      gravnode *nop = get_nodep(no, shmrank);
+
+      if(nop->cannot_be_opened_locally)
+        {
+          Terminate("item=%d:  no=%d  now we should be able to open it!", item, no);
+        }
+      else
+        gwalk_open_node(wt, pdat, target, ptype, nop, mintopleaf, committed);
+    }
+
+#ifdef EXPLICIT_VECTORIZATION
+  if(wt.ilist.n > 0)
+    evaluate_interaction_list(wt, pdat);
+#endif
+
+#if THREADS_PER_MPI_RANK > 1
+  add_partial_sums(target, pdat);
+#endif
+}
 
 /*! \brief This function computes the gravitational forces for all active particles.
  *
@@ -601,11 +1201,16 @@ void gwalk::gravity_tree(int timebin)
 {
   interactioncountPP = 0;
   interactioncountPN = 0;
+#ifdef GRAVITY_GROUPWALK
+  groupcount   = 0;
+  grouptargets = 0;
+#endif
 
   TIMER_STORE;
   TIMER_START(CPU_TREE);
 
-  D->mpi_printf("GRAVTREE: Begin tree force. timebin=%d (presently allocated=%g MB)\n", timebin, Mem.getAllocatedBytesInMB());
+  D->mpi_printf("GRAVTREE: Begin tree force. timebin=%d (presently allocated=%g MB, threads=%d)\n", timebin,
+                Mem.getAllocatedBytesInMB(), THREADS_PER_MPI_RANK);
 
 #ifdef PMGRID
   set_mesh_factors();
@@ -695,6 +1300,11 @@ void gwalk::gravity_tree(int timebin)
         }
     }
 
+#ifdef GRAVITY_GROUPWALK
+  /* bring the pristine particles into index order, so that particles that are close in the tree follow each other */
+  mycxxsort(WorkStack, WorkStack + NumOnWorkStack, compare_workstack);
+#endif
+
 #ifdef PRESERVE_SHMEM_BINARY_INVARIANCE
   workstack_data *WorkStackBak = (workstack_data *)Mem.mymalloc("WorkStackBak", NumOnWorkStack * sizeof(workstack_data));
   int NumOnWorkStackBak        = NumOnWorkStack;
@@ -736,6 +1346,28 @@ void gwalk::gravity_tree(int timebin)
 
   TIMER_STOP(CPU_TREESTACK);
 
+  int nthreads = THREADS_PER_MPI_RANK;
+  gwalk_thread_data wt[THREADS_PER_MPI_RANK];
+  workstealing_scheduler sched;
+
+  for(int t = 0; t < nthreads; t++)
+    {
+      wt[t].interactioncountPP = 0;
+      wt[t].interactioncountPN = 0;
+#ifdef EXPLICIT_VECTORIZATION
+      wt[t].ilist.n = 0;
+#endif
+#ifdef GRAVITY_GROUPWALK
+      wt[t].groupcount   = 0;
+      wt[t].grouptargets = 0;
+#endif
+    }
+
+#if THREADS_PER_MPI_RANK > 1
+  for(int i = 0; i < NumResultLocks; i++)
+    ResultLocks[i].clear();
+#endif
+
   double t0       = Logs.second();
   int max_ncycles = 0;
 
@@ -758,53 +1390,37 @@ void gwalk::gravity_tree(int timebin)
 
       while(NumOnWorkStack > 0)  // repeat until we are out of work
         {
-          NewOnWorkStack  = 0;  // gives the new entries
-          NumOnFetchStack = 0;
-          MaxOnWorkStack  = std::min<int>(AllocWorkStackBaseLow + max_ncycles * TREE_MIN_WORKSTACK_SIZE, AllocWorkStackBaseHigh);
+          MaxOnWorkStack = std::min<int>(AllocWorkStackBaseLow + max_ncycles * TREE_MIN_WORKSTACK_SIZE, AllocWorkStackBaseHigh);
 
           TIMER_START(CPU_TREEWALK);
 
-          int item = 0;
+          tree_walkthreads_setup(wt, nthreads);
 
-          while(item < NumOnWorkStack)
-            {
-              int committed = 8 * TREE_NUM_BEFORE_NODESPLIT;
-              int min_buffer_space =
-                  std::min<int>(MaxOnWorkStack - (NumOnWorkStack + NewOnWorkStack), MaxOnFetchStack - NumOnFetchStack);
-              if(min_buffer_space >= committed)
-                {
-                  int target     = WorkStack[item].Target;
-                  int no         = WorkStack[item].Node;
-                  int shmrank    = WorkStack[item].ShmRank;
-                  int mintopleaf = WorkStack[item].MinTopLeafNode;
-                  item++;
-
-                  pinfo pdat;
-                  int ptype = get_pinfo(target, pdat);
-
-                  if(no == MaxPart)
-                    {
-                      // we have a pristine particle that's processed for the first time
-                      gravity_force_interact(pdat, target, no, ptype, NODE_TYPE_LOCAL_NODE, shmrank, mintopleaf, committed);
-                    }
-                  else
-                    {
-                      // we have a node that we previously could not open
-                      gravnode *nop = get_nodep(no, shmrank);
-
-                      if(nop->cannot_be_opened_locally)
-                        {
-                          Terminate("item=%d:  no=%d  now we should be able to open it!", item, no);
-                        }
-                      else
-                        gwalk_open_node(pdat, target, ptype, nop, mintopleaf, committed);
-                    }
-                }
-              else
-                break;
-            }
+#ifdef GRAVITY_GROUPWALK
+          GroupStart = (int *)Mem.mymalloc("GroupStart", (NumOnWorkStack + 1) * sizeof(int));
+          group_interaction *GroupList =
+              (group_interaction *)Mem.mymalloc("GroupList", nthreads * GRAVITY_GROUPWALK_LIST_LENGTH * sizeof(group_interaction));
+
+          for(int t = 0; t < nthreads; t++)
+            wt[t].GroupList = GroupList + t * GRAVITY_GROUPWALK_LIST_LENGTH;
 
-          if(item == 0 && NumOnWorkStack > 0)
+          gravity_form_groups();
+
+          sched.init(NumGroups, nthreads);
+#else
+          sched.init(NumOnWorkStack, nthreads);
+#endif
+
+          run_worker_threads(nthreads, [this, &wt, &sched](int thread) { gravity_walk_thread(wt[thread], thread, sched); });
+
+#ifdef GRAVITY_GROUPWALK
+          Mem.myfree(GroupList);
+          Mem.myfree(GroupStart);
+#endif
+
+          int nprocessed = tree_walkthreads_collect(wt, nthreads);
+
+          if(nprocessed == 0 && NumOnWorkStack > 0)
             Terminate("Can't even process a single particle");
 
           TIMER_STOP(CPU_TREEWALK);
@@ -817,10 +1433,8 @@ void gwalk::gravity_tree(int timebin)
 
           TIMER_START(CPU_TREESTACK);
 
-          /* now reorder the workstack such that we are first going to do residual pristine particles, and then
-           * imported nodes that hang below the first leaf nodes */
-          NumOnWorkStack = NumOnWorkStack - item + NewOnWorkStack;
-          memmove(WorkStack, WorkStack + item, NumOnWorkStack * sizeof(workstack_data));
+          /* the work stack now holds the residual pristine particles, followed by the imported nodes that hang below the
+           * first leaf nodes */
 
           /* now let's sort such that we can go deep on top-level node branches, allowing us to clear them out eventually */
           mycxxsort(WorkStack, WorkStack + NumOnWorkStack, compare_workstack);
@@ -834,6 +1448,16 @@ void gwalk::gravity_tree(int timebin)
     }
 #endif
 
+  for(int t = 0; t < nthreads; t++)
+    {
+      interactioncountPP += wt[t].interactioncountPP;
+      interactioncountPN += wt[t].interactioncountPN;
+#ifdef GRAVITY_GROUPWALK
+      groupcount += wt[t].groupcount;
+      grouptargets += wt[t].grouptargets;
+#endif
+    }
+
   TIMER_START(CPU_TREEIMBALANCE);
 
   MPI_Allreduce(MPI_IN_PLACE, &max_ncycles, 1, MPI_INT, MPI_MAX, D->Communicator);
@@ -877,6 +1501,9 @@ void gwalk::gravity_tree(int timebin)
     double interactioncountPP, interactioncountPN;
     double NumForeignNodes, NumForeignPoints;
     double fillfacFgnNodes, fillfacFgnPoints;
+#ifdef GRAVITY_GROUPWALK
+    double groupcount, grouptargets;
+#endif
   };
   detailed_timings timer, tisum, timax;
 
@@ -894,6 +1521,10 @@ void gwalk::gravity_tree(int timebin)
   timer.NumForeignPoints   = NumForeignPoints;
   timer.fillfacFgnNodes    = NumForeignNodes / ((double)MaxForeignNodes);
   timer.fillfacFgnPoints   = NumForeignPoints / ((double)MaxForeignPoints);
+#ifdef GRAVITY_GROUPWALK
+  timer.groupcount   = groupcount;
+  timer.grouptargets = grouptargets;
+#endif
 
   MPI_Reduce((double *)&timer, (double *)&tisum, (int)(sizeof(detailed_timings) / sizeof(double)), MPI_DOUBLE, MPI_SUM, 0,
              D->Communicator);
@@ -924,6 +1555,10 @@ void gwalk::gravity_tree(int timebin)
               tisum.lastpm / D->NTask);
       fprintf(Logs.FdTimings, "   total interaction cost: %g  (imbalance=%g)\n", tisum.costtotal,
               timax.costtotal / (tisum.costtotal / D->NTask));
+#ifdef GRAVITY_GROUPWALK
+      fprintf(Logs.FdTimings, "   group walk: %g of %lld targets in %g groups (avg size=%g)\n", tisum.grouptargets,
+              Tp->TimeBinsGravity.GlobalNActiveParticles, tisum.groupcount, tisum.grouptargets / (tisum.groupcount + 1.0e-20));
+#endif
       myflush(Logs.FdTimings);
     }
 
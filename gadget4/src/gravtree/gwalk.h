@@ -14,7 +14,18 @@
 
 #include "gadgetconfig.h"
 
+#include <atomic>
+
 #include "../mpi_utils/shared_mem_handler.h"
+#include "../system/worker_threads.h"
+
+#ifdef EXPLICIT_VECTORIZATION
+#define GRAVITY_INTERACTION_LIST_LENGTH 64 /* must be a multiple of the vector length of 4 */
+#endif
+
+#ifdef GRAVITY_GROUPWALK
+#define GRAVITY_GROUPWALK_LIST_LENGTH 4096 /* length of the shared interaction list of a group, it is evaluated whenever it is full */
+#endif
 
 class gwalk : public gravtree<simparticles>
 {
@@ -24,6 +35,60 @@ class gwalk : public gravtree<simparticles>
  private:
   long long interactioncountPP;
   long long interactioncountPN;
+#ifdef GRAVITY_GROUPWALK
+  long long groupcount;   /* number of walks that were shared by several targets */
+  long long grouptargets; /* number of targets that were processed in such shared walks */
+#endif
+
+#ifdef EXPLICIT_VECTORIZATION
+  /* monopole-type interactions of the current target that have been accepted in the walk, but not yet evaluated. They are
+   * stored as separate arrays so that the force evaluation can process four partners at a time with AVX instructions.
+   */
+  struct interaction_list
+  {
+    int n;
+    double dx[GRAVITY_INTERACTION_LIST_LENGTH];
+    double dy[GRAVITY_INTERACTION_LIST_LENGTH];
+    double dz[GRAVITY_INTERACTION_LIST_LENGTH];
+    double mass[GRAVITY_INTERACTION_LIST_LENGTH];
+    double hmax[GRAVITY_INTERACTION_LIST_LENGTH];
+#ifdef PMGRID
+    int mesh[GRAVITY_INTERACTION_LIST_LENGTH];
+#endif
+  };
+#endif
+
+#ifdef GRAVITY_GROUPWALK
+  /* a node or particle that has been accepted by the members of a group that are flagged in the bit mask */
+  struct group_interaction
+  {
+    int no;
+    char type;
+    unsigned char shmrank;
+    unsigned int mask;
+  };
+#endif
+
+  /* private stack slices and interaction counters of each thread that takes part in the tree walk */
+  struct gwalk_thread_data : walkthread_data
+  {
+    long long interactioncountPP;
+    long long interactioncountPN;
+#ifdef EXPLICIT_VECTORIZATION
+    interaction_list ilist;
+#endif
+#ifdef GRAVITY_GROUPWALK
+    group_interaction *GroupList;
+    long long groupcount;
+    long long grouptargets;
+#endif
+  };
+
+#if THREADS_PER_MPI_RANK > 1
+  /* spin locks protecting the force results of the targets, the lock for a target is picked by its index modulo this number */
+  static const int NumResultLocks = 1024;
+  std::atomic_flag ResultLocks[NumResultLocks];
+#endif
 
   MyReal theta2;
   MyReal thetamax2;
@@ -49,8 +114,41 @@ class gwalk : public gravtree<simparticles>
     vector<MyFloat> *acc;
     MyFloat *pot;
     int *GravCost;
+
+#if THREADS_PER_MPI_RANK > 1
+    /* with several threads, the same target can be worked on by different threads at the same time, hence the
+     * contributions of one work stack item are first summed up here, and then added to the target under a lock
+     */
+    vector<MyFloat> acc_sum;
+    MyFloat pot_sum;
+    int GravCost_sum;
+
+    vector<MyFloat> *acc_target;
+    MyFloat *pot_target;
+    int *GravCost_target;
+#endif
+  };
+
+#ifdef GRAVITY_GROUPWALK
+  /* active particles that share one walk, together with their bounding box, which is stored relative to the first member */
+  struct group_data
+  {
+    int n;
+    int target[GRAVITY_GROUPWALK];
+    pinfo pdat[GRAVITY_GROUPWALK];
+
+    MyReal center[3];
+    MyReal halflen[3];
+    MyReal aold_min;
+    MyReal h_min;
+
+    int nlist;
   };
 
+  int NumGroups;
+  int *GroupStart; /* the work stack items of group g are GroupStart[g] ... GroupStart[g+1]-1 */
+#endif
+
   inline int get_pinfo(int i, pinfo &pdat)
   {
     int ptype;
@@ -110,12 +208,97 @@ class gwalk : public gravtree<simparticles>
     return ptype;
   }
 
-  inline void gwalk_open_node(const pinfo &pdat, int i, char ptype, gravnode *nop, int mintopleafnode, int committed);
-  void gravity_force_interact(const pinfo &pdat, int i, int no, char ptype, char no_type, unsigned char shmrank, int mintopleafnode,
+#if THREADS_PER_MPI_RANK > 1
+  /* redirects the accumulation of results to the partial sums in pdat */
+  inline void start_partial_sums(pinfo &pdat)
+  {
+    pdat.acc_target      = pdat.acc;
+    pdat.GravCost_target = pdat.GravCost;
+#ifdef EVALPOTENTIAL
+    pdat.pot_target = pdat.pot;
+#endif
+
+    for(int j = 0; j < 3; j++)
+      pdat.acc_sum[j] = 0;
+    pdat.pot_sum      = 0;
+    pdat.GravCost_sum = 0;
+
+    pdat.acc      = &pdat.acc_sum;
+    pdat.pot      = &pdat.pot_sum;
+    pdat.GravCost = &pdat.GravCost_sum;
+  }
+
+  /* adds the partial sums accumulated for one work stack item to the actual target */
+  inline void add_partial_sums(int i, pinfo &pdat)
+  {
+    std::atomic_flag &lock = ResultLocks[i % NumResultLocks];
+
+    while(lock.test_and_set(std::memory_order_acquire))
+      ;
+
+    *pdat.acc_target += pdat.acc_sum;
+#ifdef EVALPOTENTIAL
+    *pdat.pot_target += pdat.pot_sum;
+#endif
+    *pdat.GravCost_target += pdat.GravCost_sum;
+
+    lock.clear(std::memory_order_release);
+  }
+#endif
+
+  void gravity_walk_thread(gwalk_thread_data &wt, int thread, workstealing_scheduler &sched);
+  void gravity_walk_item(gwalk_thread_data &wt, int item, int committed);
+
+  template <typename Func>
+  inline void gwalk_traverse_daughters(gravnode *nop, Func func);
+
+  inline void gwalk_open_node(gwalk_thread_data &wt, const pinfo &pdat, int i, char ptype, gravnode *nop, int mintopleafnode,
                               int committed);
+  void gravity_force_interact(gwalk_thread_data &wt, const pinfo &pdat, int i, int no, char ptype, char no_type,
+                              unsigned char shmrank, int mintopleafnode, int committed);
+
+#ifdef EXPLICIT_VECTORIZATION
+  inline void add_to_interaction_list(gwalk_thread_data &wt, const pinfo &pdat, const vector<MyReal> &dxyz, MyReal mass, MyReal hmax,
+                                      int mesh)
+  {
+    interaction_list &il = wt.ilist;
 
-  inline int evaluate_particle_node_opening_criterion_and_interaction(const pinfo &pdat, gravnode *nop);
-  inline void evaluate_particle_particle_interaction(const pinfo &pdat, const int no, const char jtype, int no_task);
+    il.dx[il.n]   = dxyz.da[0];
+    il.dy[il.n]   = dxyz.da[1];
+    il.dz[il.n]   = dxyz.da[2];
+    il.mass[il.n] = mass;
+    il.hmax[il.n] = hmax;
+#ifdef PMGRID
+    il.mesh[il.n] = mesh;
+#endif
+    il.n++;
+
+    if(il.n == GRAVITY_INTERACTION_LIST_LENGTH)
+      evaluate_interaction_list(wt, pdat);
+  }
+
+  void evaluate_interaction_list(gwalk_thread_data &wt, const pinfo &pdat);
+#endif
+
+  inline int evaluate_particle_node_opening_criterion_and_interaction(gwalk_thread_data &wt, const pinfo &pdat, gravnode *nop);
+  inline int evaluate_particle_node_opening_criterion(const pinfo &pdat, gravnode *nop, vector<MyReal> &dxyz, MyReal &r2, MyReal &hmax,
+                                                      mesh_factors *&mfp);
+  inline int evaluate_particle_node_interaction(gwalk_thread_data &wt, const pinfo &pdat, gravnode *nop, vector<MyReal> dxyz,
+                                                MyReal r2, MyReal hmax, mesh_factors *mfp);
+
+#ifdef GRAVITY_GROUPWALK
+  int gravity_group_key(int item);
+  void gravity_form_groups(void);
+  void gravity_group_walk(gwalk_thread_data &wt, int first, int n);
+  void gravity_group_interact(gwalk_thread_data &wt, group_data &grp, int no, char no_type, unsigned char shmrank, int mintopleafnode,
+                              int committed, unsigned int mask);
+  void gravity_group_add_to_list(gwalk_thread_data &wt, group_data &grp, int no, char no_type, unsigned char shmrank,
+                                 unsigned int mask);
+  void gravity_group_evaluate_list(gwalk_thread_data &wt, group_data &grp);
+  int evaluate_group_node_opening_criterion(const group_data &grp, gravnode *nop);
+#endif
+  inline void evaluate_particle_particle_interaction(gwalk_thread_data &wt, const pinfo &pdat, const int no, const char jtype,
+                                                     int no_task);
 };
 
 #endif
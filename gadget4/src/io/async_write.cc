@@ -0,0 +1,143 @@
+/*******************************************************************************
+ * \copyright   This file is part of the GADGET4 N-body/SPH code developed
+ * \copyright   by Volker Springel. Copyright (C) 2014-2020 by Volker Springel
+ * \copyright   (vspringel@mpa-garching.mpg.de) and all contributing authors.
+ *******************************************************************************/
+
+/*! \file  async_write.cc
+ *
+ *  \brief writes staged HDF5 datasets to disk in a background thread
+ */
+
+#include "gadgetconfig.h"
+
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+
+#include <hdf5.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "../data/allvars.h"
+#include "../data/dtypes.h"
+#include "../io/async_write.h"
+#include "../io/hdf5_util.h"
+#include "../logs/logs.h"
+#include "../system/system.h"
+
+/*! \brief Registers an HDF5 file that has been created by the main thread, and that is to be completed in the background
+ *
+ *  \param file the handle of the open file
+ *  \param fname name of the file, used in messages
+ *  \param report if true, the completion of the write is reported on stdout
+ */
+void async_write::begin_file(hid_t file, const char *fname, bool report)
+{
+  if(Thread)
+    Terminate("a background write is still in progress");
+
+  File   = file;
+  Report = report;
+  snprintf(FileName, MAXLEN_PATH_EXTRA, "%s", fname);
+
+  NJobs      = 0;
+  TotalBytes = 0;
+}
+
+/*! \brief Adds an open dataset to the file registered with begin_file()
+ *
+ *  \param dataset the handle of the dataset, which must have been created with its full size
+ *  \param memtype the HDF5 type of the data in memory
+ *  \param nbytes the size of the data in memory
+ *  \param name name of the dataset, used in error messages
+ *  \return a buffer of nbytes bytes which the caller needs to fill before start() is called
+ */
+char *async_write::add_dataset(hid_t dataset, hid_t memtype, size_t nbytes, const char *name)
+{
+  if(NJobs >= MaxJobs)
+    {
+      MaxJobs = std::max<int>(2 * MaxJobs, 64);
+      if(!(Jobs = (dataset_job *)realloc(Jobs, MaxJobs * sizeof(dataset_job))))
+        Terminate("can't allocate the list of staged datasets");
+    }
+
+  dataset_job *job = &Jobs[NJobs++];
+
+  job->dataset = dataset;
+  job->memtype = memtype;
+  job->nbytes  = nbytes;
+  snprintf(job->name, MAXLEN_PATH, "%s", name);
+
+  if(!(job->data = (char *)malloc(std::max<size_t>(nbytes, 1))))
+    Terminate("can't allocate %g MB to stage dataset '%s' for the background write", nbytes / (1024.0 * 1024.0), name);
+
+  TotalBytes += nbytes;
+
+  return job->data;
+}
+
+/*! \brief Launches the background thread that writes all staged datasets and closes the file */
+void async_write::start(void)
+{
+  StartTime = Logs.second();
+
+  Thread = new std::thread(&async_write::run, this);
+}
+
+/*! \brief Blocks until a background write that may still be in progress has finished
+ *
+ *  This is a purely local operation that does not involve any communication. It returns immediately if there is nothing
+ *  to wait for.
+ */
+void async_write::wait(void)
+{
+  if(!Thread)
+    return;
+
+  double t0 = Logs.second();
+  Thread->join();
+  double t1 = Logs.second();
+
+  delete Thread;
+  Thread = NULL;
+
+  if(Report)
+    {
+      printf("ASYNC-WRITE: background write of '%s' (%g MB staged) took %g sec (%g MB/sec), finished %g sec after start, waited %g sec\n",
+             FileName, TotalBytes / (1024.0 * 1024.0), WriteDuration, TotalBytes / (1024.0 * 1024.0) / (WriteDuration + 1.0e-20),
+             Logs.timediff(StartTime, t1), Logs.timediff(t0, t1));
+      myflush(stdout);
+    }
+}
+
+/*! \brief Body of the background thread
+ *
+ *  Note that no MPI functions may be called here, and no memory may be allocated through the Mem object.
+ */
+void async_write::run(void)
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  for(int i = 0; i < NJobs; i++)
+    {
+      dataset_job *job = &Jobs[i];
+
+      if(job->nbytes > 0)
+        my_H5Dwrite(job->dataset, job->memtype, H5S_ALL, H5S_ALL, H5P_DEFAULT, job->data, job->name);
+
+      my_H5Dclose(job->dataset, job->name);
+
+      free(job->data);
+    }
+
+  my_H5Fclose(File, FileName);
+
+  NJobs = 0;
+
+  WriteDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+#endif
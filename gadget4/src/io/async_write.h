@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * \copyright   This file is part of the GADGET4 N-body/SPH code developed
+ * \copyright   by Volker Springel. Copyright (C) 2014-2020 by Volker Springel
+ * \copyright   (vspringel@mpa-garching.mpg.de) and all contributing authors.
+ *******************************************************************************/
+
+/*! \file  async_write.h
+ *
+ *  \brief declares a class that writes staged HDF5 datasets to disk in a background thread
+ */
+
+#ifndef ASYNC_WRITE_H
+#define ASYNC_WRITE_H
+
+#include "gadgetconfig.h"
+
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+
+#include <hdf5.h>
+#include <stdio.h>
+#include <thread>
+
+#include "../data/constants.h"
+
+/*! This class takes over an HDF5 file in which all groups, attributes and datasets have already been created by the main
+ *  thread, together with the data of each dataset, which has been copied into buffers of its own. A background thread then
+ *  writes the datasets, closes the file and releases the buffers, while the main thread continues with the simulation.
+ *
+ *  The HDF5 library is not assumed to be thread-safe. Hence the main thread must not call any HDF5 function while a write is
+ *  in progress, and every piece of code that accesses HDF5 files, or relies on the previous snapshot being complete, first
+ *  calls wait(). The buffers are allocated with malloc() rather than through the Mem object, because they live across
+ *  an arbitrary number of subsequent allocations and releases of the main thread.
+ */
+class async_write
+{
+ public:
+  void begin_file(hid_t file, const char *fname, bool report);
+  char *add_dataset(hid_t dataset, hid_t memtype, size_t nbytes, const char *name);
+  void start(void);
+  void wait(void);
+
+ private:
+  struct dataset_job
+  {
+    hid_t dataset;
+    hid_t memtype;
+    char *data;
+    size_t nbytes;
+    char name[MAXLEN_PATH];
+  };
+
+  std::thread *Thread = NULL; /* allocated on the heap, such that no destructor is run for it if we exit via Terminate() */
+
+  hid_t File;
+  char FileName[MAXLEN_PATH_EXTRA];
+  bool Report;
+
+  dataset_job *Jobs = NULL;
+  int NJobs         = 0;
+  int MaxJobs       = 0;
+
+  size_t TotalBytes;
+  double StartTime, WriteDuration;
+
+  void run(void);
+};
+
+extern async_write AsyncWrite;
+
+#endif
+
+#endif
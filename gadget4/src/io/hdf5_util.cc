@@ -11,6 +11,7 @@
 
 #include "gadgetconfig.h"
 
+#include <ctype.h>
 #include <hdf5.h>
 #include <math.h>
 #include <mpi.h>
@@ -667,3 +668,245 @@ void write_string_attribute(hid_t handle, const char *attr_name, const char *buf
   my_H5Aclose(hdf5_attribute, attr_name);
   my_H5Sclose(hdf5_dataspace, H5S_SCALAR);
 }
+
+#ifdef ALLOW_HDF5_COMPRESSION
+/*! \brief Parses a compression method of the form <name>[<level>] as it appears in the HDF5CompressionPolicy parameter
+ */
+static compression_policy parse_compression_method(const char *method, const char *datasetname)
+{
+  static const char *method_names[] = {"none", "gzip", "lz4", "zstd", "keepbits", "delta"};
+  static const int default_levels[] = {0, 9, 0, 1, -1, 0};
+
+  /* the level is given by trailing digits, unless the digits are part of the name itself (lz4) */
+  size_t len = strlen(method);
+  if(strcmp(method, "lz4") != 0)
+    while(len > 0 && isdigit(method[len - 1]))
+      len--;
+
+  compression_policy policy;
+  int m = 0;
+  while(m < 6 && (strlen(method_names[m]) != len || strncmp(method, method_names[m], len) != 0))
+    m++;
+
+  if(m == 6)
+    Terminate("unknown compression method '%s' for dataset '%s' in HDF5CompressionPolicy, known are none, gzip<1-9>, lz4, zstd<1-22>, "
+              "keepbits<1-52>, delta",
+              method, datasetname);
+
+  policy.method = (compression_methods)m;
+  policy.level  = (method[len] != 0) ? atoi(method + len) : default_levels[m];
+
+  if(policy.method == COMPRESSION_GZIP && (policy.level < 1 || policy.level > 9))
+    Terminate("gzip level for dataset '%s' needs to be in the range 1-9", datasetname);
+  if(policy.method == COMPRESSION_ZSTD && (policy.level < 1 || policy.level > 22))
+    Terminate("zstd level for dataset '%s' needs to be in the range 1-22", datasetname);
+  if(policy.method == COMPRESSION_KEEPBITS && (policy.level < 1 || policy.level > 52))
+    Terminate("keepbits for dataset '%s' needs to be given as keepbits<n> with n in the range 1-52", datasetname);
+  if((policy.method == COMPRESSION_NONE || policy.method == COMPRESSION_LZ4 || policy.method == COMPRESSION_DELTA) && method[len] != 0)
+    Terminate("compression method '%s' for dataset '%s' does not take a level", method, datasetname);
+
+  return policy;
+}
+#endif
+
+/*! \brief Determines with which filters a dataset is written
+ *
+ *  Datasets that are flagged with compression_on are by default written with byte shuffling and gzip compression. With
+ *  ALLOW_HDF5_COMPRESSION, the parameter HDF5CompressionPolicy can override this for individual datasets, identified by their
+ *  name, with a comma-separated list of entries of the form <datasetname>:<method>, or it can be set to 'default'.
+ *
+ *  \param datasetname name of the dataset in the HDF5 file
+ *  \param compression_on whether the dataset is compressed by default
+ *  \return the filters to apply
+ */
+compression_policy get_compression_policy(const char *datasetname, bool compression_on)
+{
+  compression_policy policy;
+  policy.method = compression_on ? COMPRESSION_GZIP : COMPRESSION_NONE;
+  policy.level  = 9;
+
+#ifdef ALLOW_HDF5_COMPRESSION
+  if(strcmp(All.HDF5CompressionPolicy, "default") == 0)
+    return policy;
+
+  char buf[MAXLEN_PATH];
+  strncpy(buf, All.HDF5CompressionPolicy, MAXLEN_PATH - 1);
+  buf[MAXLEN_PATH - 1] = 0;
+
+  char *saveptr;
+  for(char *tok = strtok_r(buf, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr))
+    {
+      char *method = strchr(tok, ':');
+      if(!method)
+        Terminate("entry '%s' in HDF5CompressionPolicy is not of the form <datasetname>:<method>", tok);
+
+      *method++ = 0;
+
+      if(strcmp(tok, datasetname) == 0)
+        policy = parse_compression_method(method, tok);
+    }
+#endif
+
+  return policy;
+}
+
+/*! \brief Checks the syntax of the HDF5CompressionPolicy parameter, and reports codecs that are not available
+ *
+ *  The LZ4 and Zstandard codecs are not part of the HDF5 library but come as filter plugins. If they are not found, deflate with
+ *  level 1 is used in their place.
+ *
+ *  \param verbose if true, a message is printed for every requested codec that is not available
+ */
+void report_compression_filters(bool verbose)
+{
+#ifdef ALLOW_HDF5_COMPRESSION
+  if(strcmp(All.HDF5CompressionPolicy, "default") == 0)
+    return;
+
+  char buf[MAXLEN_PATH];
+  strncpy(buf, All.HDF5CompressionPolicy, MAXLEN_PATH - 1);
+  buf[MAXLEN_PATH - 1] = 0;
+
+  char *saveptr;
+  for(char *tok = strtok_r(buf, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr))
+    {
+      char *method = strchr(tok, ':');
+      if(!method)
+        Terminate("entry '%s' in HDF5CompressionPolicy is not of the form <datasetname>:<method>", tok);
+
+      *method++ = 0;
+
+      compression_policy policy = parse_compression_method(method, tok);
+
+      if(verbose && policy.method == COMPRESSION_LZ4 && H5Zfilter_avail(H5Z_FILTER_LZ4_PLUGIN) <= 0)
+        printf("HDF5: LZ4 filter plugin not found, dataset '%s' is compressed with deflate instead\n", tok);
+
+      if(verbose && policy.method == COMPRESSION_ZSTD && H5Zfilter_avail(H5Z_FILTER_ZSTD_PLUGIN) <= 0)
+        printf("HDF5: Zstandard filter plugin not found, dataset '%s' is compressed with deflate instead\n", tok);
+    }
+#endif
+}
+
+/*! \brief Adds the lossless compression stage to a filter pipeline, falling back to fast deflate if a plugin is missing
+ */
+static void set_lossless_filter(hid_t prop, compression_methods method, int level)
+{
+  if(method == COMPRESSION_LZ4 && H5Zfilter_avail(H5Z_FILTER_LZ4_PLUGIN) > 0)
+    H5Pset_filter(prop, H5Z_FILTER_LZ4_PLUGIN, H5Z_FLAG_MANDATORY, 0, NULL);
+  else if(method == COMPRESSION_ZSTD && H5Zfilter_avail(H5Z_FILTER_ZSTD_PLUGIN) > 0)
+    {
+      unsigned int cd_values[1] = {(unsigned int)level};
+      H5Pset_filter(prop, H5Z_FILTER_ZSTD_PLUGIN, H5Z_FLAG_MANDATORY, 1, cd_values);
+    }
+  else
+    H5Pset_deflate(prop, method == COMPRESSION_GZIP ? level : 1);
+}
+
+/*! \brief Creates the dataset creation properties for writing a dataset with the given compression policy
+ *
+ *  The chunks hold about COMPRESSION_CHUNKBYTES of uncompressed data, which keeps the per-chunk overhead of the filter pipeline
+ *  small compared to the time spent in the codecs. Delta coding is the exception: the scale-offset filter stores each value relative
+ *  to the minimum of its chunk, so a chunk holds only COMPRESSION_DELTA_CHUNKSIZE values of a single component. For spatially ordered
+ *  particles these cover a compact region, and the offsets need correspondingly fewer bits.
+ *
+ *  \param policy the compression policy, which must not be COMPRESSION_NONE
+ *  \param file_datatype the HDF5 type of the data in the file
+ *  \param rank the rank of the dataset (1 or 2)
+ *  \param dims the dimensions of the dataset
+ *  \param datasetname name of the dataset, used in error messages
+ *  \return the property list, to be closed by the caller
+ */
+hid_t my_H5Pcreate_compressed(compression_policy policy, hid_t file_datatype, int rank, const hsize_t *dims, const char *datasetname)
+{
+  size_t typesize    = my_H5Tget_size(file_datatype);
+  H5T_class_t class_ = H5Tget_class(file_datatype);
+
+  hsize_t chunk_dims[2];
+
+  if(policy.method == COMPRESSION_DELTA)
+    {
+      if(class_ != H5T_INTEGER || (typesize != 4 && typesize != 8))
+        Terminate("delta coding of dataset '%s' requires 32-bit or 64-bit integers in the file", datasetname);
+
+      chunk_dims[0] = COMPRESSION_DELTA_CHUNKSIZE;
+      chunk_dims[1] = 1;
+    }
+  else
+    {
+      if(policy.method == COMPRESSION_KEEPBITS && class_ != H5T_FLOAT)
+        Terminate("mantissa rounding of dataset '%s' requires a floating point type", datasetname);
+
+      chunk_dims[0] = COMPRESSION_CHUNKBYTES / (typesize * (rank == 2 ? dims[1] : 1));
+      chunk_dims[1] = (rank == 2) ? dims[1] : 1;
+    }
+
+  if(chunk_dims[0] > dims[0])
+    chunk_dims[0] = dims[0];
+  if(chunk_dims[0] < 1)
+    chunk_dims[0] = 1;
+
+  hid_t prop = H5Pcreate(H5P_DATASET_CREATE);
+
+  H5Pset_chunk(prop, rank, chunk_dims);
+
+  switch(policy.method)
+    {
+      case COMPRESSION_GZIP:
+      case COMPRESSION_LZ4:
+      case COMPRESSION_ZSTD:
+        H5Pset_shuffle(prop); /* reshuffle bytes to get better compression ratio */
+        set_lossless_filter(prop, policy.method, policy.level);
+        break;
+      case COMPRESSION_KEEPBITS:
+        H5Pset_shuffle(prop); /* the zeroed trailing mantissa bits end up in long runs of zero bytes */
+        set_lossless_filter(prop, COMPRESSION_LZ4, 0);
+        break;
+      case COMPRESSION_DELTA:
+        H5Pset_scaleoffset(prop, H5Z_SO_INT, H5Z_SO_INT_MINBITS_DEFAULT);
+        break;
+      default:
+        Terminate("unexpected compression method %d for dataset '%s'", policy.method, datasetname);
+        break;
+    }
+
+  if(!H5Pall_filters_avail(prop))
+    Terminate("HDF5: Compression not available!\n");
+
+  return prop;
+}
+
+template <typename T>
+static void round_mantissa_bits_type(T *x, size_t n, int mantissa_bits, int exponent_bits, int keepbits)
+{
+  if(keepbits >= mantissa_bits)
+    return;
+
+  int shift      = mantissa_bits - keepbits;
+  T mask         = ~((((T)1) << shift) - 1);
+  T halfminusone = (((T)1) << (shift - 1)) - 1;
+  T expmask      = ((((T)1) << exponent_bits) - 1) << mantissa_bits;
+
+  for(size_t i = 0; i < n; i++)
+    if((x[i] & expmask) != expmask) /* leave infinities and NaNs alone */
+      x[i] = (x[i] + halfminusone + ((x[i] >> shift) & 1)) & mask; /* round to nearest, ties to even */
+}
+
+/*! \brief Rounds floating point values to a given number of mantissa bits
+ *
+ *  The relative error of each value is at most 2^-(keepbits+1). The result remains an ordinary IEEE number that any reader can
+ *  use, but its trailing mantissa bits are zero and therefore compress well after byte shuffling.
+ *
+ *  \param buf the values, which are modified in place
+ *  \param n number of values
+ *  \param bytes_per_value 4 for float or 8 for double
+ *  \param keepbits number of explicit mantissa bits to retain
+ */
+void round_mantissa_bits(void *buf, size_t n, size_t bytes_per_value, int keepbits)
+{
+  if(bytes_per_value == sizeof(uint32_t))
+    round_mantissa_bits_type<uint32_t>((uint32_t *)buf, n, 23, 8, keepbits);
+  else if(bytes_per_value == sizeof(uint64_t))
+    round_mantissa_bits_type<uint64_t>((uint64_t *)buf, n, 52, 11, keepbits);
+  else
+    Terminate("mantissa rounding is only supported for float and double, not for %d-byte values", (int)bytes_per_value);
+}
@@ -16,7 +16,27 @@
 
 #include <hdf5.h>
 
-#define COMPRESSION_CHUNKSIZE 1000
+#define COMPRESSION_CHUNKBYTES (1024 * 1024) /* target size of the chunks of filtered datasets */
+#define COMPRESSION_DELTA_CHUNKSIZE 8192     /* values per chunk for delta coding, small enough to cover a compact region */
+
+#define H5Z_FILTER_LZ4_PLUGIN 32004 /* registered filter identifiers of the LZ4 and Zstandard HDF5 plugins */
+#define H5Z_FILTER_ZSTD_PLUGIN 32015
+
+enum compression_methods
+{
+  COMPRESSION_NONE,     /* contiguous, unfiltered dataset */
+  COMPRESSION_GZIP,     /* byte shuffle followed by deflate */
+  COMPRESSION_LZ4,      /* byte shuffle followed by LZ4 */
+  COMPRESSION_ZSTD,     /* byte shuffle followed by Zstandard */
+  COMPRESSION_KEEPBITS, /* mantissa rounding to a given number of bits, followed by the fastest available lossless codec */
+  COMPRESSION_DELTA     /* per-component offset coding of integers with the minimum number of bits (scale-offset filter) */
+};
+
+struct compression_policy
+{
+  compression_methods method;
+  int level; /* compression level for GZIP/ZSTD, number of retained mantissa bits for KEEPBITS */
+};
 
 extern hid_t Halfprec_memtype;
 extern hid_t Int48_memtype;
@@ -58,6 +78,11 @@ herr_t my_H5Sselect_hyperslab(hid_t space_id, H5S_seloper_t op, const hsize_t *s
 size_t my_H5Tget_size(hid_t datatype_id);
 herr_t my_H5Tset_size(hid_t datatype_id, size_t size);
 
+compression_policy get_compression_policy(const char *datasetname, bool compression_on);
+void report_compression_filters(bool verbose);
+hid_t my_H5Pcreate_compressed(compression_policy policy, hid_t file_datatype, int rank, const hsize_t *dims, const char *datasetname);
+void round_mantissa_bits(void *buf, size_t n, size_t bytes_per_value, int keepbits);
+
 void write_scalar_attribute(hid_t handle, const char *attr_name, const void *buf, hid_t mem_type_id);
 void write_vector_attribute(hid_t handle, const char *attr_name, const void *buf, hid_t mem_type_id, int length);
 void write_string_attribute(hid_t handle, const char *attr_name, const char *buf);
@@ -27,6 +27,7 @@
 #include "../data/dtypes.h"
 #include "../data/mymalloc.h"
 #include "../fof/fof.h"
+#include "../io/async_write.h"
 #include "../io/hdf5_util.h"
 #include "../io/io.h"
 #include "../io/parameters.h"
@@ -36,6 +37,7 @@
 #include "../main/simulation.h"
 #include "../mergertree/mergertree.h"
 #include "../mpi_utils/mpi_utils.h"
+#include "../sort/peano.h"
 #include "../subfind/subfind.h"
 #include "../system/system.h"
 
@@ -97,12 +99,17 @@ void IO_Def::init_field(const char *label, const char *datasetname, enum types_i
   field->type_in_memory      = type_in_memory;
   field->type_in_file_output = type_in_file_output;
   field->read_flag           = read_flag;
+  field->read_block          = 1;
   field->values_per_block    = values_per_block;
   field->typelist            = typelist_bitmask;
 #ifdef ALLOW_HDF5_COMPRESSION
-  field->compression_on = compression_on;
+  field->compression = get_compression_policy(datasetname, compression_on);
+
+  if(field->compression.method == COMPRESSION_KEEPBITS && type_in_memory != MEM_FLOAT && type_in_memory != MEM_DOUBLE &&
+     type_in_memory != MEM_MY_FLOAT && type_in_memory != MEM_MY_DOUBLE)
+    Terminate("mantissa rounding was requested for dataset '%s', which is not a floating point field", datasetname);
 #else
-  field->compression_on = false;
+  field->compression = get_compression_policy(datasetname, false);
 #endif
 
   field->array   = array;
@@ -132,6 +139,10 @@ void IO_Def::init_field(const char *label, const char *datasetname, enum types_i
  */
 int IO_Def::find_files(const char *fname, const char *fname_multiple)
 {
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  AsyncWrite.wait(); /* the HDF5 library may only be used by one thread at a time */
+#endif
+
   FILE *fd;
   char buf[MAXLEN_PATH_EXTRA], buf1[MAXLEN_PATH_EXTRA];
   int dummy, files_found = 0;
@@ -227,6 +238,10 @@ int IO_Def::find_files(const char *fname, const char *fname_multiple)
 
 void IO_Def::read_files_driver(const char *fname, int rep, int num_files)
 {
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  AsyncWrite.wait(); /* the HDF5 library may only be used by one thread at a time */
+#endif
+
   if(rep == 0)
     {
       ntype_in_files =
@@ -381,6 +396,11 @@ void IO_Def::share_particle_number_in_file(const char *fname, int filenr, int re
   else
     MPI_Recv(header_buf, header_size, MPI_BYTE, readTask, TAG_HEADER, Communicator, MPI_STATUS_IGNORE);
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+  if(ReadRegionActive)
+    select_region_in_file(fname, readTask, lastTask);
+#endif
+
   read_file_header(fname, filenr, readTask, lastTask, n_type, npart, NULL);
 
   if(ThisTask == readTask)
@@ -401,6 +421,11 @@ void IO_Def::share_particle_number_in_file(const char *fname, int filenr, int re
 
       read_increase_numbers(type, n_for_this_task);
     }
+
+#ifdef SNAPSHOT_PHKEY_INDEX
+  if(ReadRegionActive && ThisTask == readTask)
+    Mem.myfree(SelRuns);
+#endif
 }
 
 /*! \brief This function fills the write buffer with particle data.
@@ -543,6 +568,10 @@ void IO_Def::fill_write_buffer(int blocknr, int *startindex, int pc, int type, v
     }
 
   *startindex = pindex;
+
+  if(field->compression.method == COMPRESSION_KEEPBITS && file_format == FILEFORMAT_HDF5)
+    round_mantissa_bits(CommBuffer, (size_t)pc * field->values_per_block,
+                        get_bytes_per_memory_blockelement(blocknr, 0) / field->values_per_block, field->compression.level);
 }
 
 /*! \brief This function reads out the io buffer that was filled with particle data.
@@ -700,6 +729,10 @@ void IO_Def::polling(int numfilesperdump)
  * number of files simultanuously */
 void IO_Def::write_multiple_files(char *fname, int numfilesperdump, int append_flag, int chunksize)
 {
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  AsyncWrite.wait(); /* the HDF5 library may only be used by one thread at a time */
+#endif
+
   if(ThisTask == 0)
     if(!(seq = (seq_data *)Mem.mymalloc("seq", NTask * sizeof(seq_data))))
       Terminate("can't allocate seq_data");
@@ -796,6 +829,217 @@ void IO_Def::write_multiple_files(char *fname, int numfilesperdump, int append_f
     Mem.myfree(seq);
 }
 
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+/*! \brief Writes a set of HDF5 files without making the caller wait for the disk
+ *
+ *  The data of each file is collected in memory on the task that is responsible for the file, and is then written by a
+ *  background thread of this task while the simulation continues. Since no disk I/O is done in the foreground, all files
+ *  are staged simultaneously, i.e. MaxFilesWithConcurrentIO does not apply here. A subsequent I/O operation, the writing
+ *  of restart files, and the end of the run wait for the background write to finish.
+ *
+ *  \param fname base name of the files
+ *  \param numfilesperdump number of files the output is distributed over
+ *  \return 1 if the files are written in the background, 0 if they had to be written right away because they are not in HDF5
+ *          format
+ */
+int IO_Def::write_multiple_files_in_background(char *fname, int numfilesperdump)
+{
+  if(file_format != FILEFORMAT_HDF5)
+    {
+      write_multiple_files(fname, numfilesperdump);
+      return 0;
+    }
+
+  AsyncWrite.wait();
+
+  void *CommBuffer = Mem.mymalloc("CommBuffer", COMMBUFFERSIZE);
+
+  /* assign processors to output files */
+  int filenr = 0, masterTask = 0, lastTask = 0;
+  distribute_file(numfilesperdump, &filenr, &masterTask, &lastTask);
+
+  char buf[MAXLEN_PATH_EXTRA];
+  if(numfilesperdump > 1)
+    snprintf(buf, MAXLEN_PATH_EXTRA, "%s.%d", fname, filenr);
+  else
+    snprintf(buf, MAXLEN_PATH_EXTRA, "%s", fname);
+
+  stage_file(buf, masterTask, lastTask, CommBuffer, numfilesperdump);
+
+  Mem.myfree(CommBuffer);
+
+  return 1;
+}
+
+/*! \brief Creates an HDF5 file with all its groups and datasets, and collects the particle data for it in memory
+ *
+ *  This follows write_file(), except that the datasets are filled into staging buffers on 'writeTask', which are then
+ *  handed over to the background writer.
+ *
+ *  \param fname string containing the file name
+ *  \param writeTask the task that is responsible for the file
+ *  \param lastTask the rank of the last task in a writing group
+ */
+void IO_Def::stage_file(char *fname, int writeTask, int lastTask, void *CommBuffer, int numfilesperdump)
+{
+  int typelist[N_DataGroups];
+  long long n_type[N_DataGroups], npart[N_DataGroups];
+  hid_t hdf5_file = 0, hdf5_grp[N_DataGroups];
+
+  fill_file_header(writeTask, lastTask, n_type, npart);
+
+  if(ThisTask == writeTask)
+    {
+      char fbuf[MAXLEN_PATH_EXTRA], buf[MAXLEN_PATH];
+      snprintf(fbuf, MAXLEN_PATH_EXTRA, "%s.hdf5", fname);
+      mpi_printf("%s file: '%s' (file 1 of %d), staged for writing in the background\n", info, fname, numfilesperdump);
+
+      rename_file_to_bak_if_it_exists(fbuf);
+
+      hdf5_file = my_H5Fcreate(fbuf, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+      hid_t hdf5_headergrp = my_H5Gcreate(hdf5_file, "/Header", 0);
+      write_header_fields(hdf5_headergrp);
+      my_H5Gclose(hdf5_headergrp, "/Header");
+
+      hid_t hdf5_paramsgrp = my_H5Gcreate(hdf5_file, "/Parameters", 0);
+      write_parameters_attributes_in_hdf5(hdf5_paramsgrp);
+      my_H5Gclose(hdf5_paramsgrp, "/Parameters");
+
+      hid_t hdf5_configgrp = my_H5Gcreate(hdf5_file, "/Config", 0);
+      write_compile_time_options_in_hdf5(hdf5_configgrp);
+      my_H5Gclose(hdf5_configgrp, "/Config");
+
+      for(int type = 0; type < N_DataGroups; type++)
+        if(npart[type] > 0)
+          {
+            get_datagroup_name(type, buf);
+            hdf5_grp[type] = my_H5Gcreate(hdf5_file, buf, 0);
+          }
+
+      AsyncWrite.begin_file(hdf5_file, fbuf, ThisTask == 0);
+    }
+
+  for(int blocknr = 0; blocknr < N_IO_Fields; blocknr++)
+    {
+      if(IO_Fields[blocknr].type_in_file_output == FILE_NONE)
+        continue;
+
+      unsigned int bytes_per_blockelement = get_bytes_per_memory_blockelement(blocknr, 0);
+      int blockmaxlen                     = (int)(COMMBUFFERSIZE / bytes_per_blockelement);
+      long long npart_in_block            = get_particles_in_block(blocknr, npart, typelist);
+      char dname[MAXLEN_PATH];
+      get_dataset_name(blocknr, dname);
+
+      if(npart_in_block == 0)
+        continue;
+
+      for(int type = 0; type < N_DataGroups; type++)
+        {
+          if(!typelist[type])
+            continue;
+
+          char *staging = NULL;
+
+          if(ThisTask == writeTask && npart[type] > 0)
+            {
+              hid_t hdf5_file_datatype = get_hdf5_outputtype_of_block(blocknr);
+
+              hsize_t dims[2];
+              dims[0]  = npart[type];
+              dims[1]  = get_values_per_blockelement(blocknr);
+              int rank = (dims[1] == 1) ? 1 : 2;
+
+              hid_t hdf5_dataspace_in_file = my_H5Screate_simple(rank, dims, NULL);
+              hid_t hdf5_dataset;
+
+              if(IO_Fields[blocknr].compression.method != COMPRESSION_NONE)
+                {
+                  /* Modify dataset creation properties, i.e. enable compression  */
+                  hid_t hdf5_prop = my_H5Pcreate_compressed(IO_Fields[blocknr].compression, hdf5_file_datatype, rank, dims, dname);
+                  hdf5_dataset    = my_H5Dcreate(hdf5_grp[type], dname, hdf5_file_datatype, hdf5_dataspace_in_file, hdf5_prop);
+                  my_H5Pclose(hdf5_prop);
+                }
+              else
+                hdf5_dataset = my_H5Dcreate(hdf5_grp[type], dname, hdf5_file_datatype, hdf5_dataspace_in_file, H5P_DEFAULT);
+
+              write_dataset_attributes(hdf5_dataset, blocknr);
+
+              my_H5Sclose(hdf5_dataspace_in_file, H5S_SIMPLE);
+
+              byte_count += dims[0] * dims[1] * my_H5Tget_size(hdf5_file_datatype); /* for I/O performance measurement */
+
+              staging = AsyncWrite.add_dataset(hdf5_dataset, get_hdf5_memorytype_of_block(blocknr),
+                                               npart[type] * bytes_per_blockelement, dname);
+            }
+
+          for(int task = writeTask, offset = 0; task <= lastTask; task++)
+            {
+              long long n_for_this_task;
+
+              if(task == ThisTask)
+                {
+                  n_for_this_task = n_type[type];
+
+                  for(int p = writeTask; p <= lastTask; p++)
+                    if(p != ThisTask)
+                      MPI_Send(&n_for_this_task, sizeof(n_for_this_task), MPI_BYTE, p, TAG_NFORTHISTASK, Communicator);
+                }
+              else
+                MPI_Recv(&n_for_this_task, sizeof(n_for_this_task), MPI_BYTE, task, TAG_NFORTHISTASK, Communicator,
+                         MPI_STATUS_IGNORE);
+
+              while(n_for_this_task > 0)
+                {
+                  long long pc = n_for_this_task;
+
+                  if(pc > blockmaxlen)
+                    pc = blockmaxlen;
+
+                  if(ThisTask == task)
+                    fill_write_buffer(blocknr, &offset, pc, type, CommBuffer);
+
+                  if(ThisTask == writeTask)
+                    {
+                      /* the data of other tasks is received directly into the staging buffer */
+                      if(task == writeTask)
+                        memcpy(staging, CommBuffer, bytes_per_blockelement * pc);
+                      else
+                        MPI_Recv(staging, bytes_per_blockelement * pc, MPI_BYTE, task, TAG_PDATA, Communicator, MPI_STATUS_IGNORE);
+
+                      staging += bytes_per_blockelement * pc;
+                    }
+                  else if(task == ThisTask)
+                    MPI_Ssend(CommBuffer, bytes_per_blockelement * pc, MPI_BYTE, writeTask, TAG_PDATA, Communicator);
+
+                  n_for_this_task -= pc;
+                }
+            }
+        }
+    }
+
+#ifdef SNAPSHOT_PHKEY_INDEX
+  if(has_phkey_index())
+    write_phkey_index(writeTask, lastTask, n_type, npart, hdf5_grp);
+#endif
+
+  if(ThisTask == writeTask)
+    {
+      char buf[MAXLEN_PATH];
+
+      /* the groups can be closed already, the datasets in them stay open until they have been written */
+      for(int type = N_DataGroups - 1; type >= 0; type--)
+        if(npart[type] > 0)
+          {
+            get_datagroup_name(type, buf);
+            my_H5Gclose(hdf5_grp[type], buf);
+          }
+
+      AsyncWrite.start();
+    }
+}
+#endif
+
 /*! \brief Actually write the snapshot file to the disk
  *
  *  This function writes a snapshot file containing the data from processors
@@ -962,23 +1206,15 @@ void IO_Def::write_file(char *fname, int writeTask, int lastTask, void *CommBuff
                               hdf5_dataset =
                                   my_H5Dcreate(hdf5_grp[type], dname, hdf5_file_datatype, hdf5_dataspace_in_file, hdf5_prop);
                             }
-                          else if(IO_Fields[blocknr].compression_on)
+                          else if(IO_Fields[blocknr].compression.method != COMPRESSION_NONE)
                             {
                               hdf5_dataspace_in_file = my_H5Screate_simple(rank, dims, NULL);
 
                               /* Modify dataset creation properties, i.e. enable compression  */
-                              hdf5_prop             = H5Pcreate(H5P_DATASET_CREATE);
-                              hsize_t chunk_dims[2] = {COMPRESSION_CHUNKSIZE, dims[1]};
-                              if(chunk_dims[0] > dims[0])
-                                chunk_dims[0] = dims[0];
-                              H5Pset_chunk(hdf5_prop, rank, chunk_dims); /* set chunk size */
-                              H5Pset_shuffle(hdf5_prop);                 /* reshuffle bytes to get better compression ratio */
-                              H5Pset_deflate(hdf5_prop, 9);              /* gzip compression level 9 */
-                              if(H5Pall_filters_avail(hdf5_prop))
-                                hdf5_dataset =
-                                    my_H5Dcreate(hdf5_grp[type], dname, hdf5_file_datatype, hdf5_dataspace_in_file, hdf5_prop);
-                              else
-                                Terminate("HDF5: Compression not available!\n");
+                              hdf5_prop =
+                                  my_H5Pcreate_compressed(IO_Fields[blocknr].compression, hdf5_file_datatype, rank, dims, dname);
+                              hdf5_dataset =
+                                  my_H5Dcreate(hdf5_grp[type], dname, hdf5_file_datatype, hdf5_dataspace_in_file, hdf5_prop);
                             }
                           else
                             {
@@ -1074,7 +1310,7 @@ void IO_Def::write_file(char *fname, int writeTask, int lastTask, void *CommBuff
                           if(file_format == FILEFORMAT_HDF5)
                             {
                               my_H5Dclose(hdf5_dataset, dname);
-                              if(chunksize > 0 || IO_Fields[blocknr].compression_on)
+                              if(chunksize > 0 || IO_Fields[blocknr].compression.method != COMPRESSION_NONE)
                                 my_H5Pclose(hdf5_prop);
                               my_H5Sclose(hdf5_dataspace_in_file, H5S_SIMPLE);
                             }
@@ -1091,6 +1327,11 @@ void IO_Def::write_file(char *fname, int writeTask, int lastTask, void *CommBuff
         }
     }
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+  if(file_format == FILEFORMAT_HDF5 && has_phkey_index())
+    write_phkey_index(writeTask, lastTask, n_type, npart, hdf5_grp);
+#endif
+
   if(ThisTask == writeTask)
     {
       if(file_format == FILEFORMAT_HDF5)
@@ -1447,6 +1688,11 @@ void IO_Def::read_file(const char *fname, int filenr, int readTask, int lastTask
   else
     MPI_Recv(header_buf, header_size, MPI_BYTE, readTask, TAG_HEADER, Communicator, MPI_STATUS_IGNORE);
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+  if(ReadRegionActive)
+    select_region_in_file(fname, readTask, lastTask);
+#endif
+
   int nstart;
   read_file_header(fname, filenr, readTask, lastTask, n_type, npart, &nstart);
 
@@ -1470,7 +1716,7 @@ void IO_Def::read_file(const char *fname, int filenr, int readTask, int lastTask
 
   for(int blocknr = 0; blocknr < N_IO_Fields; blocknr++)
     {
-      if((IO_Fields[blocknr].read_flag != SKIP_ON_READ &&
+      if((IO_Fields[blocknr].read_flag != SKIP_ON_READ && IO_Fields[blocknr].read_block &&
           !(file_format == FILEFORMAT_LEGACY1 && All.RestartFlag == RST_BEGIN && type_of_file == FILE_IS_SNAPSHOT &&
             blocknr > 4) /* this second conditions allows short legacy ICs to be read in */
           ) ||
@@ -1576,7 +1822,10 @@ void IO_Def::read_file(const char *fname, int filenr, int readTask, int lastTask
                                         rank = 1;
                                       else
                                         rank = 2;
-
+#ifdef SNAPSHOT_PHKEY_INDEX
+                                      if(ReadRegionActive)
+                                        dims[0] = SelNumInFile[type];
+#endif
                                       hdf5_dataspace_in_file = my_H5Screate_simple(rank, dims, NULL);
 
                                       dims[0]                  = pc;
@@ -1588,8 +1837,12 @@ void IO_Def::read_file(const char *fname, int filenr, int readTask, int lastTask
                                       count[0] = pc;
                                       count[1] = get_values_per_blockelement(blocknr);
                                       pcsum += pc;
-
-                                      my_H5Sselect_hyperslab(hdf5_dataspace_in_file, H5S_SELECT_SET, start, NULL, count, NULL);
+#ifdef SNAPSHOT_PHKEY_INDEX
+                                      if(ReadRegionActive)
+                                        select_hyperslab_of_region(hdf5_dataspace_in_file, type, start[0], count[0], count[1]);
+                                      else
+#endif
+                                        my_H5Sselect_hyperslab(hdf5_dataspace_in_file, H5S_SELECT_SET, start, NULL, count, NULL);
 
                                       // Test if dataset was present
                                       if(hdf5_dataset < 0)
@@ -1701,6 +1954,11 @@ void IO_Def::read_file(const char *fname, int filenr, int readTask, int lastTask
           my_H5Fclose(hdf5_file, fname);
         }
     }
+
+#ifdef SNAPSHOT_PHKEY_INDEX
+  if(ReadRegionActive && ThisTask == readTask)
+    Mem.myfree(SelRuns);
+#endif
 }
 
 /*! \brief This function assigns a certain number of tasks to each file.
@@ -2209,6 +2467,10 @@ void IO_Def::read_segment(const char *fname, int type, long long offset, long lo
 void IO_Def::read_single_file_segment(const char *basename, int filenr, int type, long long offset, unsigned long long count,
                                       long long storage_offset, int num_files)
 {
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  AsyncWrite.wait(); /* the HDF5 library may only be used by one thread at a time */
+#endif
+
   int bytes_per_blockelement_in_file = 0;
   hid_t hdf5_file = 0, hdf5_grp = 0, hdf5_dataspace_in_file;
   hid_t hdf5_dataspace_in_memory, hdf5_dataset;
@@ -2443,6 +2705,10 @@ void IO_Def::rename_file_to_bak_if_it_exists(char *fname)
 
 void IO_Def::alloc_and_read_ntype_in_files(const char *fname, int num_files)
 {
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  AsyncWrite.wait(); /* the HDF5 library may only be used by one thread at a time */
+#endif
+
   ntype_in_files = (long long *)Mem.mymalloc_movable(&ntype_in_files, "ntype_in_files", num_files * N_DataGroups * sizeof(long long));
 
   for(int filenr = 0; filenr < num_files; filenr++)
@@ -2504,3 +2770,488 @@ void IO_Def::alloc_and_read_ntype_in_files(const char *fname, int num_files)
         ntype_in_files[filenr * N_DataGroups + type] = npart[type];
     }
 }
+
+#ifdef SNAPSHOT_PHKEY_INDEX
+
+/*! \brief Collects the intervals of index keys whose cells overlap with a periodic cube
+ *
+ *  The octree of the index grid is descended in key order, such that the intervals come out sorted and adjacent ones can be
+ *  merged on the fly. Cells that lie inside the cube, that have the resolution of the index, or that are small compared to the
+ *  cube are not refined further. This keeps the number of intervals modest, the exact test is done for each particle anyway.
+ *
+ *  \param cell lower corner of the cell that is refined
+ *  \param level refinement level of the cell, 0 for the whole box
+ *  \param rotation orientation of the Peano-Hilbert curve in the cell
+ *  \param key index key of the cell
+ *  \param corner lower corner of the cube
+ *  \param len side length of the cube
+ *  \param intervals list of (kmin, kmax) pairs, grown as needed
+ *  \param nint number of intervals in the list
+ *  \param maxint number of intervals for which space is allocated
+ */
+static void phkey_region_intervals(MyIntPosType *cell, int level, unsigned char rotation, long long key, MyIntPosType *corner,
+                                   MyIntPosType len, long long **intervals, int *nint, int *maxint)
+{
+  MyIntPosType size = ((MyIntPosType)1) << (BITS_FOR_POSITIONS - level - 1); /* side length of the daughter cells */
+
+  int pix_of_sub[8];
+  unsigned char rotation_of_sub[8];
+
+  for(int pix = 0; pix < 8; pix++)
+    {
+      unsigned char rot    = rotation;
+      int sub              = peano_incremental_key(pix, &rot);
+      pix_of_sub[sub]      = pix;
+      rotation_of_sub[sub] = rot;
+    }
+
+  for(int sub = 0; sub < 8; sub++)
+    {
+      int pix = pix_of_sub[sub];
+
+      MyIntPosType daughter[3] = {cell[0] + ((pix & 4) ? size : 0), cell[1] + ((pix & 2) ? size : 0),
+                                  cell[2] + ((pix & 1) ? size : 0)};
+
+      bool overlap = true, inside = true;
+
+      for(int j = 0; j < 3; j++)
+        {
+          MyIntPosType d = daughter[j] - corner[j];
+
+          if(d >= len && (MyIntPosType)(corner[j] - daughter[j]) >= size)
+            overlap = false;
+
+          if(d >= len || size > len - d)
+            inside = false;
+        }
+
+      if(!overlap)
+        continue;
+
+      long long daughterkey = (key << 3) | sub;
+
+      if(inside || level + 1 == PHKEY_INDEX_BITS || size <= (len >> 6))
+        {
+          int shift      = 3 * (PHKEY_INDEX_BITS - level - 1);
+          long long kmin = daughterkey << shift;
+          long long kmax = ((daughterkey + 1) << shift) - 1;
+
+          if(*nint > 0 && (*intervals)[2 * (*nint) - 1] + 1 == kmin)
+            (*intervals)[2 * (*nint) - 1] = kmax;
+          else
+            {
+              if(*nint == *maxint)
+                {
+                  *maxint *= 2;
+                  *intervals = (long long *)Mem.myrealloc_movable(*intervals, 2 * (*maxint) * sizeof(long long));
+                }
+
+              (*intervals)[2 * (*nint)]     = kmin;
+              (*intervals)[2 * (*nint) + 1] = kmax;
+              (*nint)++;
+            }
+        }
+      else
+        phkey_region_intervals(daughter, level + 1, rotation_of_sub[sub], daughterkey, corner, len, intervals, nint, maxint);
+    }
+}
+
+/*! \brief Restricts the fields that are read to the given list of dataset names
+ *
+ *  The first block, which also initializes the particle types, is always read.
+ *
+ *  \param fieldlist comma-separated list of dataset names without blanks, or 'all'
+ */
+void IO_Def::set_read_fields(const char *fieldlist)
+{
+  if(strcmp(fieldlist, "all") == 0)
+    return;
+
+  for(int blocknr = 1; blocknr < N_IO_Fields; blocknr++)
+    IO_Fields[blocknr].read_block = 0;
+
+  char buf[MAXLEN_PATH];
+  strncpy(buf, fieldlist, MAXLEN_PATH - 1);
+  buf[MAXLEN_PATH - 1] = 0;
+
+  for(char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ","))
+    {
+      int found = 0;
+
+      for(int blocknr = 0; blocknr < N_IO_Fields; blocknr++)
+        if(strcmp(tok, IO_Fields[blocknr].datasetname) == 0)
+          {
+            IO_Fields[blocknr].read_block = 1;
+            found++;
+          }
+
+      if(found == 0)
+        Terminate("unknown dataset '%s' in the list of fields to read", tok);
+    }
+}
+
+/*! \brief Restricts the particles that are read to a periodic cube in integer coordinates
+ *
+ *  \param corner lower corner of the cube
+ *  \param len side length of the cube
+ */
+void IO_Def::set_read_region(MyIntPosType *corner, MyIntPosType len)
+{
+  if(file_format != FILEFORMAT_HDF5)
+    Terminate("reading only the particles in a region requires files in HDF5 format");
+
+  if(type_of_file != FILE_IS_SNAPSHOT || N_DataGroups > NTYPES + 1)
+    Terminate("reading only the particles in a region is only possible for snapshot files");
+
+  for(int j = 0; j < 3; j++)
+    ReadRegionCorner[j] = corner[j];
+
+  ReadRegionLen    = len;
+  ReadRegionActive = true;
+}
+
+/*! \brief Writes the Peano-Hilbert key index of the particle groups of a snapshot file
+ *
+ *  The particles each task contributes to the file are split into segments of at most PHKEY_INDEX_SEGMENT consecutive
+ *  particles, and the range of Peano-Hilbert keys of each segment is recorded. As the particles of a task are stored in
+ *  Peano-Hilbert order, these ranges are narrow, which allows a reader to find the parts of the file that overlap with a
+ *  region. Each particle group receives a dataset 'PHKeyIndex' with the rows (offset, count, kmin, kmax).
+ *
+ *  \param writeTask the task that writes the file
+ *  \param lastTask the last task that contributes particles to the file
+ *  \param n_type the local number of particles of each type
+ *  \param npart the number of particles of each type in the file
+ *  \param hdf5_grp the HDF5 groups of the particle types, only used on writeTask
+ */
+void IO_Def::write_phkey_index(int writeTask, int lastTask, long long *n_type, long long *npart, hid_t *hdf5_grp)
+{
+  for(int type = 0; type < N_DataGroups && type < NTYPES; type++)
+    {
+      if(npart[type] == 0)
+        continue;
+
+      int nseg           = (n_type[type] + PHKEY_INDEX_SEGMENT - 1) / PHKEY_INDEX_SEGMENT;
+      phkey_segment *seg = (phkey_segment *)Mem.mymalloc("seg", nseg * sizeof(phkey_segment));
+
+      for(int n = 0, pindex = 0; n < n_type[type]; pindex++)
+        {
+          if(get_type_of_element(pindex) != type)
+            continue;
+
+          MyIntPosType xyz[3];
+          get_unshifted_intpos_of_element(pindex, xyz);
+
+          peanokey key = peano_hilbert_key(xyz[0] >> (BITS_FOR_POSITIONS - PHKEY_INDEX_BITS),
+                                           xyz[1] >> (BITS_FOR_POSITIONS - PHKEY_INDEX_BITS),
+                                           xyz[2] >> (BITS_FOR_POSITIONS - PHKEY_INDEX_BITS), PHKEY_INDEX_BITS);
+
+          phkey_segment *s = &seg[n / PHKEY_INDEX_SEGMENT];
+
+          if((n % PHKEY_INDEX_SEGMENT) == 0)
+            {
+              s->count = 0;
+              s->kmin  = key.ls;
+              s->kmax  = key.ls;
+            }
+
+          s->count++;
+          s->kmin = std::min<long long>(s->kmin, key.ls);
+          s->kmax = std::max<long long>(s->kmax, key.ls);
+
+          n++;
+        }
+
+      if(ThisTask == writeTask)
+        {
+          int *nseg_of_task = (int *)Mem.mymalloc("nseg_of_task", (lastTask - writeTask + 1) * sizeof(int));
+
+          nseg_of_task[0] = nseg;
+          int ntot        = nseg;
+
+          for(int task = writeTask + 1; task <= lastTask; task++)
+            {
+              MPI_Recv(&nseg_of_task[task - writeTask], 1, MPI_INT, task, TAG_NFORTHISTASK, Communicator, MPI_STATUS_IGNORE);
+              ntot += nseg_of_task[task - writeTask];
+            }
+
+          phkey_segment *index = (phkey_segment *)Mem.mymalloc("index", ntot * sizeof(phkey_segment));
+
+          memcpy(index, seg, nseg * sizeof(phkey_segment));
+
+          for(int task = writeTask + 1, off = nseg; task <= lastTask; task++)
+            {
+              if(nseg_of_task[task - writeTask] > 0)
+                MPI_Recv(&index[off], nseg_of_task[task - writeTask] * sizeof(phkey_segment), MPI_BYTE, task, TAG_PDATA,
+                         Communicator, MPI_STATUS_IGNORE);
+
+              off += nseg_of_task[task - writeTask];
+            }
+
+          /* the segments are stored in the order of the particles in the file */
+          for(long long i = 0, offset = 0; i < ntot; i++)
+            {
+              index[i].offset = offset;
+              offset += index[i].count;
+            }
+
+          hsize_t dims[2]      = {(hsize_t)ntot, 4};
+          hid_t hdf5_dataspace = my_H5Screate_simple(2, dims, NULL);
+          hid_t hdf5_dataset   = my_H5Dcreate(hdf5_grp[type], "PHKeyIndex", H5T_NATIVE_INT64, hdf5_dataspace, H5P_DEFAULT);
+          my_H5Dwrite(hdf5_dataset, H5T_NATIVE_INT64, H5S_ALL, H5S_ALL, H5P_DEFAULT, index, "PHKeyIndex");
+
+          int bits = PHKEY_INDEX_BITS;
+          write_scalar_attribute(hdf5_dataset, "PHKeyBits", &bits, H5T_NATIVE_INT);
+
+          my_H5Dclose(hdf5_dataset, "PHKeyIndex");
+          my_H5Sclose(hdf5_dataspace, H5S_SIMPLE);
+
+          byte_count += ntot * sizeof(phkey_segment); /* for I/O performance measurement */
+
+          Mem.myfree(index);
+          Mem.myfree(nseg_of_task);
+        }
+      else
+        {
+          MPI_Send(&nseg, 1, MPI_INT, writeTask, TAG_NFORTHISTASK, Communicator);
+
+          if(nseg > 0)
+            MPI_Ssend(seg, nseg * sizeof(phkey_segment), MPI_BYTE, writeTask, TAG_PDATA, Communicator);
+        }
+
+      Mem.myfree(seg);
+    }
+}
+
+/*! \brief Determines the particles of a snapshot file that lie in the region that is to be read
+ *
+ *  The reading task converts the region into intervals of index keys, and uses the 'PHKeyIndex' datasets of the file to find
+ *  the segments of particles that may overlap with the region. Only the coordinates of these segments are read, and the
+ *  particles that are inside the region are recorded as runs of consecutive particles in the file. Files without an index are
+ *  treated as a single segment. The numbers of selected particles then replace the particle numbers in the header on all tasks
+ *  that share the file, such that the subsequent reading only deals with the selected particles.
+ *
+ *  \param fname the file name
+ *  \param readTask the task that reads the file
+ *  \param lastTask the last task that receives particles from the file
+ */
+void IO_Def::select_region_in_file(const char *fname, int readTask, int lastTask)
+{
+  long long nsel[NTYPES + 1];
+
+  for(int type = 0; type < N_DataGroups; type++)
+    nsel[type] = 0;
+
+  if(ThisTask == readTask)
+    {
+      int nint = 0, maxint = 64;
+      long long *intervals = (long long *)Mem.mymalloc_movable(&intervals, "intervals", 2 * maxint * sizeof(long long));
+
+      MyIntPosType root[3] = {0, 0, 0};
+      phkey_region_intervals(root, 0, 0, 0, ReadRegionCorner, ReadRegionLen, &intervals, &nint, &maxint);
+
+      int nruns = 0, maxruns = 1024;
+      SelRuns   = (selected_run *)Mem.mymalloc_movable(&SelRuns, "SelRuns", maxruns * sizeof(selected_run));
+
+      hid_t hdf5_file            = my_H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+      hid_t hdf5_memory_datatype = get_hdf5_memorytype_of_block(0);
+      int bytes_per_blockelement = get_bytes_per_memory_blockelement(0, 1);
+      char dname[MAXLEN_PATH];
+      get_dataset_name(0, dname);
+
+      for(int type = 0; type < N_DataGroups; type++)
+        {
+          SelFirstRun[type]  = nruns;
+          SelNumInFile[type] = 0;
+
+          char buf[MAXLEN_PATH];
+          get_datagroup_name(type, buf);
+
+          if(H5Lexists(hdf5_file, buf, H5P_DEFAULT) <= 0)
+            continue;
+
+          hid_t hdf5_grp     = my_H5Gopen(hdf5_file, buf);
+          hid_t hdf5_dataset = my_H5Dopen_if_existing(hdf5_grp, dname);
+
+          if(hdf5_dataset < 0)
+            Terminate("reading only the particles in a region requires dataset '%s' in group '%s' of file '%s'", dname, buf, fname);
+
+          hid_t hdf5_dataspace_in_file = H5Dget_space(hdf5_dataset);
+          hsize_t dims[2];
+          H5Sget_simple_extent_dims(hdf5_dataspace_in_file, dims, NULL);
+          SelNumInFile[type] = dims[0];
+
+          /* read the index of the particle group, or use a single segment if there is none */
+          int nseg           = 1;
+          phkey_segment *seg = NULL;
+
+          hid_t hdf5_index = my_H5Dopen_if_existing(hdf5_grp, "PHKeyIndex");
+
+          if(hdf5_index >= 0)
+            {
+              int bits;
+              read_scalar_attribute(hdf5_index, "PHKeyBits", &bits, H5T_NATIVE_INT);
+              if(bits != PHKEY_INDEX_BITS)
+                Terminate("the index of file '%s' uses %d bits per dimension, but PHKEY_INDEX_BITS=%d", fname, bits,
+                          PHKEY_INDEX_BITS);
+
+              hid_t hdf5_index_space = H5Dget_space(hdf5_index);
+              hsize_t idims[2];
+              H5Sget_simple_extent_dims(hdf5_index_space, idims, NULL);
+              H5Sclose(hdf5_index_space);
+
+              nseg = idims[0];
+              seg  = (phkey_segment *)Mem.mymalloc_movable(&seg, "seg", nseg * sizeof(phkey_segment));
+              my_H5Dread(hdf5_index, H5T_NATIVE_INT64, H5S_ALL, H5S_ALL, H5P_DEFAULT, seg, "PHKeyIndex");
+              my_H5Dclose(hdf5_index, "PHKeyIndex");
+
+              byte_count += nseg * sizeof(phkey_segment); /* for I/O performance measurement */
+            }
+          else
+            {
+              seg           = (phkey_segment *)Mem.mymalloc_movable(&seg, "seg", sizeof(phkey_segment));
+              seg[0].offset = 0;
+              seg[0].count  = SelNumInFile[type];
+              seg[0].kmin   = 0;
+              seg[0].kmax   = (1LL << (3 * PHKEY_INDEX_BITS)) - 1;
+            }
+
+          /* keep the segments whose key range overlaps with an interval of the region, and merge adjacent ones */
+          int ncand = 0;
+
+          for(int i = 0; i < nseg; i++)
+            {
+              int lo = 0, hi = nint;
+              while(lo < hi) /* first interval whose end is not below the smallest key of the segment */
+                {
+                  int mid = (lo + hi) / 2;
+                  if(intervals[2 * mid + 1] < seg[i].kmin)
+                    lo = mid + 1;
+                  else
+                    hi = mid;
+                }
+
+              if(lo == nint || intervals[2 * lo] > seg[i].kmax || seg[i].count == 0)
+                continue;
+
+              if(ncand > 0 && seg[ncand - 1].offset + seg[ncand - 1].count == seg[i].offset)
+                seg[ncand - 1].count += seg[i].count;
+              else
+                seg[ncand++] = seg[i];
+            }
+
+          /* now read the coordinates of the candidates in pieces, and select the particles in the region */
+          int maxlen                = 16 * PHKEY_INDEX_SEGMENT;
+          char *posbuf              = (char *)Mem.mymalloc_movable(&posbuf, "posbuf", maxlen * bytes_per_blockelement);
+          MyIntPosType *intpos      = (MyIntPosType *)Mem.mymalloc_movable(&intpos, "intpos", 3 * maxlen * sizeof(MyIntPosType));
+          hsize_t memdims[2]        = {(hsize_t)maxlen, 3};
+          hid_t hdf5_file_datatype  = H5Dget_type(hdf5_dataset);
+          size_t bytes_in_file      = 3 * my_H5Tget_size(hdf5_file_datatype);
+          H5Tclose(hdf5_file_datatype);
+
+          for(int c = 0; c < ncand; c++)
+            for(long long first = seg[c].offset; first < seg[c].offset + seg[c].count; first += maxlen)
+              {
+                long long pc = std::min<long long>(maxlen, seg[c].offset + seg[c].count - first);
+
+                hsize_t start[2] = {(hsize_t)first, 0};
+                hsize_t count[2] = {(hsize_t)pc, 3};
+                my_H5Sselect_hyperslab(hdf5_dataspace_in_file, H5S_SELECT_SET, start, NULL, count, NULL);
+
+                memdims[0]                     = pc;
+                hid_t hdf5_dataspace_in_memory = my_H5Screate_simple(2, memdims, NULL);
+
+                my_H5Dread(hdf5_dataset, hdf5_memory_datatype, hdf5_dataspace_in_memory, hdf5_dataspace_in_file, H5P_DEFAULT, posbuf,
+                           dname);
+                my_H5Sclose(hdf5_dataspace_in_memory, H5S_SIMPLE);
+
+                byte_count += pc * bytes_in_file; /* for I/O performance measurement */
+
+                convert_file_positions_to_intpos(posbuf, pc, intpos);
+
+                for(long long n = 0; n < pc; n++)
+                  {
+                    if((MyIntPosType)(intpos[3 * n + 0] - ReadRegionCorner[0]) >= ReadRegionLen ||
+                       (MyIntPosType)(intpos[3 * n + 1] - ReadRegionCorner[1]) >= ReadRegionLen ||
+                       (MyIntPosType)(intpos[3 * n + 2] - ReadRegionCorner[2]) >= ReadRegionLen)
+                      continue;
+
+                    if(nruns > SelFirstRun[type] && SelRuns[nruns - 1].offset + SelRuns[nruns - 1].count == first + n)
+                      SelRuns[nruns - 1].count++;
+                    else
+                      {
+                        if(nruns == maxruns)
+                          {
+                            maxruns *= 2;
+                            SelRuns = (selected_run *)Mem.myrealloc_movable(SelRuns, maxruns * sizeof(selected_run));
+                          }
+
+                        SelRuns[nruns].offset = first + n;
+                        SelRuns[nruns].count  = 1;
+                        SelRuns[nruns].start  = nsel[type];
+                        nruns++;
+                      }
+
+                    nsel[type]++;
+                  }
+              }
+
+          Mem.myfree(intpos);
+          Mem.myfree(posbuf);
+          Mem.myfree(seg);
+
+          my_H5Sclose(hdf5_dataspace_in_file, H5S_SIMPLE);
+          my_H5Dclose(hdf5_dataset, dname);
+          my_H5Gclose(hdf5_grp, buf);
+        }
+
+      SelFirstRun[N_DataGroups] = nruns;
+
+      my_H5Fclose(hdf5_file, fname);
+
+      Mem.myfree_movable(intervals);
+
+      for(int task = readTask + 1; task <= lastTask; task++)
+        MPI_Ssend(nsel, N_DataGroups * sizeof(long long), MPI_BYTE, task, TAG_NFORTHISTASK, Communicator);
+    }
+  else
+    MPI_Recv(nsel, N_DataGroups * sizeof(long long), MPI_BYTE, readTask, TAG_NFORTHISTASK, Communicator, MPI_STATUS_IGNORE);
+
+  set_selected_numbers_in_header(nsel);
+}
+
+/*! \brief Selects the part of a dataset in the file that holds a range of the selected particles of a type
+ *
+ *  \param hdf5_dataspace the dataspace of the dataset in the file
+ *  \param type the particle type
+ *  \param first index of the first selected particle in the range
+ *  \param count number of selected particles in the range
+ *  \param values number of values per particle
+ */
+void IO_Def::select_hyperslab_of_region(hid_t hdf5_dataspace, int type, long long first, long long count, int values)
+{
+  H5Sselect_none(hdf5_dataspace);
+
+  /* find the run that contains the first particle of the range */
+  long long lo = SelFirstRun[type], hi = SelFirstRun[type + 1] - 1;
+  while(lo < hi)
+    {
+      long long mid = (lo + hi + 1) / 2;
+      if(SelRuns[mid].start <= first)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+  for(long long r = lo; r < SelFirstRun[type + 1] && SelRuns[r].start < first + count; r++)
+    {
+      long long a = std::max<long long>(first, SelRuns[r].start);
+      long long b = std::min<long long>(first + count, SelRuns[r].start + SelRuns[r].count);
+
+      hsize_t start[2] = {(hsize_t)(SelRuns[r].offset + a - SelRuns[r].start), 0};
+      hsize_t cnt[2]   = {(hsize_t)(b - a), (hsize_t)values};
+
+      my_H5Sselect_hyperslab(hdf5_dataspace, H5S_SELECT_OR, start, NULL, cnt, NULL);
+    }
+}
+
+#endif
@@ -21,12 +21,18 @@
 
 #include "../data/simparticles.h"
 #include "../fof/fof.h"
+#include "../io/hdf5_util.h"
 #include "../io/io_streamcount.h"
 #include "../mpi_utils/setcomm.h"
 
 #define LABEL_LEN 4
 #define DATASETNAME_LEN 256
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+#define PHKEY_INDEX_BITS 10       /* bits per dimension of the Peano-Hilbert keys in the index of snapshot files */
+#define PHKEY_INDEX_SEGMENT 4096  /* number of consecutive particles of a task summarized by one entry of the index */
+#endif
+
 enum arrays
 {
   A_NONE,
@@ -156,6 +162,20 @@ class IO_Def : public io_streamcount, public setcomm
   virtual int get_type_of_element(int index)                                                         = 0;
   virtual void set_type_of_element(int index, int type)                                              = 0;
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+  /* functions that a module provides if its files carry a Peano-Hilbert key index */
+
+  virtual bool has_phkey_index(void) { return false; }
+  virtual void get_unshifted_intpos_of_element(int index, MyIntPosType *intpos) {}
+  virtual void convert_file_positions_to_intpos(void *buf, int n, MyIntPosType *intpos) {}
+  virtual void set_selected_numbers_in_header(long long *nsel) {}
+
+  void set_read_fields(const char *fieldlist);
+  void set_read_region(MyIntPosType *corner, MyIntPosType len);
+
+  bool ReadRegionActive = false;
+#endif
+
   void init_field(const char *label, const char *datasetname, enum types_in_memory type_in_memory,
                   enum types_in_file type_in_file_output, enum read_flags read_flag, int values_per_block, enum arrays array,
                   void *pointer_to_field, void (*io_func)(IO_Def *, int, int, void *, int), int typelist_bitmask, int hasunits,
@@ -164,6 +184,9 @@ class IO_Def : public io_streamcount, public setcomm
   int find_files(const char *fname, const char *fname_multiple);
   void read_files_driver(const char *fname, int rep, int numfiles);
   void write_multiple_files(char *fname, int numfilesperdump, int append_flag = 0, int chunk_size = 0);
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  int write_multiple_files_in_background(char *fname, int numfilesperdump);
+#endif
   void write_compile_time_options_in_hdf5(hid_t handle);
   void read_segment(const char *fname, int type, long long offset, long long count, int numfiles);
   void read_single_file_segment(const char *fname, int filenr, int type, long long offset, unsigned long long count,
@@ -200,7 +223,7 @@ class IO_Def : public io_streamcount, public setcomm
     char datasetname[DATASETNAME_LEN + 1];
     void (*io_func)(IO_Def *, int, int, void *, int);
     int typelist;
-    bool compression_on;
+    compression_policy compression;
     enum arrays array;
     size_t offset;
 
@@ -217,6 +240,9 @@ class IO_Def : public io_streamcount, public setcomm
   void write_file(char *fname, int writeTask, int lastTask, void *CommBuffer, int numfilesperdump, int chunksize);
   void read_file(const char *fname, int filenr, int readTask, int lastTask, void *CommBuffer);
   void append_file(char *fname, int writeTask, int lastTask, void *CommBuffer, int numfilesperdump, int chunksize);
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  void stage_file(char *fname, int writeTask, int lastTask, void *CommBuffer, int numfilesperdump);
+#endif
 
   int get_values_per_blockelement(int blocknr);
   void get_dataset_name(int blocknr, char *buf);
@@ -238,6 +264,34 @@ class IO_Def : public io_streamcount, public setcomm
 
   void polling(int numfilesperdump);
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+  struct phkey_segment
+  {
+    long long offset; /* offset of the first particle of the segment in the file */
+    long long count;  /* number of particles in the segment */
+    long long kmin;   /* smallest and largest Peano-Hilbert key in the segment */
+    long long kmax;
+  };
+
+  struct selected_run
+  {
+    long long offset; /* offset of the first particle of the run in the file */
+    long long count;  /* number of particles in the run */
+    long long start;  /* number of selected particles of this type in the file before the run */
+  };
+
+  MyIntPosType ReadRegionCorner[3];
+  MyIntPosType ReadRegionLen;
+
+  selected_run *SelRuns;              /* runs of selected particles in the file that is read, for all types */
+  long long SelFirstRun[NTYPES + 2];  /* index of the first run of each type in SelRuns */
+  long long SelNumInFile[NTYPES + 1]; /* number of particles of each type in the file, before the selection */
+
+  void write_phkey_index(int writeTask, int lastTask, long long *n_type, long long *npart, hid_t *hdf5_grp);
+  void select_region_in_file(const char *fname, int readTask, int lastTask);
+  void select_hyperslab_of_region(hid_t hdf5_dataspace, int type, long long first, long long count, int values);
+#endif
+
   int files_started;
   int files_completed;
   int file_format;
@@ -27,6 +27,7 @@
 #include "../data/dtypes.h"
 #include "../data/mymalloc.h"
 #include "../domain/domain.h"
+#include "../io/async_write.h"
 #include "../io/io.h"
 #include "../lightcone/lightcone.h"
 #include "../logs/logs.h"
@@ -39,6 +40,11 @@
 
 void restart::write(sim *Sim_ptr)
 {
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  /* a restart must not be taken while the preceding snapshot may still be incomplete on disk */
+  AsyncWrite.wait();
+#endif
+
   Sim = Sim_ptr;
   do_restart(MODUS_WRITE);
 }
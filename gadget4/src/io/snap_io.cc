@@ -337,6 +337,17 @@ void snap_io::read_ic(const char *fname)
 
   MPI_Barrier(Communicator);
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+  if(ReadRegionActive)
+    {
+      /* only the particles in the region have been read, so the totals of the header do not apply */
+      long long n[2] = {Sp->NumPart, Sp->NumGas}, ntot[2];
+      sumup_longs(2, n, ntot, Communicator);
+      Sp->TotNumPart = ntot[0];
+      Sp->TotNumGas  = ntot[1];
+    }
+#endif
+
   long long byte_count = get_io_byte_count(), byte_count_all;
   sumup_longs(1, &byte_count, &byte_count_all, Communicator);
 
@@ -535,6 +546,73 @@ void snap_io::set_type_of_element(int index, int type)
     Sp->P[index].setType(type);
 }
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+bool snap_io::has_phkey_index(void) { return true; }
+
+void snap_io::get_unshifted_intpos_of_element(int index, MyIntPosType *intpos)
+{
+  /* the index refers to the coordinates as they are stored, i.e. without a possible randomization shift */
+  Sp->intpos_to_intpos(Sp->P[index].IntPos, intpos);
+}
+
+/*! \brief Maps the coordinates of the first block as read from a file to integer coordinates in the periodic box
+ *
+ *  This is done before the domain mapping is set up, hence the conversion factor is computed from the box size directly.
+ */
+void snap_io::convert_file_positions_to_intpos(void *buf, int n, MyIntPosType *intpos)
+{
+#ifdef OUTPUT_COORDINATES_AS_INTEGERS
+  memcpy(intpos, buf, 3 * n * sizeof(MyIntPosType));
+#else
+  MyDouble *pos = (MyDouble *)buf;
+  double fac    = pow(2.0, BITS_FOR_POSITIONS) / All.BoxSize;
+
+  for(int i = 0; i < 3 * n; i++)
+    intpos[i] = (MyIntPosType)Sp->constrain_pos(pos[i] * fac);
+#endif
+}
+
+void snap_io::set_selected_numbers_in_header(long long *nsel)
+{
+  for(int type = 0; type < NTYPES; type++)
+    header.npart[type] = nsel[type];
+}
+
+/*! \brief Restricts the next read to the given fields and to the particles in a cube
+ *
+ *  \param fieldlist comma-separated list of dataset names, or 'all'
+ *  \param region center and side length of the cube in the form 'x,y,z,len', or 'all'
+ */
+void snap_io::set_read_selection(const char *fieldlist, const char *region)
+{
+  set_read_fields(fieldlist);
+
+  if(strcmp(region, "all") == 0)
+    return;
+
+  double xyzlen[4];
+  if(sscanf(region, "%lg,%lg,%lg,%lg", &xyzlen[0], &xyzlen[1], &xyzlen[2], &xyzlen[3]) != 4)
+    Terminate("SnapshotReadRegion='%s' needs to be either 'all' or of the form 'x,y,z,len'", region);
+
+  if(xyzlen[3] <= 0)
+    Terminate("SnapshotReadRegion='%s' has a side length that is not positive", region);
+
+  if(xyzlen[3] >= All.BoxSize) /* the cube covers the whole box */
+    return;
+
+  double fac = pow(2.0, BITS_FOR_POSITIONS) / All.BoxSize;
+
+  MyIntPosType corner[3];
+  for(int j = 0; j < 3; j++)
+    corner[j] = (MyIntPosType)Sp->constrain_pos((xyzlen[j] - 0.5 * xyzlen[3]) * fac);
+
+  set_read_region(corner, (MyIntPosType)(xyzlen[3] * fac));
+
+  mpi_printf("READIC: Reading only particles in the cube of side length %g around (%g|%g|%g)\n", xyzlen[3], xyzlen[0], xyzlen[1],
+             xyzlen[2]);
+}
+#endif
+
 void *snap_io::get_base_address_of_structure(enum arrays array, int index)
 {
   switch(array)
@@ -642,15 +720,26 @@ void snap_io::write_snapshot(int num, mysnaptype loc_snap_type)
     }
 
   /* now write the files */
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  int in_background = write_multiple_files_in_background(buf, All.NumFilesPerSnapshot);
+#else
   write_multiple_files(buf, All.NumFilesPerSnapshot);
+#endif
 
   long long byte_count = get_io_byte_count(), byte_count_all;
   sumup_longs(1, &byte_count, &byte_count_all, Communicator);
 
   double t1 = Logs.second();
 
-  mpi_printf("SNAPSHOT: done with writing snapshot.  Took %g sec, total size %g MB, corresponds to effective I/O rate of %g MB/sec\n",
-             Logs.timediff(t0, t1), byte_count_all / (1024.0 * 1024.0), byte_count_all / (1024.0 * 1024.0) / Logs.timediff(t0, t1));
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  if(in_background)
+    mpi_printf("SNAPSHOT: done with staging snapshot.  Took %g sec, total size %g MB, the files are written in the background\n",
+               Logs.timediff(t0, t1), byte_count_all / (1024.0 * 1024.0));
+  else
+#endif
+    mpi_printf(
+        "SNAPSHOT: done with writing snapshot.  Took %g sec, total size %g MB, corresponds to effective I/O rate of %g MB/sec\n",
+        Logs.timediff(t0, t1), byte_count_all / (1024.0 * 1024.0), byte_count_all / (1024.0 * 1024.0) / Logs.timediff(t0, t1));
 
   All.Ti_lastoutput = All.Ti_Current;
 
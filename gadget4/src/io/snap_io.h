@@ -58,6 +58,14 @@ class snap_io : public IO_Def
   void *get_base_address_of_structure(enum arrays array, int index);
   int get_type_of_element(int index);
   void set_type_of_element(int index, int type);
+#ifdef SNAPSHOT_PHKEY_INDEX
+  bool has_phkey_index(void);
+  void get_unshifted_intpos_of_element(int index, MyIntPosType *intpos);
+  void convert_file_positions_to_intpos(void *buf, int n, MyIntPosType *intpos);
+  void set_selected_numbers_in_header(long long *nsel);
+
+  void set_read_selection(const char *fieldlist, const char *region);
+#endif
 
   /** Header for the standard file format.
    */
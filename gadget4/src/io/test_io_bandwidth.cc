@@ -53,6 +53,10 @@ void test_io_bandwidth::measure_io_bandwidth(void)
       All.MaxFilesWithConcurrentIO /= 2;
     }
 
+#ifdef ALLOW_HDF5_COMPRESSION
+  measure_compression();
+#endif
+
   mpi_printf("\n\nTEST: Completed.\n");
 
   fflush(stdout);
@@ -227,3 +231,197 @@ void test_io_bandwidth::byten_doit(void *x, size_t n, int modus)
   else
     my_fwrite(x, n, 1, fd);
 }
+
+#ifdef ALLOW_HDF5_COMPRESSION
+
+/*! \brief Measures the compression ratio and the effective write rate of the HDF5 filter pipelines
+ *
+ * Each task writes a file of its own with synthetic fields that resemble those of a snapshot: the IDs and integer coordinates of a
+ * perturbed lattice, velocities made of a smooth flow plus a random dispersion, and log-normally distributed densities. The
+ * particles are stored in Morton order, similar to the space-filling curve order of the particles in real snapshot files. Every
+ * field is written without filters, with the default shuffle+gzip compression, and with the policy that HDF5CompressionPolicy sets
+ * for it.
+ */
+void test_io_bandwidth::measure_compression(void)
+{
+  const int grid  = COMPRESSION_TEST_GRID;
+  const int npart = grid * grid * grid;
+
+  mpi_printf("\nTEST: Measuring HDF5 compression for %d synthetic particles per task\n", npart);
+
+  unsigned long long *id = (unsigned long long *)Mem.mymalloc("id", npart * sizeof(unsigned long long));
+  uint32_t *intpos       = (uint32_t *)Mem.mymalloc("intpos", 3 * npart * sizeof(uint32_t));
+  float *vel             = (float *)Mem.mymalloc("vel", 3 * npart * sizeof(float));
+  float *rho             = (float *)Mem.mymalloc("rho", npart * sizeof(float));
+
+  unsigned long long seed = 42 + ThisTask;
+  auto uniform            = [&seed](void) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return ((seed >> 11) + 0.5) / 9007199254740992.0;
+  };
+  auto gauss = [&uniform](void) { return sqrt(-2 * log(uniform())) * cos(2 * M_PI * uniform()); };
+
+  /* the subvolume of the box that is covered by the lattice of this task */
+  int sub[3] = {ThisTask % COMPRESSION_TEST_SUBVOLUMES, (ThisTask / COMPRESSION_TEST_SUBVOLUMES) % COMPRESSION_TEST_SUBVOLUMES,
+                (ThisTask / (COMPRESSION_TEST_SUBVOLUMES * COMPRESSION_TEST_SUBVOLUMES)) % COMPRESSION_TEST_SUBVOLUMES};
+
+  for(int n = 0; n < npart; n++)
+    {
+      int ijk[3] = {0, 0, 0};
+      for(int bit = 0; (1 << bit) < grid; bit++)
+        for(int k = 0; k < 3; k++)
+          ijk[k] |= ((n >> (3 * bit + k)) & 1) << bit;
+
+      id[n] = 1 + ijk[2] + grid * (ijk[1] + grid * (ijk[0] + (unsigned long long)grid * ThisTask));
+
+      for(int k = 0; k < 3; k++)
+        {
+          double pos        = (sub[k] + (ijk[k] + 0.5 + 0.2 * gauss()) / grid) / COMPRESSION_TEST_SUBVOLUMES;
+          intpos[3 * n + k] = (uint32_t)(pos * 4294967296.0);
+          vel[3 * n + k]    = 300.0 * sin(2 * M_PI * (ijk[(k + 1) % 3] + 0.5) / grid) + 50.0 * gauss();
+        }
+
+      rho[n] = exp(gauss());
+    }
+
+  char buf[MAXLEN_PATH_EXTRA];
+  snprintf(buf, MAXLEN_PATH_EXTRA, "%s/testdata/%s.%d.hdf5", All.OutputDir, "compression", ThisTask);
+
+  hid_t file = my_H5Fcreate(buf, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+  struct
+  {
+    const char *name;
+    hid_t datatype;
+    int values;
+    size_t bytes_per_value;
+    void *data;
+  } fields[4] = {{"ParticleIDs", H5T_NATIVE_ULLONG, 1, sizeof(unsigned long long), id},
+                 {"IntCoordinates", H5T_NATIVE_UINT32, 3, sizeof(uint32_t), intpos},
+                 {"Velocities", H5T_NATIVE_FLOAT, 3, sizeof(float), vel},
+                 {"Density", H5T_NATIVE_FLOAT, 1, sizeof(float), rho}};
+
+  for(int f = 0; f < 4; f++)
+    {
+      compression_policy policy;
+
+      policy.method = COMPRESSION_NONE;
+      policy.level  = 0;
+      write_compressed_field(file, fields[f].name, fields[f].datatype, fields[f].values, fields[f].bytes_per_value, fields[f].data,
+                             policy, "none");
+
+      policy.method = COMPRESSION_GZIP;
+      policy.level  = 9;
+      write_compressed_field(file, fields[f].name, fields[f].datatype, fields[f].values, fields[f].bytes_per_value, fields[f].data,
+                             policy, "gzip9");
+
+      policy = get_compression_policy(fields[f].name, true);
+      if(policy.method != COMPRESSION_GZIP || policy.level != 9)
+        write_compressed_field(file, fields[f].name, fields[f].datatype, fields[f].values, fields[f].bytes_per_value,
+                               fields[f].data, policy, "policy");
+    }
+
+  my_H5Fclose(file, buf);
+  unlink(buf);
+
+  Mem.myfree(rho);
+  Mem.myfree(vel);
+  Mem.myfree(intpos);
+  Mem.myfree(id);
+
+  MPI_Barrier(Communicator);
+}
+
+/*! \brief Writes one field with the given compression policy, and reports the compression ratio, write rate and maximum error
+ *
+ * \param file the HDF5 file to write to
+ * \param name name of the field
+ * \param datatype HDF5 type of the values, both in memory and in the file
+ * \param values number of values per particle
+ * \param bytes_per_value size of a single value
+ * \param data the field for all COMPRESSION_TEST_GRID^3 particles of this task
+ * \param policy the compression policy
+ * \param method label of the policy in the output
+ */
+void test_io_bandwidth::write_compressed_field(hid_t file, const char *name, hid_t datatype, int values, size_t bytes_per_value,
+                                               void *data, compression_policy policy, const char *method)
+{
+  hsize_t dims[2] = {(hsize_t)COMPRESSION_TEST_GRID * COMPRESSION_TEST_GRID * COMPRESSION_TEST_GRID, (hsize_t)values};
+  int rank        = (values == 1) ? 1 : 2;
+  size_t nvalues  = dims[0] * dims[1];
+  size_t nbytes   = nvalues * bytes_per_value;
+
+  char dname[MAXLEN_PATH];
+  snprintf(dname, MAXLEN_PATH, "%s_%s", name, method);
+
+  char *copy = (char *)Mem.mymalloc("copy", nbytes);
+  memcpy(copy, data, nbytes);
+
+  MPI_Barrier(Communicator);
+  double t0 = Logs.second();
+
+  if(policy.method == COMPRESSION_KEEPBITS)
+    round_mantissa_bits(copy, nvalues, bytes_per_value, policy.level);
+
+  hid_t dataspace = my_H5Screate_simple(rank, dims, NULL);
+  hid_t dataset;
+
+  if(policy.method != COMPRESSION_NONE)
+    {
+      hid_t prop = my_H5Pcreate_compressed(policy, datatype, rank, dims, dname);
+      dataset    = my_H5Dcreate(file, dname, datatype, dataspace, prop);
+      my_H5Pclose(prop);
+    }
+  else
+    dataset = my_H5Dcreate(file, dname, datatype, dataspace, H5P_DEFAULT);
+
+  my_H5Dwrite(dataset, datatype, H5S_ALL, H5S_ALL, H5P_DEFAULT, copy, dname);
+  H5Fflush(file, H5F_SCOPE_LOCAL);
+
+  double t1 = Logs.second();
+
+  /* read the field back to verify it, and to determine the largest relative error of the lossy methods */
+  my_H5Dread(dataset, datatype, H5S_ALL, H5S_ALL, H5P_DEFAULT, copy, dname);
+
+  double maxerr = 0;
+  for(size_t i = 0; i < nvalues; i++)
+    {
+      if(H5Tget_class(datatype) == H5T_FLOAT)
+        {
+          double orig = ((float *)data)[i];
+          double err  = fabs(((float *)copy)[i] - orig) / (fabs(orig) + 1.0e-30);
+          if(err > maxerr)
+            maxerr = err;
+        }
+      else if(memcmp(copy + i * bytes_per_value, (char *)data + i * bytes_per_value, bytes_per_value) != 0)
+        Terminate("TEST: dataset '%s' was not restored exactly", dname);
+    }
+
+  double stored = H5Dget_storage_size(dataset);
+
+  my_H5Dclose(dataset, dname);
+  my_H5Sclose(dataspace, H5S_SIMPLE);
+
+  Mem.myfree(copy);
+
+  double loc[2] = {(double)nbytes, stored}, sum[2];
+  MPI_Allreduce(loc, sum, 2, MPI_DOUBLE, MPI_SUM, Communicator);
+
+  double dt = Logs.timediff(t0, t1), dtmax, maxerr_all;
+  MPI_Allreduce(&dt, &dtmax, 1, MPI_DOUBLE, MPI_MAX, Communicator);
+  MPI_Allreduce(&maxerr, &maxerr_all, 1, MPI_DOUBLE, MPI_MAX, Communicator);
+
+  static const char *method_names[] = {"none", "gzip", "lz4", "zstd", "keepbits", "delta"};
+
+  char label[100];
+  if(policy.level > 0)
+    snprintf(label, 100, "%s%d", method_names[policy.method], policy.level);
+  else
+    snprintf(label, 100, "%s", method_names[policy.method]);
+
+  mpi_printf("TEST: %-14s  %-6s %-10s  raw %8.2f MB  stored %8.2f MB  ratio %6.2f  effective rate %9.1f MB/sec  max. rel. error %g\n",
+             name, method, label, sum[0] / (1024.0 * 1024.0), sum[1] / (1024.0 * 1024.0), sum[0] / (sum[1] + 1.0e-30),
+             sum[0] / (1024.0 * 1024.0) / (dtmax + 1.0e-30), maxerr_all);
+}
+
+#endif
@@ -23,6 +23,10 @@
 
 #define BLKSIZE (1024 * 1024)
 
+#define COMPRESSION_TEST_GRID 64     /* particles per dimension of the synthetic lattice of each task in the compression test */
+#define COMPRESSION_TEST_SUBVOLUMES 8 /* the lattice of each task fills one of 8^3 subvolumes of the box, like a snapshot file */
+
+#include "../io/hdf5_util.h"
 #include "../io/io_streamcount.h"
 
 class test_io_bandwidth : public io_streamcount, public virtual setcomm
@@ -65,6 +69,12 @@ class test_io_bandwidth : public io_streamcount, public virtual setcomm
   void write_test_data(void);
   void byten(void *x, size_t n, int modus);
   void byten_doit(void *x, size_t n, int modus);
+
+#ifdef ALLOW_HDF5_COMPRESSION
+  void measure_compression(void);
+  void write_compressed_field(hid_t file, const char *name, hid_t datatype, int values, size_t bytes_per_value, void *data,
+                              compression_policy policy, const char *method);
+#endif
 };
 
 #endif
@@ -1137,17 +1137,8 @@ void lightcone::lightcone_massmap_binning(void)
   if(Mp->NumPart + nimport > Mp->MaxPart)
     Mp->reallocate_memory_maxpart(Mp->NumPart + nimport);
 
-  for(int ngrp = 1; ngrp < (1 << PTask); ngrp++)
-    {
-      int recvTask = ThisTask ^ ngrp;
-
-      if(recvTask < NTask)
-        if(Send_count[recvTask] > 0 || Recv_count[recvTask] > 0)
-          myMPI_Sendrecv(&send_P[Send_offset[recvTask]], Send_count[recvTask] * sizeof(lightcone_massmap_data), MPI_BYTE, recvTask,
-                         TAG_DENS_A, &Mp->P[Mp->NumPart + Recv_offset[recvTask]],
-                         Recv_count[recvTask] * sizeof(lightcone_massmap_data), MPI_BYTE, recvTask, TAG_DENS_A, Communicator,
-                         MPI_STATUS_IGNORE);
-    }
+  myMPI_Sparse_alltoallv(send_P, Send_count, Send_offset, Mp->P + Mp->NumPart, Recv_count, Recv_offset, sizeof(lightcone_massmap_data),
+                         TAG_DENS_A, Communicator);
 
   Mp->NumPart += nimport;
 
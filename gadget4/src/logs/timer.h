@@ -80,6 +80,9 @@ TIMER_CREATE(CPU_LOGS, "logs", CPU_ALL, 'K', 'k')
 #if defined(COOLING) || defined(STARFORMATION)
 TIMER_CREATE(CPU_COOLING_SFR, "sfrcool", CPU_ALL, '1', 'T')
 #endif
+#ifdef COOLING_EQUILIBRIUM_TABLE
+TIMER_CREATE(CPU_COOLING_TABLE, "cooltable", CPU_COOLING_SFR, 'u', 'U')
+#endif
 #ifdef FOF
 TIMER_CREATE(CPU_FOF, "fof", CPU_ALL, '5', 'D')
 TIMER_CREATE(CPU_FOFWALK, "fofwalk", CPU_FOF, '6', 'G')
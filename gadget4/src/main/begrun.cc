@@ -33,6 +33,7 @@
 #include "../gitversion/version.h"
 #include "../gravity/ewald.h"
 #include "../gravtree/gravtree.h"
+#include "../io/async_write.h"
 #include "../io/hdf5_util.h"
 #include "../io/io.h"
 #include "../io/parameters.h"
@@ -211,6 +212,10 @@ void sim::begrun1(const char *parameterFile)
   my_create_HDF5_halfprec_handler();
   my_create_HDF5_special_integer_types();
 
+#ifdef ALLOW_HDF5_COMPRESSION
+  report_compression_filters(ThisTask == 0);
+#endif
+
   my_mpi_types_init();
 
 #ifdef LIGHTCONE_PARTICLES
@@ -423,6 +428,10 @@ void sim::set_units(void)
  */
 void sim::endrun(void)
 {
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+  AsyncWrite.wait(); /* make sure that the last snapshot is complete */
+#endif
+
   mpi_printf("endrun called, calling MPI_Finalize()\nbye!\n\n");
   fflush(stdout);
 
@@ -23,6 +23,7 @@
 #include "../data/allvars.h"
 #include "../data/dtypes.h"
 #include "../half/half.hpp"
+#include "../io/async_write.h"
 #include "../io/io.h"
 #include "../io/restart.h"
 #include "../io/snap_io.h"
@@ -43,6 +44,9 @@ ewald Ewald; /* get an instance of the Ewald correction tables */
 logs Logs;
 memory Mem; /* our instance of the memory object */
 shmem Shmem;
+#ifdef ASYNC_SNAPSHOT_OUTPUT
+async_write AsyncWrite; /* writes snapshot files in the background */
+#endif
 
 /*!
  *  This function initializes the MPI communication packages, and sets
@@ -60,7 +64,15 @@ int main(int argc, char **argv)
   Pin.get_core_set();
 
   /* initialize MPI, this may already impose some pinning */
+#if(THREADS_PER_MPI_RANK > 1) || defined(ASYNC_SNAPSHOT_OUTPUT)
+  /* only the master thread of each task makes MPI calls, the worker threads never do */
+  int provided;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  if(provided < MPI_THREAD_FUNNELED)
+    Terminate("THREADS_PER_MPI_RANK and ASYNC_SNAPSHOT_OUTPUT require an MPI library that supports MPI_THREAD_FUNNELED");
+#else
   MPI_Init(&argc, &argv);
+#endif
 
   MPI_Comm_rank(MPI_COMM_WORLD, &Shmem.World_ThisTask);
   MPI_Comm_size(MPI_COMM_WORLD, &Shmem.World_NTask);
@@ -192,6 +204,7 @@ int main(int argc, char **argv)
                  RST_LCREARRANGE);
           printf("      %2d          Rearrange most-bound snapshot data in merger tree order <firstnum>  <lastnum>\n",
                  RST_SNPREARRANGE);
+          printf("      %2d          Measure drift/kick throughput of different particle storage layouts\n", RST_LAYOUTTEST);
           printf("\n");
         }
       Sim.endrun();
@@ -275,6 +288,12 @@ int main(int argc, char **argv)
           Sim.endrun();
         }
 
+      if(All.RestartFlag == RST_LAYOUTTEST)
+        {
+          Sim.measure_particle_layout();
+          Sim.endrun();
+        }
+
       if(All.RestartFlag == RST_LCREARRANGE)
         {
 #if defined(LIGHTCONE) && defined(LIGHTCONE_PARTICLES) && defined(REARRANGE_OPTION)
@@ -303,6 +322,9 @@ int main(int argc, char **argv)
         {
           snap_io Snap(&Sim.Sp, Sim.Communicator, All.ICFormat); /* get an I/O object */
 
+#ifdef SNAPSHOT_PHKEY_INDEX
+          Snap.set_read_selection(All.SnapshotReadFields, All.SnapshotReadRegion);
+#endif
           Snap.read_ic(fname);
         }
 
@@ -55,6 +55,9 @@ void sim::run(void)
   Snap.write_snapshot(All.SnapshotFileCount, NORMAL_SNAPSHOT); /* write snapshot file */
 #if defined(POWERSPEC_ON_OUTPUT)
   PM.calculate_power_spectra(All.SnapshotFileCount);
+#endif
+#if defined(DENSITYGRID_ON_OUTPUT)
+  PM.write_density_grids(All.SnapshotFileCount);
 #endif
   return;
 #endif
@@ -112,6 +115,9 @@ void sim::run(void)
       /* for sufficiently large steps, carry out a new domain decomposition */
       if(All.HighestActiveTimeBin >= All.SmallestTimeBinWithDomainDecomposition)
         {
+#ifdef GRAVITY_TREE_REUSE
+          gravity_free_kept_tree();
+#endif
           NgbTree.treefree();
           Domain.domain_free();
 
@@ -200,6 +206,11 @@ void sim::run(void)
       /* update the neighbor tree with the new velocities */
       NgbTree.update_velocities();
 
+#ifdef DOMAIN_MEASURED_COST_MODEL
+      /* record the time spent per particle on this step for the cost model of the domain decomposition */
+      Domain.domain_measure_step_cost();
+#endif
+
       /* output some CPU usage log-info (accounts for everything needed up to complete the previous timestep) */
       Logs.write_cpu_log();
 
@@ -522,6 +533,11 @@ void sim::create_snapshot_if_desired(void)
           if(Sp.P[i].Ti_Current != All.Ti_Current)
             Terminate("P[i].Ti_Current != All.Ti_Current");
 
+#ifdef GRAVITY_TREE_REUSE
+        /* the particles may be reordered and exchanged for the output, hence the kept gravity tree has to go */
+        gravity_free_kept_tree();
+#endif
+
 #if defined(STARFORMATION) && defined(FOF)
         // do an extra domain decomposition here to make sure that there are no new stars among the block of gas particles
         NgbTree.treefree();
@@ -615,6 +631,10 @@ void sim::create_snapshot_if_desired(void)
         PM.calculate_power_spectra(All.SnapshotFileCount);
 #endif
 
+#if defined(DENSITYGRID_ON_OUTPUT) && defined(PERIODIC) && defined(PMGRID)
+        PM.write_density_grids(All.SnapshotFileCount);
+#endif
+
         All.SnapshotFileCount++;
         All.Ti_nextoutput = find_next_outputtime(All.Ti_Current + 1);
 
@@ -45,11 +45,12 @@
 #include "../pm/pm.h"
 #include "../sph/sph.h"
 #include "../system/pinning.h"
+#include "../time_integration/test_particle_layout.h"
 
-class sim : public pinning, public test_io_bandwidth
+class sim : public pinning, public test_io_bandwidth, public test_particle_layout
 {
  public:
-  sim(MPI_Comm comm) : setcomm(comm), test_io_bandwidth(comm) {}
+  sim(MPI_Comm comm) : setcomm(comm), test_io_bandwidth(comm), test_particle_layout(comm) {}
 
   /* here come the main classes the code operates on */
 
@@ -168,6 +169,9 @@ class sim : public pinning, public test_io_bandwidth
   void gravity_comoving_factors(int timebin);
   void gravity_pm(int timebin);
   void gravity_set_oldacc(int timebin);
+#ifdef GRAVITY_TREE_REUSE
+  void gravity_free_kept_tree(void);
+#endif
 
   void hydro_force(int step_indicator);
   void compute_grav_accelerations(int timebin);
@@ -17,6 +17,7 @@
 #include "../domain/domain.h"
 #include "../logs/logs.h"
 #include "../mpi_utils/mpi_utils.h"
+#include "../system/worker_threads.h"
 
 #define EXTRA_SPACE 16384
 
@@ -696,6 +697,48 @@ class generic_comm
     return iter;
   }
 
+  /* Processes the particles in the list with nthreads threads, which share them out with a work-stealing scheduler. This is only
+   * possible if the communicator consists of a single task, such that nothing can ever be exported, and if evaluate() and
+   * out2particle() are safe to call concurrently for different targets.
+   */
+  void execute_local_threads(int nactive, int *targetlist, int nthreads)
+  {
+    if(D->NTask != 1)
+      Terminate("execute_local_threads() can only be used on a single task, but D->NTask=%d", D->NTask);
+
+    generic_allocate_comm_tables();
+
+    if(cpu_primary != logs::CPU_NONE)
+      Logs.timer_start(cpu_primary);
+
+    workstealing_scheduler sched;
+    sched.init(nactive, nthreads);
+
+    run_worker_threads(nthreads, [this, targetlist, &sched](int thread) {
+      int idx;
+      while(sched.get_next(thread, idx))
+        {
+          int i = targetlist[idx];
+          if(i < 0)
+            continue;
+
+          T_in local;
+          T_out out;
+          particle2in(&local, i);
+          local.Firstnode = 0;
+
+          evaluate(i, MODE_LOCAL_PARTICLES, thread, MODE_DEFAULT, &local, 1, NULL, out);
+
+          out2particle(&out, i, MODE_LOCAL_PARTICLES);
+        }
+    });
+
+    if(cpu_primary != logs::CPU_NONE)
+      Logs.timer_stop(cpu_primary);
+
+    generic_free_comm_tables();
+  }
+
   int execute(int nactive, int *targetlist, int action, enum logs::timers a, enum logs::timers b, enum logs::timers c)
   {
     cpu_primary   = a;
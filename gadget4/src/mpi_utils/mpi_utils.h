@@ -106,6 +106,9 @@
 #define TAG_FETCH_SPH_HYDRO 3000
 #define TAG_FETCH_SPH_TREETIMESTEP 4000
 
+/*!< maximum number of partners of a task for which myMPI_Sparse_alltoallv() posts all messages at once */
+#define SPARSE_ALLTOALLV_MAX_PARTNERS 64
+
 void my_mpi_types_init(void);
 
 int myMPI_Sendrecv(void *sendbuf, size_t sendcount, MPI_Datatype sendtype, int dest, int sendtag, void *recvbuf, size_t recvcount,
@@ -116,6 +119,9 @@ int myMPI_Alltoallv_new_prep(int *sendcnt, int *recvcnt, int *rdispls, MPI_Comm
 void myMPI_Alltoallv_new(void *sendb, int *sendcounts, int *sdispls, MPI_Datatype sendtype, void *recvb, int *recvcounts, int *rdispls,
                          MPI_Datatype recvtype, MPI_Comm comm, int method);
 
+void myMPI_Sparse_alltoallv(void *sendb, int *sendcounts, int *sdispls, void *recvb, int *recvcounts, int *rdispls, size_t len,
+                            int tag, MPI_Comm comm);
+
 void myMPI_Alltoallv(void *sendbuf, size_t *sendcounts, size_t *sdispls, void *recvbuf, size_t *recvcounts, size_t *rdispls, int len,
                      int big_flag, MPI_Comm comm);
 
@@ -39,7 +39,7 @@ int myMPI_Alltoallv_new_prep(int *sendcnt, int *recvcnt, int *rdispls, MPI_Comm
   MPI_Comm_size(comm, &nranks);
   MPI_Comm_rank(comm, &rank);
 
-  if(method == 0 || method == 1)
+  if(method == 0 || method == 1 || method == 3)
     myMPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, comm);
   else if(method == 10)
     {
@@ -141,6 +141,16 @@ void myMPI_Alltoallv_new(void *sendbuf, int *sendcnt, int *sdispls, MPI_Datatype
       MPI_Waitall(n_requests, requests, MPI_STATUSES_IGNORE);
       Mem.myfree(requests);
     }
+  else if(method == 3)  // non-blocking communication with only those tasks that have data
+    {
+      if(sendtype != recvtype)
+        Terminate("bad MPI communication types");
+
+      if(recvcnt[rank] > 0)  // local communication
+        memcpy(PCHAR(recvbuf) + tsz * rdispls[rank], PCHAR(sendbuf) + tsz * sdispls[rank], tsz * recvcnt[rank]);
+
+      myMPI_Sparse_alltoallv(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, tsz, 42, comm);
+    }
   else if(method == 10)
     {
       if(sendtype != recvtype)
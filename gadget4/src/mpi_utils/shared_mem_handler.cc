@@ -157,8 +157,8 @@ void shmem::shared_memory_handler(void)
           size_t tab_len = *((size_t *)message);
           Mem.myfree(message);
 
+          // the simulation ranks of the node fill in the table directly through shared memory
           EwaldData = (char *)Mem.mymalloc("table", tab_len);
-          MPI_Recv(EwaldData, tab_len, MPI_BYTE, source, TAG_DMOM, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
           ptrdiff_t off = ((char *)EwaldData - Mem.Base);
           MPI_Bcast(&off, sizeof(ptrdiff_t), MPI_BYTE, Island_ThisTask, SharedMemComm);
         }
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ * \copyright   This file is part of the GADGET4 N-body/SPH code developed
+ * \copyright   by Volker Springel. Copyright (C) 2014-2020 by Volker Springel
+ * \copyright   (vspringel@mpa-garching.mpg.de) and all contributing authors.
+ *******************************************************************************/
+
+/*! \file  sparse_alltoallv.cc
+ *
+ *  \brief implements a personalized all-to-all exchange that only communicates with the tasks that actually exchange data
+ */
+
+#include "gadgetconfig.h"
+
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "../data/allvars.h"
+#include "../data/dtypes.h"
+#include "../data/mymalloc.h"
+#include "../mpi_utils/mpi_utils.h"
+
+/*! \brief Posts the non-blocking sends or receives for one message, split into pieces of at most MPI_MESSAGE_SIZELIMIT_IN_BYTES
+ *
+ *  \return the number of requests that were posted
+ */
+static int sparse_alltoallv_post(bool send, char *buf, size_t nbytes, int task, int tag, MPI_Comm comm, MPI_Request *requests)
+{
+  int nreq = 0;
+
+  while(nbytes > 0)
+    {
+      int nnow = std::min<size_t>(nbytes, MPI_MESSAGE_SIZELIMIT_IN_BYTES);
+
+      if(send)
+        MPI_Isend(buf, nnow, MPI_BYTE, task, tag, comm, &requests[nreq++]);
+      else
+        MPI_Irecv(buf, nnow, MPI_BYTE, task, tag, comm, &requests[nreq++]);
+
+      nbytes -= nnow;
+      buf += nnow;
+    }
+
+  return nreq;
+}
+
+static inline int sparse_alltoallv_npieces(size_t nbytes)
+{
+  return (nbytes + MPI_MESSAGE_SIZELIMIT_IN_BYTES - 1) / MPI_MESSAGE_SIZELIMIT_IN_BYTES;
+}
+
+/*! \brief Exchanges data between all pairs of tasks that have something to send or receive
+ *
+ *  This replaces the loops over the hypercube partners `ThisTask ^ ngrp` with a blocking myMPI_Sendrecv() in each step, which
+ *  serialize the exchange in O(NTask) steps even if a task only has a handful of partners. Here, all receives and sends
+ *  for the tasks with non-zero counts are posted as non-blocking requests and completed together. Which scheme is used
+ *  depends on the maximum number of partners of any task: if this is at most SPARSE_ALLTOALLV_MAX_PARTNERS, all messages
+ *  are in flight at once. Otherwise the hypercube pattern is retained, but SPARSE_ALLTOALLV_MAX_PARTNERS of its steps are
+ *  combined into one window of non-blocking requests, which bounds the number of outstanding messages. Since the two
+ *  tasks of a pair always meet in the same window, this cannot deadlock.
+ *
+ *  The counts and offsets are given in units of len bytes, and the receive counts have to be known already. The transfer
+ *  of a task to itself is not carried out, callers are expected to deal with local data themselves. The send and receive
+ *  buffers must not overlap.
+ *
+ *  \param sendb buffer with the data to send
+ *  \param sendcounts number of elements to send to each task
+ *  \param sdispls offsets of the data for each task in the send buffer
+ *  \param recvb buffer for the received data
+ *  \param recvcounts number of elements to receive from each task
+ *  \param rdispls offsets of the data from each task in the receive buffer
+ *  \param len size of one element in bytes
+ *  \param tag MPI tag used for the messages
+ *  \param comm communicator
+ */
+void myMPI_Sparse_alltoallv(void *sendb, int *sendcounts, int *sdispls, void *recvb, int *recvcounts, int *rdispls, size_t len,
+                            int tag, MPI_Comm comm)
+{
+  char *sendbuf = (char *)sendb;
+  char *recvbuf = (char *)recvb;
+
+  int ntask, thistask, ptask;
+  MPI_Comm_size(comm, &ntask);
+  MPI_Comm_rank(comm, &thistask);
+
+  for(ptask = 0; ntask > (1 << ptask); ptask++)
+    ;
+
+  int npartners = 0, nrequests = 0;
+
+  for(int task = 0; task < ntask; task++)
+    if(task != thistask && (sendcounts[task] > 0 || recvcounts[task] > 0))
+      {
+        npartners++;
+        nrequests += sparse_alltoallv_npieces(sendcounts[task] * len) + sparse_alltoallv_npieces(recvcounts[task] * len);
+      }
+
+  int maxpartners;
+  MPI_Allreduce(&npartners, &maxpartners, 1, MPI_INT, MPI_MAX, comm);
+
+  if(maxpartners == 0)
+    return;
+
+  int window = (maxpartners <= SPARSE_ALLTOALLV_MAX_PARTNERS) ? (1 << ptask) : SPARSE_ALLTOALLV_MAX_PARTNERS;
+
+  MPI_Request *requests = (MPI_Request *)Mem.mymalloc("requests", std::max<int>(nrequests, 1) * sizeof(MPI_Request));
+
+  for(int ngrp_start = 1; ngrp_start < (1 << ptask); ngrp_start += window)
+    {
+      int ngrp_end = std::min<int>(ngrp_start + window, 1 << ptask);
+      int nreq     = 0;
+
+      for(int ngrp = ngrp_start; ngrp < ngrp_end; ngrp++)
+        {
+          int task = thistask ^ ngrp;
+
+          if(task < ntask && recvcounts[task] > 0)
+            nreq += sparse_alltoallv_post(false, recvbuf + rdispls[task] * len, recvcounts[task] * len, task, tag, comm,
+                                          &requests[nreq]);
+        }
+
+      for(int ngrp = ngrp_start; ngrp < ngrp_end; ngrp++)
+        {
+          int task = thistask ^ ngrp;
+
+          if(task < ntask && sendcounts[task] > 0)
+            nreq += sparse_alltoallv_post(true, sendbuf + sdispls[task] * len, sendcounts[task] * len, task, tag, comm,
+                                          &requests[nreq]);
+        }
+
+      MPI_Waitall(nreq, requests, MPI_STATUSES_IGNORE);
+    }
+
+  Mem.myfree(requests);
+}
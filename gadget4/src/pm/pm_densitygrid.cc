@@ -0,0 +1,482 @@
+/*******************************************************************************
+ * \copyright   This file is part of the GADGET4 N-body/SPH code developed
+ * \copyright   by Volker Springel. Copyright (C) 2014-2020 by Volker Springel
+ * \copyright   (vspringel@mpa-garching.mpg.de) and all contributing authors.
+ *******************************************************************************/
+
+/*! \file  pm_densitygrid.cc
+ *
+ *  \brief deposits selected fields onto uniform grids and writes them as raw binary files at output times
+ */
+
+#include "gadgetconfig.h"
+
+#if defined(PMGRID) && defined(PERIODIC) && defined(DENSITYGRID_ON_OUTPUT)
+
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <algorithm>
+
+#include "../data/allvars.h"
+#include "../data/dtypes.h"
+#include "../data/intposconvert.h"
+#include "../data/mymalloc.h"
+#include "../logs/logs.h"
+#include "../mpi_utils/mpi_utils.h"
+#include "../pm/pm.h"
+#include "../pm/pm_periodic.h"
+#include "../sph/kernel.h"
+#include "../system/system.h"
+
+/*! These routines replace the post-processing step in which snapshots were re-read to deposit gas densities onto a uniform grid.
+ *  When a snapshot is written, each field listed in the DensityGridFields parameter is deposited onto a grid with
+ *  DensityGridResolution cells per dimension that spans the whole periodic box. The grid is written as a raw file of little-endian
+ *  4-byte floats in Fortran order, i.e. with the x-index running fastest, to OutputDir/grids/<field>/<snapshot number>.raw.
+ *
+ *  As for the PM force computation, the grid is distributed in slabs across the MPI tasks, and the particle data is sent to the
+ *  tasks holding the slabs a particle contributes to. Here the slabs are cut along the z-axis, such that the part of the grid held by
+ *  a task forms one contiguous block of the output file, which each task then writes directly.
+ *
+ *  The gas fields are SPH interpolants evaluated at the cell centers, i.e. a cell receives m_j / rho_j * A_j * W(r, h_j) from every
+ *  gas particle j whose kernel reaches the cell center, and particles whose kernel does not reach any cell center are assigned to
+ *  the nearest cell. The matter density is obtained by CIC or TSC assignment of the masses of all particle types. Densities are
+ *  written in physical g/cm^3, and specific energies in (cm/s)^2.
+ */
+
+static const char *densitygrid_field_names[] = {"GasDensity", "GasInternalEnergy", "MatterDensityCIC", "MatterDensityTSC"};
+
+/*! This function checks and stores the list of fields that is requested with the DensityGridFields parameter. The fields are
+ *  given as a comma-separated list without blanks.
+ */
+void pm_periodic::densitygrid_parse_fields(void)
+{
+  if(All.DensityGridResolution < 1)
+    Terminate("DensityGridResolution=%d, but it needs to be at least 1", All.DensityGridResolution);
+
+  char buf[MAXLEN_PATH];
+  strncpy(buf, All.DensityGridFields, MAXLEN_PATH - 1);
+  buf[MAXLEN_PATH - 1] = 0;
+
+  DensityGridNumFields = 0;
+
+  for(char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ","))
+    {
+      int field = 0;
+      while(field < GRID_NFIELDS && strcmp(tok, densitygrid_field_names[field]) != 0)
+        field++;
+
+      if(field == GRID_NFIELDS)
+        Terminate("unknown field '%s' in DensityGridFields, known are GasDensity, GasInternalEnergy, MatterDensityCIC, MatterDensityTSC",
+                  tok);
+
+      for(int n = 0; n < DensityGridNumFields; n++)
+        if(DensityGridFieldList[n] == field)
+          Terminate("field '%s' is listed more than once in DensityGridFields", tok);
+
+      DensityGridFieldList[DensityGridNumFields++] = field;
+    }
+}
+
+/*! Gives the range of cell indices along dimension 'dim' that a particle contributes to for the given field. The indices are not
+ *  yet mapped into the periodic box.
+ */
+void pm_periodic::densitygrid_get_cell_range(int field, gridpart_data *gp, int dim, double *cellsize, int ngrid, int *lo, int *hi)
+{
+  double x = gp->Pos[dim];
+
+  if(field == GRID_MATTER_DENSITY_CIC)
+    {
+      *lo = (int)floor(x);
+      *hi = *lo + 1;
+    }
+  else if(field == GRID_MATTER_DENSITY_TSC)
+    {
+      int cell = (int)floor(x + 0.5);
+      *lo      = cell - 1;
+      *hi      = cell + 1;
+    }
+  else if(gp->Hsml > 0)
+    {
+      double hcells = gp->Hsml / cellsize[dim];
+
+      *lo = (int)ceil(x - hcells);
+      *hi = (int)floor(x + hcells);
+
+      if(*hi - *lo >= ngrid) /* the kernel is larger than the box, make sure that we visit every cell only once */
+        *hi = *lo + ngrid - 1;
+    }
+  else
+    {
+      *lo = (int)floor(x + 0.5);
+      *hi = *lo;
+    }
+}
+
+/*! Fills in the data of particle i that is needed to deposit the given field. Returns false if the particle does not contribute to
+ *  the field.
+ */
+bool pm_periodic::densitygrid_get_particle(int field, int i, double *cellsize, gridpart_data *gp)
+{
+  if(field == GRID_GAS_DENSITY || field == GRID_GAS_INTERNAL_ENERGY)
+    {
+      if(Sp->P[i].getType() != 0 || Sp->SphP[i].Density <= 0)
+        return false;
+
+      gp->Hsml = Sp->SphP[i].get_Hsml();
+
+      if(field == GRID_GAS_DENSITY)
+        gp->Value = Sp->P[i].getMass();
+      else
+        gp->Value = Sp->P[i].getMass() / Sp->SphP[i].Density * Sp->get_utherm_from_entropy(i);
+    }
+  else
+    {
+      gp->Hsml  = 0;
+      gp->Value = Sp->P[i].getMass();
+    }
+
+  double pos[3];
+  Sp->intpos_to_pos(Sp->P[i].IntPos, pos);
+
+  for(int j = 0; j < 3; j++)
+    gp->Pos[j] = pos[j] / cellsize[j] - 0.5;
+
+  /* if the kernel is so small that it may not reach the center of any cell, check this explicitly, and assign the particle to the
+   * nearest cell in case it doesn't
+   */
+  if(gp->Hsml > 0 && gp->Hsml < 0.5 * sqrt(cellsize[0] * cellsize[0] + cellsize[1] * cellsize[1] + cellsize[2] * cellsize[2]))
+    {
+      int lo[3], hi[3];
+      for(int j = 0; j < 3; j++)
+        densitygrid_get_cell_range(field, gp, j, cellsize, All.DensityGridResolution, &lo[j], &hi[j]);
+
+      double h2 = gp->Hsml * gp->Hsml;
+      bool reached = false;
+
+      for(int z = lo[2]; z <= hi[2] && !reached; z++)
+        for(int y = lo[1]; y <= hi[1] && !reached; y++)
+          for(int x = lo[0]; x <= hi[0] && !reached; x++)
+            {
+              double dx = (x - gp->Pos[0]) * cellsize[0];
+              double dy = (y - gp->Pos[1]) * cellsize[1];
+              double dz = (z - gp->Pos[2]) * cellsize[2];
+
+              if(dx * dx + dy * dy + dz * dz < h2)
+                reached = true;
+            }
+
+      if(!reached)
+        gp->Hsml = 0;
+    }
+
+  return true;
+}
+
+/*! Deposits the given field onto the local slabs 'firstslab' to 'firstslab + nslab - 1' of a grid with ngrid^3 cells. The local
+ *  part of the grid is stored with the x-index running fastest.
+ */
+void pm_periodic::densitygrid_deposit(int field, int ngrid, int *slab_to_task, int firstslab, int nslab, double *grid)
+{
+  double cellsize[3] = {All.BoxSize / LONG_X / ngrid, All.BoxSize / LONG_Y / ngrid, All.BoxSize / LONG_Z / ngrid};
+  double cellvol     = cellsize[0] * cellsize[1] * cellsize[2];
+
+  size_t *send_count  = (size_t *)Mem.mymalloc("send_count", NTask * sizeof(size_t));
+  size_t *send_offset = (size_t *)Mem.mymalloc("send_offset", NTask * sizeof(size_t));
+  size_t *recv_count  = (size_t *)Mem.mymalloc("recv_count", NTask * sizeof(size_t));
+  size_t *recv_offset = (size_t *)Mem.mymalloc("recv_offset", NTask * sizeof(size_t));
+  int *last_sent      = (int *)Mem.mymalloc("last_sent", NTask * sizeof(int));
+
+  gridpart_data *partin = NULL, *partout = NULL;
+  size_t nimport = 0, nexport = 0;
+
+  /* determine which slabs each particle contributes to, and send it once to every task that holds one of these slabs */
+  for(int rep = 0; rep < 2; rep++)
+    {
+      for(int task = 0; task < NTask; task++)
+        {
+          send_count[task] = 0;
+          last_sent[task]  = -1;
+        }
+
+      for(int i = 0; i < Sp->NumPart; i++)
+        {
+          gridpart_data gp;
+
+          if(!densitygrid_get_particle(field, i, cellsize, &gp))
+            continue;
+
+          int lo, hi;
+          densitygrid_get_cell_range(field, &gp, 2, cellsize, ngrid, &lo, &hi);
+
+          for(int z = lo; z <= hi; z++)
+            {
+              int task = slab_to_task[((z % ngrid) + ngrid) % ngrid];
+
+              if(last_sent[task] == i)
+                continue;
+
+              last_sent[task] = i;
+
+              if(rep == 0)
+                send_count[task]++;
+              else
+                partout[send_offset[task] + send_count[task]++] = gp;
+            }
+        }
+
+      if(rep == 0)
+        {
+          myMPI_Alltoall(send_count, sizeof(size_t), MPI_BYTE, recv_count, sizeof(size_t), MPI_BYTE, Communicator);
+
+          nimport = 0, nexport = 0, recv_offset[0] = 0, send_offset[0] = 0;
+          for(int j = 0; j < NTask; j++)
+            {
+              nexport += send_count[j];
+              nimport += recv_count[j];
+
+              if(j > 0)
+                {
+                  send_offset[j] = send_offset[j - 1] + send_count[j - 1];
+                  recv_offset[j] = recv_offset[j - 1] + recv_count[j - 1];
+                }
+            }
+
+          partin  = (gridpart_data *)Mem.mymalloc_movable(&partin, "partin", nimport * sizeof(gridpart_data));
+          partout = (gridpart_data *)Mem.mymalloc("partout", nexport * sizeof(gridpart_data));
+        }
+    }
+
+  /* produce a flag if any of the send sizes is above our transfer limit, in this case we will
+   * transfer the data in chunks.
+   */
+  int flag_big = 0, flag_big_all;
+  for(int i = 0; i < NTask; i++)
+    if(send_count[i] * sizeof(gridpart_data) > MPI_MESSAGE_SIZELIMIT_IN_BYTES)
+      flag_big = 1;
+
+  MPI_Allreduce(&flag_big, &flag_big_all, 1, MPI_INT, MPI_MAX, Communicator);
+
+  myMPI_Alltoallv(partout, send_count, send_offset, partin, recv_count, recv_offset, sizeof(gridpart_data), flag_big_all,
+                  Communicator);
+
+  Mem.myfree(partout);
+
+  /* now deposit the imported particles onto the local slabs */
+  for(size_t n = 0; n < nimport; n++)
+    {
+      gridpart_data *gp = &partin[n];
+
+      int lo[3], hi[3];
+      double w[3][3];
+
+      for(int j = 0; j < 3; j++)
+        {
+          densitygrid_get_cell_range(field, gp, j, cellsize, ngrid, &lo[j], &hi[j]);
+
+          if(field == GRID_MATTER_DENSITY_CIC)
+            {
+              double f = gp->Pos[j] - lo[j];
+              w[j][0]  = 1 - f;
+              w[j][1]  = f;
+            }
+          else if(field == GRID_MATTER_DENSITY_TSC)
+            {
+              double d = gp->Pos[j] - (lo[j] + 1);
+              w[j][0]  = 0.5 * (0.5 - d) * (0.5 - d);
+              w[j][1]  = 0.75 - d * d;
+              w[j][2]  = 0.5 * (0.5 + d) * (0.5 + d);
+            }
+          else
+            w[j][0] = 1;
+        }
+
+      double h2 = gp->Hsml * gp->Hsml, hinv = 0, hinv3 = 0, hinv4 = 0;
+      if(gp->Hsml > 0)
+        kernel_hinv(gp->Hsml, &hinv, &hinv3, &hinv4);
+
+      for(int z = lo[2]; z <= hi[2]; z++)
+        {
+          int zz = ((z % ngrid) + ngrid) % ngrid;
+
+          if(zz < firstslab || zz >= firstslab + nslab)
+            continue;
+
+          for(int y = lo[1]; y <= hi[1]; y++)
+            {
+              int yy = ((y % ngrid) + ngrid) % ngrid;
+
+              for(int x = lo[0]; x <= hi[0]; x++)
+                {
+                  int xx = ((x % ngrid) + ngrid) % ngrid;
+
+                  size_t idx = (((size_t)(zz - firstslab)) * ngrid + yy) * ngrid + xx;
+
+                  if(gp->Hsml > 0)
+                    {
+                      double dx = (x - gp->Pos[0]) * cellsize[0];
+                      double dy = (y - gp->Pos[1]) * cellsize[1];
+                      double dz = (z - gp->Pos[2]) * cellsize[2];
+                      double r2 = dx * dx + dy * dy + dz * dz;
+
+                      if(r2 < h2)
+                        {
+                          double wk, dwk;
+                          kernel_main(sqrt(r2) * hinv, hinv3, hinv4, &wk, &dwk, COMPUTE_WK);
+                          grid[idx] += gp->Value * wk;
+                        }
+                    }
+                  else if(field == GRID_MATTER_DENSITY_CIC || field == GRID_MATTER_DENSITY_TSC)
+                    grid[idx] += gp->Value / cellvol * w[0][x - lo[0]] * w[1][y - lo[1]] * w[2][z - lo[2]];
+                  else
+                    grid[idx] += gp->Value / cellvol;
+                }
+            }
+        }
+    }
+
+  Mem.myfree(partin);
+  Mem.myfree(last_sent);
+  Mem.myfree(recv_offset);
+  Mem.myfree(recv_count);
+  Mem.myfree(send_offset);
+  Mem.myfree(send_count);
+}
+
+/*! Writes the local slabs of a grid, multiplied by 'fac', as little-endian 4-byte floats into their place in the file 'fname'. The
+ *  file is first created by task 0, and then the tasks write their blocks, with at most MaxFilesWithConcurrentIO tasks doing so at
+ *  the same time.
+ */
+void pm_periodic::densitygrid_write(const char *fname, int ngrid, int firstslab, int nslab, double *grid, double fac)
+{
+  size_t ncells = ((size_t)nslab) * ngrid * ngrid;
+
+  float *buf = (float *)Mem.mymalloc("buf", ncells * sizeof(float));
+
+  unsigned int one  = 1;
+  bool little_endian = (*((unsigned char *)&one) == 1);
+
+  for(size_t i = 0; i < ncells; i++)
+    {
+      buf[i] = grid[i] * fac;
+
+      if(!little_endian)
+        {
+          unsigned char *c = (unsigned char *)&buf[i];
+          std::swap(c[0], c[3]);
+          std::swap(c[1], c[2]);
+        }
+    }
+
+  if(ThisTask == 0)
+    {
+      FILE *fd;
+      if(!(fd = fopen(fname, "w")))
+        Terminate("can't open file `%s' for writing the grid", fname);
+      fclose(fd);
+    }
+
+  MPI_Barrier(Communicator);
+
+  int ngroups = NTask / All.MaxFilesWithConcurrentIO;
+  if((NTask % All.MaxFilesWithConcurrentIO))
+    ngroups++;
+
+  for(int gr = 0; gr < ngroups; gr++)
+    {
+      if((ThisTask % ngroups) == gr && ncells > 0) /* ok, it's this processor's turn */
+        {
+          FILE *fd;
+          if(!(fd = fopen(fname, "r+")))
+            Terminate("can't open file `%s' for writing the grid", fname);
+
+          off_t offset = ((off_t)firstslab) * ngrid * ngrid * sizeof(float);
+
+          if(fseeko(fd, offset, SEEK_SET) != 0)
+            Terminate("can't seek to offset %lld in file `%s'", (long long)offset, fname);
+
+          if(fwrite(buf, sizeof(float), ncells, fd) != ncells)
+            Terminate("error while writing the grid to file `%s'", fname);
+
+          fclose(fd);
+        }
+      MPI_Barrier(Communicator);
+    }
+
+  Mem.myfree(buf);
+}
+
+/*! This function deposits all fields requested in the DensityGridFields parameter onto grids and writes them to disk for output
+ *  number 'num'.
+ */
+void pm_periodic::write_density_grids(int num)
+{
+  double tstart = Logs.second();
+
+  int ngrid = All.DensityGridResolution;
+
+  mpi_printf("DENSITYGRID: Begin depositing %d field(s) onto grids with %d^3 cells for output %d\n", DensityGridNumFields, ngrid,
+             num);
+
+  /* the grid is cut into slabs along z, so that the part held by a task is contiguous in the Fortran-ordered output file */
+  int firstslab, nslab;
+  subdivide_evenly(ngrid, NTask, ThisTask, &firstslab, &nslab);
+
+  int *slab_to_task = (int *)Mem.mymalloc("slab_to_task", ngrid * sizeof(int));
+
+  for(int task = 0; task < NTask; task++)
+    {
+      int start, n;
+
+      subdivide_evenly(ngrid, NTask, task, &start, &n);
+
+      for(int i = start; i < start + n; i++)
+        slab_to_task[i] = task;
+    }
+
+  for(int n = 0; n < DensityGridNumFields; n++)
+    {
+      int field = DensityGridFieldList[n];
+
+      char buf[MAXLEN_PATH_EXTRA];
+
+      if(ThisTask == 0)
+        {
+          snprintf(buf, MAXLEN_PATH_EXTRA, "%s/grids", All.OutputDir);
+          mkdir(buf, 02755);
+          snprintf(buf, MAXLEN_PATH_EXTRA, "%s/grids/%s", All.OutputDir, densitygrid_field_names[field]);
+          mkdir(buf, 02755);
+        }
+
+      double *grid = (double *)Mem.mymalloc_clear("grid", ((size_t)nslab) * ngrid * ngrid * sizeof(double));
+
+      densitygrid_deposit(field, ngrid, slab_to_task, firstslab, nslab, grid);
+
+      /* convert to physical cgs units */
+      double fac;
+      if(field == GRID_GAS_INTERNAL_ENERGY)
+        fac = All.UnitEnergy_in_cgs / All.UnitMass_in_g;
+      else
+        fac = All.UnitDensity_in_cgs * All.HubbleParam * All.HubbleParam * All.cf_a3inv;
+
+      snprintf(buf, MAXLEN_PATH_EXTRA, "%s/grids/%s/%03d.raw", All.OutputDir, densitygrid_field_names[field], num);
+
+      densitygrid_write(buf, ngrid, firstslab, nslab, grid, fac);
+
+      Mem.myfree(grid);
+
+      mpi_printf("DENSITYGRID: wrote field '%s' to file '%s'\n", densitygrid_field_names[field], buf);
+    }
+
+  Mem.myfree(slab_to_task);
+
+  double tend = Logs.second();
+
+  mpi_printf("DENSITYGRID: done, took %g sec\n", Logs.timediff(tstart, tend));
+}
+
+#endif
@@ -406,6 +406,15 @@ void pm_mpi_fft::my_slab_based_fft(fft_plan *plan, void *data, void *workspace,
     }
 }
 
+/*! Transforms the nfields fields data[0...nfields-1], using the corresponding workspace arrays, with the same plan. In the slab-based
+ *  FFT, each transpose is already done with a single collective exchange, hence the fields are simply transformed one after the other.
+ */
+void pm_mpi_fft::my_slab_based_fft_batched(fft_plan *plan, int nfields, void **data, void **workspace, int forward)
+{
+  for(int f = 0; f < nfields; f++)
+    my_slab_based_fft(plan, data[f], workspace[f], forward);
+}
+
 #else
 
 void pm_mpi_fft::my_column_based_fft_init(fft_plan *plan, int NgridX, int NgridY, int NgridZ)
@@ -588,96 +597,336 @@ void pm_mpi_fft::my_fft_swap13back(fft_plan *plan, fft_real *data, fft_real *out
 
 void pm_mpi_fft::my_column_based_fft(fft_plan *plan, void *data, void *workspace, int forward)
 {
-  long long n;
-  fft_real *data_real = (fft_real *)data, *workspace_real = (fft_real *)workspace;
-  fft_complex *data_complex = (fft_complex *)data, *workspace_complex = (fft_complex *)workspace;
+  my_column_based_fft_batched(plan, 1, &data, &workspace, forward);
+}
+
+/*! Transforms the nfields fields data[0...nfields-1] with the same plan. As in my_column_based_fft(), the result of a forward
+ *  transform ends up in workspace[], and that of a backward transform in data[]. The transposes of all fields are carried out
+ *  together, such that every pair of tasks exchanges its messages for all fields in the same communication phase, and the number
+ *  of synchronization points does not grow with the number of fields.
+ */
+void pm_mpi_fft::my_column_based_fft_batched(fft_plan *plan, int nfields, void **data, void **workspace, int forward)
+{
+  fft_complex **data_complex      = (fft_complex **)Mem.mymalloc("data_complex", nfields * sizeof(fft_complex *));
+  fft_complex **workspace_complex = (fft_complex **)Mem.mymalloc("workspace_complex", nfields * sizeof(fft_complex *));
+
+  for(int f = 0; f < nfields; f++)
+    {
+      data_complex[f]      = (fft_complex *)data[f];
+      workspace_complex[f] = (fft_complex *)workspace[f];
+    }
 
   if(forward == 1)
     {
       /* do the z-direction FFT, real to complex */
-      for(n = 0; n < plan->ncol_XY; n++)
-        FFTW(execute_dft_r2c)(plan->forward_plan_zdir, data_real + n * plan->Ngrid2, workspace_complex + n * plan->Ngridz);
+      for(int f = 0; f < nfields; f++)
+        for(long long n = 0; n < plan->ncol_XY; n++)
+          FFTW(execute_dft_r2c)(plan->forward_plan_zdir, (fft_real *)data[f] + n * plan->Ngrid2,
+                                workspace_complex[f] + n * plan->Ngridz);
 
       int dimA[3]  = {plan->NgridX, plan->NgridY, plan->Ngridz};
       int permA[3] = {0, 2, 1};
 
-      my_fft_column_remap(workspace_complex, dimA, plan->firstcol_XY, plan->ncol_XY, data_complex, permA, plan->transposed_firstcol,
-                          plan->transposed_ncol, plan->offsets_send_A, plan->offsets_recv_A, plan->count_send_A, plan->count_recv_A,
-                          0);
+      my_fft_column_remap_exchange(nfields, workspace_complex, dimA, plan->firstcol_XY, plan->ncol_XY, data_complex, permA,
+                                   plan->transposed_firstcol, plan->transposed_ncol, plan->offsets_send_A, plan->offsets_recv_A,
+                                   plan->count_send_A, plan->count_recv_A);
 
       /* do the y-direction FFT in 'data', complex to complex */
-      for(n = 0; n < plan->transposed_ncol; n++)
-        FFTW(execute_dft)(plan->forward_plan_ydir, data_complex + n * plan->NgridY, workspace_complex + n * plan->NgridY);
+      for(int f = 0; f < nfields; f++)
+        for(long long n = 0; n < plan->transposed_ncol; n++)
+          FFTW(execute_dft)(plan->forward_plan_ydir, data_complex[f] + n * plan->NgridY, workspace_complex[f] + n * plan->NgridY);
 
       int dimB[3]  = {plan->NgridX, plan->Ngridz, plan->NgridY};
       int permB[3] = {2, 1, 0};
 
-      my_fft_column_remap(workspace_complex, dimB, plan->transposed_firstcol, plan->transposed_ncol, data_complex, permB,
-                          plan->second_transposed_firstcol, plan->second_transposed_ncol, plan->offsets_send_B, plan->offsets_recv_B,
-                          plan->count_send_B, plan->count_recv_B, 0);
+      my_fft_column_remap_exchange(nfields, workspace_complex, dimB, plan->transposed_firstcol, plan->transposed_ncol, data_complex,
+                                   permB, plan->second_transposed_firstcol, plan->second_transposed_ncol, plan->offsets_send_B,
+                                   plan->offsets_recv_B, plan->count_send_B, plan->count_recv_B);
 
       /* do the x-direction FFT in 'data', complex to complex */
-      for(n = 0; n < plan->second_transposed_ncol; n++)
-        FFTW(execute_dft)(plan->forward_plan_xdir, data_complex + n * plan->NgridX, workspace_complex + n * plan->NgridX);
+      for(int f = 0; f < nfields; f++)
+        for(long long n = 0; n < plan->second_transposed_ncol; n++)
+          FFTW(execute_dft)(plan->forward_plan_xdir, data_complex[f] + n * plan->NgridX, workspace_complex[f] + n * plan->NgridX);
 
       /* result is now in workspace */
     }
   else
     {
       /* do inverse FFT in 'data' */
-      for(n = 0; n < plan->second_transposed_ncol; n++)
-        FFTW(execute_dft)(plan->backward_plan_xdir, data_complex + n * plan->NgridX, workspace_complex + n * plan->NgridX);
+      for(int f = 0; f < nfields; f++)
+        for(long long n = 0; n < plan->second_transposed_ncol; n++)
+          FFTW(execute_dft)(plan->backward_plan_xdir, data_complex[f] + n * plan->NgridX, workspace_complex[f] + n * plan->NgridX);
 
       int dimC[3]  = {plan->NgridY, plan->Ngridz, plan->NgridX};
       int permC[3] = {2, 1, 0};
 
-      my_fft_column_remap(workspace_complex, dimC, plan->second_transposed_firstcol, plan->second_transposed_ncol, data_complex, permC,
-                          plan->transposed_firstcol, plan->transposed_ncol, plan->offsets_send_C, plan->offsets_recv_C,
-                          plan->count_send_C, plan->count_recv_C, 0);
+      my_fft_column_remap_exchange(nfields, workspace_complex, dimC, plan->second_transposed_firstcol, plan->second_transposed_ncol,
+                                   data_complex, permC, plan->transposed_firstcol, plan->transposed_ncol, plan->offsets_send_C,
+                                   plan->offsets_recv_C, plan->count_send_C, plan->count_recv_C);
 
       /* do inverse FFT in 'data' */
-      for(n = 0; n < plan->transposed_ncol; n++)
-        FFTW(execute_dft)(plan->backward_plan_ydir, data_complex + n * plan->NgridY, workspace_complex + n * plan->NgridY);
+      for(int f = 0; f < nfields; f++)
+        for(long long n = 0; n < plan->transposed_ncol; n++)
+          FFTW(execute_dft)(plan->backward_plan_ydir, data_complex[f] + n * plan->NgridY, workspace_complex[f] + n * plan->NgridY);
 
       int dimD[3]  = {plan->NgridX, plan->Ngridz, plan->NgridY};
       int permD[3] = {0, 2, 1};
 
-      my_fft_column_remap(workspace_complex, dimD, plan->transposed_firstcol, plan->transposed_ncol, data_complex, permD,
-                          plan->firstcol_XY, plan->ncol_XY, plan->offsets_send_D, plan->offsets_recv_D, plan->count_send_D,
-                          plan->count_recv_D, 0);
+      my_fft_column_remap_exchange(nfields, workspace_complex, dimD, plan->transposed_firstcol, plan->transposed_ncol, data_complex,
+                                   permD, plan->firstcol_XY, plan->ncol_XY, plan->offsets_send_D, plan->offsets_recv_D,
+                                   plan->count_send_D, plan->count_recv_D);
 
       /* do complex-to-real inverse transform on z-coordinates */
-      for(n = 0; n < plan->ncol_XY; n++)
-        FFTW(execute_dft_c2r)(plan->backward_plan_zdir, data_complex + n * plan->Ngridz, workspace_real + n * plan->Ngrid2);
+      for(int f = 0; f < nfields; f++)
+        for(long long n = 0; n < plan->ncol_XY; n++)
+          FFTW(execute_dft_c2r)(plan->backward_plan_zdir, data_complex[f] + n * plan->Ngridz,
+                                (fft_real *)workspace[f] + n * plan->Ngrid2);
+    }
+
+  Mem.myfree(workspace_complex);
+  Mem.myfree(data_complex);
+}
+
+/*! Calls func(source, target) for all cells that lie in one of the input columns in_firstcol...in_firstcol+in_ncol-1 and at the
+ *  same time, after the axis permutation perm[], in one of the output columns out_firstcol...out_firstcol+out_ncol-1. Here 'source'
+ *  is the index of the cell relative to the first input column, and 'target' its index relative to the first output column. The
+ *  cells are always visited in the storage order of the input layout, so that the sending and the receiving side of a remap
+ *  agree on the order of the elements in a message without having to communicate it.
+ */
+template <typename Func>
+void pm_mpi_fft::my_fft_column_remap_traverse(int Ndims[3], int perm[3], int in_firstcol, int in_ncol, int out_firstcol, int out_ncol,
+                                              Func func)
+{
+  if(in_ncol <= 0 || out_ncol <= 0)
+    return;
+
+  int perm_rev[3], xyz[3], uvw[3];
+
+  for(int j = 0; j < 3; j++)
+    perm_rev[perm[j]] = j;
+
+  /* find enclosing box around the input columns */
+  int in_first[3], in_last[3];
+
+  in_first[0] = in_firstcol / Ndims[1];
+  in_last[0]  = (in_firstcol + in_ncol - 1) / Ndims[1];
+
+  if(in_first[0] == in_last[0])
+    {
+      in_first[1] = in_firstcol % Ndims[1];
+      in_last[1]  = (in_firstcol + in_ncol - 1) % Ndims[1];
+    }
+  else
+    {
+      in_first[1] = 0;
+      in_last[1]  = Ndims[1] - 1;
+    }
+
+  in_first[2] = 0;
+  in_last[2]  = Ndims[2] - 1;
+
+  /* find enclosing box around the output columns in the output layout */
+  int out_first[3], out_last[3];
+
+  out_first[0] = out_firstcol / Ndims[perm[1]];
+  out_last[0]  = (out_firstcol + out_ncol - 1) / Ndims[perm[1]];
+
+  if(out_first[0] == out_last[0])
+    {
+      out_first[1] = out_firstcol % Ndims[perm[1]];
+      out_last[1]  = (out_firstcol + out_ncol - 1) % Ndims[perm[1]];
+    }
+  else
+    {
+      out_first[1] = 0;
+      out_last[1]  = Ndims[perm[1]] - 1;
     }
+
+  out_first[2] = 0;
+  out_last[2]  = Ndims[perm[2]] - 1;
+
+  /* map the latter back to the input coordinates and intersect the two boxes */
+  int first[3], last[3];
+
+  for(int j = 0; j < 3; j++)
+    {
+      first[j] = std::max<int>(in_first[j], out_first[perm_rev[j]]);
+      last[j]  = std::min<int>(in_last[j], out_last[perm_rev[j]]);
+
+      if(first[j] > last[j])
+        return;
+    }
+
+  for(xyz[0] = first[0]; xyz[0] <= last[0]; xyz[0]++)
+    for(xyz[1] = first[1]; xyz[1] <= last[1]; xyz[1]++)
+      {
+        int col_in = xyz[0] * Ndims[1] + xyz[1];
+
+        if(col_in < in_firstcol || col_in >= in_firstcol + in_ncol)
+          continue;
+
+        for(xyz[2] = first[2]; xyz[2] <= last[2]; xyz[2]++)
+          {
+            uvw[0] = xyz[perm[0]];
+            uvw[1] = xyz[perm[1]];
+            uvw[2] = xyz[perm[2]];
+
+            int col_out = uvw[0] * Ndims[perm[1]] + uvw[1];
+
+            if(col_out >= out_firstcol && col_out < out_firstcol + out_ncol)
+              func(((size_t)Ndims[2]) * (col_in - in_firstcol) + xyz[2],
+                   ((size_t)Ndims[perm[2]]) * (col_out - out_firstcol) + uvw[2]);
+          }
+      }
 }
 
+/*! Carries out the data exchange of a column remap for the nfields fields data[0...nfields-1], using the counts and offsets
+ *  determined beforehand with my_fft_column_remap() in its counting mode. The results are stored in out[0...nfields-1], while
+ *  data[] is overwritten. In contrast to a pairwise exchange over all task pairs, only tasks that actually share columns
+ *  communicate, so that each task talks only to the small group of tasks whose column ranges overlap with its own in the
+ *  transposed layout. The messages are sent and received non-blocking: the data for a partner is sent as soon as it has been
+ *  packed, and incoming data is unpacked as soon as all of it has arrived from a given partner.
+ */
+void pm_mpi_fft::my_fft_column_remap_exchange(int nfields, fft_complex **data, int Ndims[3], int in_firstcol, int in_ncol,
+                                              fft_complex **out, int perm[3], int out_firstcol, int out_ncol, size_t *offset_send,
+                                              size_t *offset_recv, size_t *count_send, size_t *count_recv)
+{
+  int in_colums  = Ndims[0] * Ndims[1];
+  int out_colums = Ndims[perm[0]] * Ndims[perm[1]];
+
+  size_t maxcount = MPI_MESSAGE_SIZELIMIT_IN_BYTES / sizeof(fft_complex);
+
+  /* count the number of messages needed, taking into account that big messages are split up */
+  int nrequests = 0;
+  for(int task = 0; task < NTask; task++)
+    if(task != ThisTask)
+      nrequests += nfields * ((count_send[task] + maxcount - 1) / maxcount + (count_recv[task] + maxcount - 1) / maxcount);
+
+  MPI_Request *requests = (MPI_Request *)Mem.mymalloc("requests", std::max<int>(nrequests, 1) * sizeof(MPI_Request));
+  int *req_origin       = (int *)Mem.mymalloc("req_origin", std::max<int>(nrequests, 1) * sizeof(int));
+  int *pending          = (int *)Mem.mymalloc_clear("pending", NTask * sizeof(int));
+  int nsend = 0, nrecv = 0;
+
+  /* pack the data for each target and send it off right away; we start with the next higher task to spread the load,
+   * and do our own part last
+   */
+  for(int k = 1; k <= NTask; k++)
+    {
+      int target = (ThisTask + k) % NTask;
+
+      if(count_send[target] == 0)
+        continue;
+
+      int target_firstcol, target_ncol;
+      subdivide_evenly(out_colums, NTask, target, &target_firstcol, &target_ncol);
+
+      size_t n = 0;
+      my_fft_column_remap_traverse(Ndims, perm, in_firstcol, in_ncol, target_firstcol, target_ncol, [&](size_t source, size_t) {
+        size_t off = offset_send[target] + n++;
+        for(int f = 0; f < nfields; f++)
+          {
+            out[f][off][0] = data[f][source][0];
+            out[f][off][1] = data[f][source][1];
+          }
+      });
+
+      if(n != count_send[target])
+        Terminate("n=%lld != count_send[target=%d]=%lld", (long long)n, target, (long long)count_send[target]);
+
+      if(target != ThisTask)
+        for(int f = 0; f < nfields; f++)
+          for(size_t start = 0; start < count_send[target]; start += maxcount)
+            {
+              size_t count = std::min<size_t>(maxcount, count_send[target] - start);
+              MPI_Isend(out[f] + offset_send[target] + start, count * sizeof(fft_complex), MPI_BYTE, target, TAG_DENS_A, Communicator,
+                        &requests[nsend++]);
+            }
+    }
+
+  /* the input data is not needed any more, so we can now receive into this buffer */
+  for(int k = 1; k < NTask; k++)
+    {
+      int origin = (ThisTask + NTask - k) % NTask;
+
+      if(count_recv[origin] == 0)
+        continue;
+
+      for(int f = 0; f < nfields; f++)
+        for(size_t start = 0; start < count_recv[origin]; start += maxcount)
+          {
+            size_t count = std::min<size_t>(maxcount, count_recv[origin] - start);
+            MPI_Irecv(data[f] + offset_recv[origin] + start, count * sizeof(fft_complex), MPI_BYTE, origin, TAG_DENS_A, Communicator,
+                      &requests[nsend + nrecv]);
+            req_origin[nsend + nrecv++] = origin;
+            pending[origin]++;
+          }
+    }
+
+  if(count_send[ThisTask] != count_recv[ThisTask])
+    Terminate("count_send[ThisTask]=%lld != count_recv[ThisTask]=%lld", (long long)count_send[ThisTask],
+              (long long)count_recv[ThisTask]);
+
+  for(int f = 0; f < nfields; f++)
+    memcpy(data[f] + offset_recv[ThisTask], out[f] + offset_send[ThisTask], count_send[ThisTask] * sizeof(fft_complex));
+
+  /* the send buffers are overwritten while unpacking, hence we need to wait until all sends are finished */
+  MPI_Waitall(nsend, requests, MPI_STATUSES_IGNORE);
+
+  /* unpack the data from every origin as soon as it is complete, starting with our own */
+  auto unpack = [&](int origin) {
+    int origin_firstcol, origin_ncol;
+    subdivide_evenly(in_colums, NTask, origin, &origin_firstcol, &origin_ncol);
+
+    size_t n = 0;
+    my_fft_column_remap_traverse(Ndims, perm, origin_firstcol, origin_ncol, out_firstcol, out_ncol, [&](size_t, size_t target) {
+      size_t off = offset_recv[origin] + n++;
+      for(int f = 0; f < nfields; f++)
+        {
+          out[f][target][0] = data[f][off][0];
+          out[f][target][1] = data[f][off][1];
+        }
+    });
+
+    if(n != count_recv[origin])
+      Terminate("n=%lld != count_recv[origin=%d]=%lld", (long long)n, origin, (long long)count_recv[origin]);
+  };
+
+  if(count_recv[ThisTask] > 0)
+    unpack(ThisTask);
+
+  for(int k = 0; k < nrecv; k++)
+    {
+      int index;
+      MPI_Waitany(nrecv, requests + nsend, &index, MPI_STATUS_IGNORE);
+
+      int origin = req_origin[nsend + index];
+
+      if(--pending[origin] == 0)
+        unpack(origin);
+    }
+
+  Mem.myfree(pending);
+  Mem.myfree(req_origin);
+  Mem.myfree(requests);
+}
+
+/*! Determines the counts and offsets of the data that needs to be exchanged in a remap of the columns (just_count_flag=1), or
+ *  carries out the remap with these counts (just_count_flag=0).
+ */
 void pm_mpi_fft::my_fft_column_remap(fft_complex *data, int Ndims[3], /* global dimensions of data cube */
                                      int in_firstcol, int in_ncol,    /* first column and number of columns */
                                      fft_complex *out, int perm[3], int out_firstcol, int out_ncol, size_t *offset_send,
                                      size_t *offset_recv, size_t *count_send, size_t *count_recv, size_t just_count_flag)
 {
-  int j, target, origin, ngrp, recvTask, perm_rev[3], xyz[3], uvw[3];
-  size_t nimport, nexport;
-
-  /* determine the inverse permutation */
-  for(j = 0; j < 3; j++)
-    perm_rev[j] = perm[j];
-
-  if(!(perm_rev[perm[0]] == 0 && perm_rev[perm[1]] == 1 && perm_rev[perm[2]] == 2)) /* not yet the inverse */
+  if(!just_count_flag)
     {
-      for(j = 0; j < 3; j++)
-        perm_rev[j] = perm[perm[j]];
-
-      if(!(perm_rev[perm[0]] == 0 && perm_rev[perm[1]] == 1 && perm_rev[perm[2]] == 2))
-        Terminate("bummer");
+      my_fft_column_remap_exchange(1, &data, Ndims, in_firstcol, in_ncol, &out, perm, out_firstcol, out_ncol, offset_send,
+                                   offset_recv, count_send, count_recv);
+      return;
     }
 
-  int in_colums          = Ndims[0] * Ndims[1];
-  int in_avg             = (in_colums - 1) / NTask + 1;
-  int in_exc             = NTask * in_avg - in_colums;
-  int in_tasklastsection = NTask - in_exc;
-  int in_pivotcol        = in_tasklastsection * in_avg;
+  int j, target, xyz[3], uvw[3];
+  size_t nimport, nexport;
 
   int out_colums          = Ndims[perm[0]] * Ndims[perm[1]];
   int out_avg             = (out_colums - 1) / NTask + 1;
@@ -707,16 +956,8 @@ void pm_mpi_fft::my_fft_column_remap(fft_complex *data, int Ndims[3], /* global
       else
         target = (newcol - out_pivotcol) / (out_avg - 1) + out_tasklastsection;
 
-      /* move data element to targettask */
+      count_send[target]++;
 
-      if(just_count_flag)
-        count_send[target]++;
-      else
-        {
-          size_t off  = offset_send[target] + count_send[target]++;
-          out[off][0] = data[i][0];
-          out[off][1] = data[i][1];
-        }
       xyz[2]++;
       if(xyz[2] == Ndims[2])
         {
@@ -730,119 +971,25 @@ void pm_mpi_fft::my_fft_column_remap(fft_complex *data, int Ndims[3], /* global
         }
     }
 
-  if(just_count_flag)
-    {
-      myMPI_Alltoall(count_send, sizeof(size_t), MPI_BYTE, count_recv, sizeof(size_t), MPI_BYTE, Communicator);
+  myMPI_Alltoall(count_send, sizeof(size_t), MPI_BYTE, count_recv, sizeof(size_t), MPI_BYTE, Communicator);
 
-      for(j = 0, nimport = 0, nexport = 0, offset_send[0] = 0, offset_recv[0] = 0; j < NTask; j++)
-        {
-          nexport += count_send[j];
-          nimport += count_recv[j];
-
-          if(j > 0)
-            {
-              offset_send[j] = offset_send[j - 1] + count_send[j - 1];
-              offset_recv[j] = offset_recv[j - 1] + count_recv[j - 1];
-            }
-        }
-
-      if(nexport != ncells)
-        Terminate("nexport=%lld != ncells=%lld", (long long)nexport, (long long)ncells);
-    }
-  else
+  for(j = 0, nimport = 0, nexport = 0, offset_send[0] = 0, offset_recv[0] = 0; j < NTask; j++)
     {
-      nimport = 0;
-
-      /* exchange all the data */
-      for(ngrp = 0; ngrp < (1 << PTask); ngrp++)
-        {
-          recvTask = ThisTask ^ ngrp;
-
-          if(recvTask < NTask)
-            {
-              if(count_send[recvTask] > 0 || count_recv[recvTask] > 0)
-                myMPI_Sendrecv(&out[offset_send[recvTask]], count_send[recvTask] * sizeof(fft_complex), MPI_BYTE, recvTask, TAG_DENS_A,
-                               &data[offset_recv[recvTask]], count_recv[recvTask] * sizeof(fft_complex), MPI_BYTE, recvTask,
-                               TAG_DENS_A, Communicator, MPI_STATUS_IGNORE);
-
-              nimport += count_recv[recvTask];
-            }
-        }
-
-      /* now loop over the new cell layout */
-      /* find enclosing rectangle around columns in new plane */
-
-      int first[3], last[3];
-
-      first[0] = out_firstcol / Ndims[perm[1]];
-      first[1] = out_firstcol % Ndims[perm[1]];
-      first[2] = 0;
-
-      last[0] = (out_firstcol + out_ncol - 1) / Ndims[perm[1]];
-      last[1] = (out_firstcol + out_ncol - 1) % Ndims[perm[1]];
-      last[2] = Ndims[perm[2]] - 1;
+      nexport += count_send[j];
+      nimport += count_recv[j];
 
-      if(first[1] + out_ncol >= Ndims[perm[1]])
+      if(j > 0)
         {
-          first[1] = 0;
-          last[1]  = Ndims[perm[1]] - 1;
+          offset_send[j] = offset_send[j - 1] + count_send[j - 1];
+          offset_recv[j] = offset_recv[j - 1] + count_recv[j - 1];
         }
+    }
 
-      /* now need to map this back to the old coordinates */
-
-      int xyz_first[3], xyz_last[3];
-
-      for(j = 0; j < 3; j++)
-        {
-          xyz_first[j] = first[perm_rev[j]];
-          xyz_last[j]  = last[perm_rev[j]];
-        }
-
-      memset(count_recv, 0, NTask * sizeof(size_t));
-
-      size_t count = 0;
-
-      /* traverse an enclosing box around the new cell layout in the old order */
-      for(xyz[0] = xyz_first[0]; xyz[0] <= xyz_last[0]; xyz[0]++)
-        for(xyz[1] = xyz_first[1]; xyz[1] <= xyz_last[1]; xyz[1]++)
-          for(xyz[2] = xyz_first[2]; xyz[2] <= xyz_last[2]; xyz[2]++)
-            {
-              /* check that the point is actually part of a column */
-              uvw[0] = xyz[perm[0]];
-              uvw[1] = xyz[perm[1]];
-              uvw[2] = xyz[perm[2]];
-
-              int col = uvw[0] * Ndims[perm[1]] + uvw[1];
-
-              if(col >= out_firstcol && col < out_firstcol + out_ncol)
-                {
-                  /* determine origin task */
-                  int newcol = Ndims[1] * xyz[0] + xyz[1];
-                  if(newcol < in_pivotcol)
-                    origin = newcol / in_avg;
-                  else
-                    origin = (newcol - in_pivotcol) / (in_avg - 1) + in_tasklastsection;
-
-                  size_t index = ((size_t)Ndims[perm[2]]) * (col - out_firstcol) + uvw[2];
-
-                  /* move data element from origin task */
-                  size_t off    = offset_recv[origin] + count_recv[origin]++;
-                  out[index][0] = data[off][0];
-                  out[index][1] = data[off][1];
-
-                  count++;
-                }
-            }
-
-      if(count != nimport)
-        {
-          int fi = out_firstcol % Ndims[perm[1]];
-          int la = (out_firstcol + out_ncol - 1) % Ndims[perm[1]];
+  if(nexport != ncells)
+    Terminate("nexport=%lld != ncells=%lld", (long long)nexport, (long long)ncells);
 
-          Terminate("count=%lld nimport=%lld   ncol=%d fi=%d la=%d first=%d last=%d\n", (long long)count, (long long)nimport, out_ncol,
-                    fi, la, first[1], last[1]);
-        }
-    }
+  if(nimport != ((size_t)out_ncol) * Ndims[perm[2]])
+    Terminate("nimport=%lld != %lld", (long long)nimport, (long long)(((size_t)out_ncol) * Ndims[perm[2]]));
 }
 
 void pm_mpi_fft::my_fft_column_transpose(fft_real *data, int Ndims[3], /* global dimensions of data cube */
@@ -103,6 +103,9 @@ class pm_mpi_fft : public virtual setcomm
   void my_column_based_fft(fft_plan *plan, void *data, void *workspace, int forward);
   void my_column_based_fft_free(fft_plan *plan);
 
+  void my_slab_based_fft_batched(fft_plan *plan, int nfields, void **data, void **workspace, int forward);
+  void my_column_based_fft_batched(fft_plan *plan, int nfields, void **data, void **workspace, int forward);
+
   void my_slab_transposeA(fft_plan *plan, fft_real *field, fft_real *scratch);
   void my_slab_transposeB(fft_plan *plan, fft_real *field, fft_real *scratch);
 
@@ -121,6 +124,14 @@ class pm_mpi_fft : public virtual setcomm
                            int out_firstcol, int out_ncol, size_t *offset_send, size_t *offset_recv, size_t *count_send,
                            size_t *count_recv, size_t just_count_flag);
 
+  void my_fft_column_remap_exchange(int nfields, fft_complex **data, int Ndims[3], int in_firstcol, int in_ncol, fft_complex **out,
+                                    int perm[3], int out_firstcol, int out_ncol, size_t *offset_send, size_t *offset_recv,
+                                    size_t *count_send, size_t *count_recv);
+
+  template <typename Func>
+  void my_fft_column_remap_traverse(int Ndims[3], int perm[3], int in_firstcol, int in_ncol, int out_firstcol, int out_ncol,
+                                    Func func);
+
   void my_fft_column_transpose(fft_real *data, int Ndims[3], /* global dimensions of data cube */
                                int in_firstcol, int in_ncol, /* first column and number of columns */
                                fft_real *out, int perm[3], int out_firstcol, int out_ncol, size_t *count_send, size_t *count_recv,
@@ -34,6 +34,7 @@
 #include "../pm/pm_periodic.h"
 #include "../sort/cxxsort.h"
 #include "../system/system.h"
+#include "../system/worker_threads.h"
 #include "../time_integration/timestep.h"
 
 /*!
@@ -79,6 +80,79 @@
 #define NI(x, y, z) (((large_array_offset)GRIDZ) * ((y) + (x)*myplan.nslab_y) + (z))
 #endif
 
+/*! Returns the first of the PM_ASSIGNMENT_ORDER consecutive mesh cells along one dimension which receive a share of a particle
+ *  at integer coordinate pos.
+ */
+static inline int pm_assignment_first_cell(MyIntPosType pos, int ngrid)
+{
+  int cell = pos / INTCELL;
+
+#if PM_ASSIGNMENT_ORDER == 3
+  if(pos % INTCELL < INTCELL / 2) /* the nearest mesh point, which is the central one of the three cells, lies below */
+    cell--;
+#elif PM_ASSIGNMENT_ORDER == 4
+  cell--;
+#endif
+
+  if(cell < 0)
+    cell += ngrid;
+
+  return cell;
+}
+
+/*! Like pm_assignment_first_cell(), but in addition stores the CIC, TSC, or PCS weights of the cells in w[].
+ */
+static inline int pm_assignment_stencil(MyIntPosType pos, int ngrid, double *w)
+{
+  double t = (pos % INTCELL) * (1.0 / INTCELL);
+
+#if PM_ASSIGNMENT_ORDER == 2
+  w[0] = 1.0 - t;
+  w[1] = t;
+#elif PM_ASSIGNMENT_ORDER == 3
+  /* distance to the nearest mesh point */
+  double d = (pos % INTCELL < INTCELL / 2) ? t : t - 1.0;
+
+  w[0] = 0.5 * (0.5 - d) * (0.5 - d);
+  w[1] = 0.75 - d * d;
+  w[2] = 0.5 * (0.5 + d) * (0.5 + d);
+#else
+  double s = 1.0 - t;
+
+  w[0] = (1.0 / 6) * s * s * s;
+  w[1] = (1.0 / 6) * (4.0 - 6.0 * t * t + 3.0 * t * t * t);
+  w[2] = (1.0 / 6) * (4.0 - 6.0 * s * s + 3.0 * s * s * s);
+  w[3] = (1.0 / 6) * t * t * t;
+#endif
+
+  return pm_assignment_first_cell(pos, ngrid);
+}
+
+/*! Maps the position to the folded box if the power spectrum is measured with mode 2 or 3 */
+static inline MyIntPosType pm_fold_intpos(MyIntPosType pos, int mode)
+{
+  if(mode == 2)
+    return pos * POWERSPEC_FOLDFAC;
+  else if(mode == 3)
+    return pos * POWERSPEC_FOLDFAC * POWERSPEC_FOLDFAC;
+  else
+    return pos;
+}
+
+/*! Returns the inverse square of the Fourier transform of the mass assignment kernel, given the product ff of the inverse sinc
+ *  functions of the three dimensions. This undoes the smoothing of the mass assignment and of the force interpolation, or the
+ *  one of the density modes entering the power spectrum.
+ */
+static inline double pm_deconvolution_factor(double ff)
+{
+  double deconv = 1.0;
+
+  for(int n = 0; n < 2 * PM_ASSIGNMENT_ORDER; n++)
+    deconv *= ff;
+
+  return deconv;
+}
+
 /*! \brief This routine generates the FFTW-plans to carry out the FFTs later on.
  *
  *  Some auxiliary variables for bookkeeping are also initialized.
@@ -90,6 +164,10 @@ void pm_periodic::pm_init_periodic(simparticles *Sp_ptr)
   Sp->Asmth[0] = ASMTH * All.BoxSize / PMGRID;
   Sp->Rcut[0]  = RCUT * Sp->Asmth[0];
 
+#ifdef DENSITYGRID_ON_OUTPUT
+  densitygrid_parse_fields();
+#endif
+
   /* Set up the FFTW-3 plan files. */
   int ndimx[1] = {GRIDX}; /* dimension of the 1D transforms */
   int ndimy[1] = {GRIDY}; /* dimension of the 1D transforms */
@@ -436,6 +514,14 @@ void pm_periodic::pmforce_zoom_optimized_prepare_density(int mode, int *typelist
  * If dim is negative, potential values are read out and assigned to particles.
  */
 void pm_periodic::pmforce_zoom_optimized_readout_forces_or_potential(fft_real *grid, int dim)
+{
+  pmforce_zoom_optimized_readout_forces_or_potential(1, &grid, &dim);
+}
+
+/* Reads out the ngrids fields grid[0...ngrids-1] in a single sweep over the particles, where field n is assigned to the force
+ * component dim[n], or to the potential if dim[n] is negative. All fields are exchanged together.
+ */
+void pm_periodic::pmforce_zoom_optimized_readout_forces_or_potential(int ngrids, fft_real **grid, int *dim)
 {
   particle_data *P = Sp->P;
 
@@ -447,6 +533,13 @@ void pm_periodic::pmforce_zoom_optimized_readout_forces_or_potential(fft_real *g
 #endif
 #endif
 
+  /* for a single field, the values are assembled in localfield_data, otherwise we need room for the values of all fields */
+  fft_real *fielddata = localfield_data;
+
+  if(ngrids > 1)
+    fielddata = (fft_real *)Mem.mymalloc(
+        "fielddata", ngrids * (localfield_offset[NTask - 1] + localfield_sendcount[NTask - 1]) * sizeof(fft_real));
+
   for(int level = 0; level < (1 << PTask); level++) /* note: for level=0, target is the same task */
     {
       int recvTask = ThisTask ^ level;
@@ -455,7 +548,7 @@ void pm_periodic::pmforce_zoom_optimized_readout_forces_or_potential(fft_real *g
         {
           if(level > 0)
             {
-              import_data        = (fft_real *)Mem.mymalloc("import_data", localfield_recvcount[recvTask] * sizeof(fft_real));
+              import_data = (fft_real *)Mem.mymalloc("import_data", ngrids * localfield_recvcount[recvTask] * sizeof(fft_real));
               import_globalindex = (large_array_offset *)Mem.mymalloc("import_globalindex",
                                                                       localfield_recvcount[recvTask] * sizeof(large_array_offset));
 
@@ -470,7 +563,7 @@ void pm_periodic::pmforce_zoom_optimized_readout_forces_or_potential(fft_real *g
             }
           else
             {
-              import_data        = localfield_data + localfield_offset[ThisTask];
+              import_data        = fielddata + ngrids * localfield_offset[ThisTask];
               import_globalindex = localfield_globalindex + localfield_offset[ThisTask];
             }
 
@@ -482,15 +575,17 @@ void pm_periodic::pmforce_zoom_optimized_readout_forces_or_potential(fft_real *g
 #else
               large_array_offset offset = import_globalindex[i] - myplan.firstcol_XY * ((large_array_offset)GRID2);
 #endif
-              import_data[i] = grid[offset];
+              for(int n = 0; n < ngrids; n++)
+                import_data[ngrids * i + n] = grid[n][offset];
             }
 
           if(level > 0)
             {
               MPI_Status status;
-              myMPI_Sendrecv(import_data, localfield_recvcount[recvTask] * sizeof(fft_real), MPI_BYTE, recvTask, TAG_NONPERIOD_A,
-                             localfield_data + localfield_offset[recvTask], localfield_sendcount[recvTask] * sizeof(fft_real),
-                             MPI_BYTE, recvTask, TAG_NONPERIOD_A, Communicator, &status);
+              myMPI_Sendrecv(import_data, ngrids * localfield_recvcount[recvTask] * sizeof(fft_real), MPI_BYTE, recvTask,
+                             TAG_NONPERIOD_A, fielddata + ngrids * localfield_offset[recvTask],
+                             ngrids * localfield_sendcount[recvTask] * sizeof(fft_real), MPI_BYTE, recvTask, TAG_NONPERIOD_A,
+                             Communicator, &status);
 
               Mem.myfree(import_globalindex);
               Mem.myfree(import_data);
@@ -498,7 +593,7 @@ void pm_periodic::pmforce_zoom_optimized_readout_forces_or_potential(fft_real *g
         }
     }
 
-  /* read out the force/potential values, which all have been assembled in localfield_data */
+  /* read out the force/potential values, which all have been assembled in fielddata */
   for(int idx = 0; idx < NSource; idx++)
     {
       int i = Sp->get_active_index(idx);
@@ -518,34 +613,42 @@ void pm_periodic::pmforce_zoom_optimized_readout_forces_or_potential(fft_real *g
       double dy = rmd_y * (1.0 / INTCELL);
       double dz = rmd_z * (1.0 / INTCELL);
 
-      double value = localfield_data[part[j + 0].localindex] * (1.0 - dx) * (1.0 - dy) * (1.0 - dz) +
-                     localfield_data[part[j + 1].localindex] * (1.0 - dx) * (1.0 - dy) * dz +
-                     localfield_data[part[j + 2].localindex] * (1.0 - dx) * dy * (1.0 - dz) +
-                     localfield_data[part[j + 3].localindex] * (1.0 - dx) * dy * dz +
-                     localfield_data[part[j + 4].localindex] * (dx) * (1.0 - dy) * (1.0 - dz) +
-                     localfield_data[part[j + 5].localindex] * (dx) * (1.0 - dy) * dz +
-                     localfield_data[part[j + 6].localindex] * (dx)*dy * (1.0 - dz) +
-                     localfield_data[part[j + 7].localindex] * (dx)*dy * dz;
-
-      if(dim < 0)
+      for(int n = 0; n < ngrids; n++)
         {
+          fft_real *data = fielddata + n;
+
+          double value = data[ngrids * part[j + 0].localindex] * (1.0 - dx) * (1.0 - dy) * (1.0 - dz) +
+                         data[ngrids * part[j + 1].localindex] * (1.0 - dx) * (1.0 - dy) * dz +
+                         data[ngrids * part[j + 2].localindex] * (1.0 - dx) * dy * (1.0 - dz) +
+                         data[ngrids * part[j + 3].localindex] * (1.0 - dx) * dy * dz +
+                         data[ngrids * part[j + 4].localindex] * (dx) * (1.0 - dy) * (1.0 - dz) +
+                         data[ngrids * part[j + 5].localindex] * (dx) * (1.0 - dy) * dz +
+                         data[ngrids * part[j + 6].localindex] * (dx)*dy * (1.0 - dz) +
+                         data[ngrids * part[j + 7].localindex] * (dx)*dy * dz;
+
+          if(dim[n] < 0)
+            {
 #ifdef EVALPOTENTIAL
 #if defined(PERIODIC) && !defined(TREEPM_NOTIMESPLIT)
-          P[i].PM_Potential += value * fac;
+              P[i].PM_Potential += value * fac;
 #else
-          P[i].Potential += value * fac;
+              P[i].Potential += value * fac;
 #endif
 #endif
-        }
-      else
-        {
+            }
+          else
+            {
 #if defined(PERIODIC) && !defined(TREEPM_NOTIMESPLIT)
-          Sp->P[i].GravPM[dim] += value;
+              Sp->P[i].GravPM[dim[n]] += value;
 #else
-          Sp->P[i].GravAccel[dim] += value;
+              Sp->P[i].GravAccel[dim[n]] += value;
 #endif
+            }
         }
     }
+
+  if(ngrids > 1)
+    Mem.myfree(fielddata);
 }
 
 #else
@@ -590,6 +693,27 @@ void pm_periodic::pmforce_uniform_optimized_prepare_density(int mode, int *typel
             if(typelist[P[i].getType()] == 0)
               continue;
 
+#ifndef FFT_COLUMN_BASED
+          int slab_x = pm_assignment_first_cell(pm_fold_intpos(P[i].IntPos[0], mode), GRIDX);
+
+          int tasks[PM_ASSIGNMENT_ORDER];
+          int ntasks = pmforce_get_slab_tasks(slab_x, tasks);
+
+          for(int k = 0; k < ntasks; k++)
+            {
+              if(rep == 0)
+                Sndpm_count[tasks[k]]++;
+              else
+                {
+                  size_t ind = Sndpm_offset[tasks[k]] + Sndpm_count[tasks[k]]++;
+#ifndef LEAN
+                  partout[ind].Mass = P[i].getMass();
+#endif
+                  for(int j = 0; j < 3; j++)
+                    partout[ind].IntPos[j] = P[i].IntPos[j];
+                }
+            }
+#else
           int slab_x;
           if(mode == 2)
             slab_x = (P[i].IntPos[0] * POWERSPEC_FOLDFAC) / INTCELL;
@@ -603,41 +727,6 @@ void pm_periodic::pmforce_uniform_optimized_prepare_density(int mode, int *typel
           if(slab_xx >= GRIDX)
             slab_xx = 0;
 
-#ifndef FFT_COLUMN_BASED
-          if(rep == 0)
-            {
-              int task0 = myplan.slab_to_task[slab_x];
-              int task1 = myplan.slab_to_task[slab_xx];
-
-              Sndpm_count[task0]++;
-
-              if(task0 != task1)
-                Sndpm_count[task1]++;
-            }
-          else
-            {
-              int task0 = myplan.slab_to_task[slab_x];
-              int task1 = myplan.slab_to_task[slab_xx];
-
-              size_t ind0 = Sndpm_offset[task0] + Sndpm_count[task0]++;
-#ifndef LEAN
-              partout[ind0].Mass = P[i].getMass();
-#endif
-              for(int j = 0; j < 3; j++)
-                partout[ind0].IntPos[j] = P[i].IntPos[j];
-
-              if(task0 != task1)
-                {
-                  size_t ind1 = Sndpm_offset[task1] + Sndpm_count[task1]++;
-#ifndef LEAN
-                  partout[ind1].Mass = P[i].getMass();
-#endif
-                  for(int j = 0; j < 3; j++)
-                    partout[ind1].IntPos[j] = P[i].IntPos[j];
-                }
-            }
-
-#else
           int slab_y;
           if(mode == 2)
             slab_y = (P[i].IntPos[1] * POWERSPEC_FOLDFAC) / INTCELL;
@@ -771,84 +860,7 @@ void pm_periodic::pmforce_uniform_optimized_prepare_density(int mode, int *typel
 
 #ifndef FFT_COLUMN_BASED
   /* bin particle data onto mesh, in multi-threaded fashion */
-
-  for(size_t i = 0; i < nimport; i++)
-    {
-      int slab_x, slab_y, slab_z;
-      MyIntPosType rmd_x, rmd_y, rmd_z;
-
-      if(mode == 2)
-        {
-          slab_x = (partin[i].IntPos[0] * POWERSPEC_FOLDFAC) / INTCELL;
-          rmd_x = (partin[i].IntPos[0] * POWERSPEC_FOLDFAC) % INTCELL;
-          slab_y = (partin[i].IntPos[1] * POWERSPEC_FOLDFAC) / INTCELL;
-          rmd_y = (partin[i].IntPos[1] * POWERSPEC_FOLDFAC) % INTCELL;
-          slab_z = (partin[i].IntPos[2] * POWERSPEC_FOLDFAC) / INTCELL;
-          rmd_z = (partin[i].IntPos[2] * POWERSPEC_FOLDFAC) % INTCELL;
-        }
-      else if(mode == 3)
-        {
-          slab_x = (partin[i].IntPos[0] * POWERSPEC_FOLDFAC * POWERSPEC_FOLDFAC) / INTCELL;
-          rmd_x = (partin[i].IntPos[0] * POWERSPEC_FOLDFAC * POWERSPEC_FOLDFAC) % INTCELL;
-          slab_y = (partin[i].IntPos[1] * POWERSPEC_FOLDFAC * POWERSPEC_FOLDFAC) / INTCELL;
-          rmd_y = (partin[i].IntPos[1] * POWERSPEC_FOLDFAC * POWERSPEC_FOLDFAC) % INTCELL;
-          slab_z = (partin[i].IntPos[2] * POWERSPEC_FOLDFAC * POWERSPEC_FOLDFAC) / INTCELL;
-          rmd_z = (partin[i].IntPos[2] * POWERSPEC_FOLDFAC * POWERSPEC_FOLDFAC) % INTCELL;
-        }
-      else
-        {
-          slab_x = partin[i].IntPos[0] / INTCELL;
-          rmd_x = partin[i].IntPos[0] % INTCELL;
-          slab_y = partin[i].IntPos[1] / INTCELL;
-          rmd_y = partin[i].IntPos[1] % INTCELL;
-          slab_z = partin[i].IntPos[2] / INTCELL;
-          rmd_z = partin[i].IntPos[2] % INTCELL;
-        }
-
-      double dx = rmd_x * (1.0 / INTCELL);
-      double dy = rmd_y * (1.0 / INTCELL);
-      double dz = rmd_z * (1.0 / INTCELL);
-
-      int slab_xx = slab_x + 1;
-      int slab_yy = slab_y + 1;
-      int slab_zz = slab_z + 1;
-
-      if(slab_xx >= GRIDX)
-        slab_xx = 0;
-      if(slab_yy >= GRIDY)
-        slab_yy = 0;
-      if(slab_zz >= GRIDZ)
-        slab_zz = 0;
-
-#ifdef LEAN
-      double mass = All.PartMass;
-#else
-      double mass = partin[i].Mass;
-#endif
-
-      if(myplan.slab_to_task[slab_x] == ThisTask)
-        {
-          slab_x -= myplan.first_slab_x_of_task[ThisTask];
-
-          rhogrid[FI(slab_x, slab_y, slab_z)] += (mass * (1.0 - dx) * (1.0 - dy) * (1.0 - dz));
-          rhogrid[FI(slab_x, slab_y, slab_zz)] += (mass * (1.0 - dx) * (1.0 - dy) * (dz));
-
-          rhogrid[FI(slab_x, slab_yy, slab_z)] += (mass * (1.0 - dx) * (dy) * (1.0 - dz));
-          rhogrid[FI(slab_x, slab_yy, slab_zz)] += (mass * (1.0 - dx) * (dy) * (dz));
-        }
-
-      if(myplan.slab_to_task[slab_xx] == ThisTask)
-        {
-          slab_xx -= myplan.first_slab_x_of_task[ThisTask];
-
-          rhogrid[FI(slab_xx, slab_y, slab_z)] += (mass * (dx) * (1.0 - dy) * (1.0 - dz));
-          rhogrid[FI(slab_xx, slab_y, slab_zz)] += (mass * (dx) * (1.0 - dy) * (dz));
-
-          rhogrid[FI(slab_xx, slab_yy, slab_z)] += (mass * (dx) * (dy) * (1.0 - dz));
-          rhogrid[FI(slab_xx, slab_yy, slab_zz)] += (mass * (dx) * (dy) * (dz));
-        }
-    }
-
+  pmforce_uniform_optimized_deposit_slabs(mode);
 #else
 
   int first_col = myplan.firstcol_XY;
@@ -956,9 +968,216 @@ void pm_periodic::pmforce_uniform_optimized_prepare_density(int mode, int *typel
 #endif
 }
 
+#ifndef FFT_COLUMN_BASED
+/*! Collects the different tasks that hold the PM_ASSIGNMENT_ORDER consecutive x-slabs starting at slab, and returns their number.
+ *  The tasks are listed in the order in which the slabs are encountered, hence the density assignment and the force readout
+ *  agree on the sequence in which the tasks appear in the communication buffers. Since every task holds a contiguous range of
+ *  slabs, a task can only reappear after the wrap-around if it holds all slabs, hence it suffices to compare with the previous
+ *  slab.
+ */
+inline int pm_periodic::pmforce_get_slab_tasks(int slab, int *tasks)
+{
+  int ntasks = 0;
+
+  for(int ix = 0; ix < PM_ASSIGNMENT_ORDER; ix++, slab++)
+    {
+      if(slab >= GRIDX)
+        slab -= GRIDX;
+
+      int task = myplan.slab_to_task[slab];
+
+      if(ntasks == 0 || tasks[ntasks - 1] != task)
+        tasks[ntasks++] = task;
+    }
+
+  return ntasks;
+}
+
+/*! Bins the particles imported into partin onto the local slabs of rhogrid.
+ *
+ *  The particles are first sorted by the x-slab of the first mesh cell they contribute to, keeping their order within a slab.
+ *  The slabs are then split into contiguous tiles, one per thread, such that every tile holds about the same number of
+ *  particles. A thread adds the contributions to the slabs that only its own particles touch directly to rhogrid, whereas it
+ *  accumulates those to the PM_ASSIGNMENT_ORDER-1 slabs at either end of its tile, which it shares with the neighbouring tiles
+ *  or which are reached by periodic wrap-around, in a private buffer. These buffers are added to rhogrid once all threads are
+ *  done, so no atomic updates are needed.
+ */
+void pm_periodic::pmforce_uniform_optimized_deposit_slabs(int mode)
+{
+  const int order                    = PM_ASSIGNMENT_ORDER;
+  const int firstslab                = myplan.first_slab_x_of_task[ThisTask];
+  const int nkeys                    = myplan.nslab_x + order - 1; /* the first slab of a particle lies in [firstslab-order+1,...] */
+  const large_array_offset planesize = ((large_array_offset)GRIDY) * GRID2;
+
+  /* converts the first slab a particle contributes to into the position relative to the first local slab, shifted by order-1
+   * such that it is non-negative
+   */
+  auto get_key = [&](int slab_x) {
+    int rel = slab_x - firstslab;
+    if(rel < 0)
+      rel += GRIDX;
+    if(rel >= myplan.nslab_x)
+      rel -= GRIDX;
+
+    return rel + order - 1;
+  };
+
+  /* counting sort of the particles by their first slab */
+  large_numpart_type *sortindex = (large_numpart_type *)Mem.mymalloc("sortindex", nimport * sizeof(large_numpart_type));
+  large_numpart_type *keystart  = (large_numpart_type *)Mem.mymalloc_clear("keystart", (nkeys + 1) * sizeof(large_numpart_type));
+
+  for(size_t i = 0; i < nimport; i++)
+    {
+      int key = get_key(pm_assignment_first_cell(pm_fold_intpos(partin[i].IntPos[0], mode), GRIDX));
+
+      if(key < 0 || key >= nkeys)
+        Terminate("particle does not touch any of the slabs %d...%d of this task", firstslab, firstslab + myplan.nslab_x - 1);
+
+      keystart[key + 1]++;
+    }
+
+  for(int k = 1; k <= nkeys; k++)
+    keystart[k] += keystart[k - 1];
+
+  for(size_t i = 0; i < nimport; i++)
+    {
+      int key = get_key(pm_assignment_first_cell(pm_fold_intpos(partin[i].IntPos[0], mode), GRIDX));
+      sortindex[keystart[key]++] = i;
+    }
+
+  /* after the placement, keystart[k] points to the end of the particles with key k, shift it back to get their start */
+  for(int k = nkeys; k > 0; k--)
+    keystart[k] = keystart[k - 1];
+  keystart[0] = 0;
+
+  /* split the slabs into tiles with about equal particle numbers */
+  const int nthreads = THREADS_PER_MPI_RANK;
+  int tile[MAX_THREADS + 1];
+
+  tile[0]        = 0;
+  tile[nthreads] = nkeys;
+  for(int t = 1; t < nthreads; t++)
+    {
+      size_t target = (nimport * t) / nthreads;
+      int k         = tile[t - 1];
+
+      while(k < nkeys && (size_t)keystart[k] < target)
+        k++;
+
+      tile[t] = k;
+    }
+
+  /* private buffers for the slabs at the lower and upper end of each tile */
+  fft_real *halo = (fft_real *)Mem.mymalloc_clear("halo", 2 * nthreads * (order - 1) * planesize * sizeof(fft_real));
+
+  run_worker_threads(nthreads, [&](int thread) {
+    int k0 = tile[thread];
+    int k1 = tile[thread + 1];
+
+    /* the relative slabs k0 ... khigh-1 are written by this thread only */
+    int khigh = std::max<int>(k0, k1 - order + 1);
+
+    fft_real *lowhalo  = halo + 2 * thread * (order - 1) * planesize;
+    fft_real *highhalo = lowhalo + (order - 1) * planesize;
+
+    for(large_numpart_type p = keystart[k0]; p < keystart[k1]; p++)
+      {
+        size_t i = sortindex[p];
+
+        double wx[PM_ASSIGNMENT_ORDER], wy[PM_ASSIGNMENT_ORDER], wz[PM_ASSIGNMENT_ORDER];
+
+        int key    = get_key(pm_assignment_stencil(pm_fold_intpos(partin[i].IntPos[0], mode), GRIDX, wx));
+        int slab_y = pm_assignment_stencil(pm_fold_intpos(partin[i].IntPos[1], mode), GRIDY, wy);
+        int slab_z = pm_assignment_stencil(pm_fold_intpos(partin[i].IntPos[2], mode), GRIDZ, wz);
+
+#ifdef LEAN
+        double mass = All.PartMass;
+#else
+        double mass = partin[i].Mass;
+#endif
+
+        int yy[PM_ASSIGNMENT_ORDER], zz[PM_ASSIGNMENT_ORDER];
+        for(int k = 0; k < PM_ASSIGNMENT_ORDER; k++)
+          {
+            yy[k] = (slab_y + k < GRIDY) ? slab_y + k : slab_y + k - GRIDY;
+            zz[k] = (slab_z + k < GRIDZ) ? slab_z + k : slab_z + k - GRIDZ;
+          }
+
+        for(int ix = 0; ix < PM_ASSIGNMENT_ORDER; ix++)
+          {
+            int rel = key - order + 1 + ix;
+
+            fft_real *plane;
+            if(rel < k0)
+              plane = lowhalo + (rel - k0 + order - 1) * planesize;
+            else if(rel >= khigh)
+              plane = highhalo + (rel - khigh) * planesize;
+            else
+              plane = rhogrid + FI(rel, 0, 0);
+
+            for(int iy = 0; iy < PM_ASSIGNMENT_ORDER; iy++)
+              {
+                fft_real *row = plane + ((large_array_offset)GRID2) * yy[iy];
+                double wxy    = mass * wx[ix] * wy[iy];
+
+                for(int iz = 0; iz < PM_ASSIGNMENT_ORDER; iz++)
+                  row[zz[iz]] += wxy * wz[iz];
+              }
+          }
+      }
+  });
+
+  /* now add the buffered slabs, provided they are local */
+  for(int t = 0; t < nthreads; t++)
+    {
+      int k0    = tile[t];
+      int k1    = tile[t + 1];
+      int khigh = std::max<int>(k0, k1 - order + 1);
+
+      if(k0 == k1)
+        continue;
+
+      for(int h = 0; h < 2 * (order - 1); h++)
+        {
+          int rel = (h < order - 1) ? k0 - order + 1 + h : khigh + h - (order - 1);
+
+          if(rel >= k1)
+            continue;
+
+          int slab = firstslab + rel;
+          if(slab < 0)
+            slab += GRIDX;
+          if(slab >= GRIDX)
+            slab -= GRIDX;
+
+          if(myplan.slab_to_task[slab] != ThisTask)
+            continue;
+
+          fft_real *src = halo + (2 * t * (order - 1) + h) * planesize;
+          fft_real *dst = rhogrid + FI(slab - firstslab, 0, 0);
+
+          for(large_array_offset n = 0; n < planesize; n++)
+            dst[n] += src[n];
+        }
+    }
+
+  Mem.myfree(halo);
+  Mem.myfree(keystart);
+  Mem.myfree(sortindex);
+}
+#endif
+
 /* If dim<0, this function reads out the potential, otherwise Cartesian force components.
  */
 void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_xy(fft_real *grid, int dim)
+{
+  pmforce_uniform_optimized_readout_forces_or_potential_xy(1, &grid, &dim);
+}
+
+/* Reads out the ngrids fields grid[0...ngrids-1] in a single sweep over the particles, where field n is assigned to the force
+ * component dim[n], or to the potential if dim[n] is negative. The values of all fields are sent back with one exchange.
+ */
+void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_xy(int ngrids, fft_real **grid, int *dim)
 {
   particle_data *P = Sp->P;
 
@@ -970,21 +1189,79 @@ void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_xy(fft_r
 #endif
 #endif
 
-  MyFloat *flistin = (MyFloat *)Mem.mymalloc("flistin", nimport * sizeof(MyFloat));
-  MyFloat *flistout = (MyFloat *)Mem.mymalloc("flistout", nexport * sizeof(MyFloat));
+  MyFloat *flistin = (MyFloat *)Mem.mymalloc("flistin", ngrids * nimport * sizeof(MyFloat));
+  MyFloat *flistout = (MyFloat *)Mem.mymalloc("flistout", ngrids * nexport * sizeof(MyFloat));
 
-#ifdef FFT_COLUMN_BASED
+#ifndef FFT_COLUMN_BASED
+  /* The imported particles arrive in the order of the particle arrays of the sending tasks, which the domain decomposition
+   * keeps sorted along the space-filling curve. Hence each thread reads out a contiguous block of them, which touches only a
+   * compact part of the local slabs.
+   */
+  const int firstslab = myplan.first_slab_x_of_task[ThisTask];
+
+  run_worker_threads(THREADS_PER_MPI_RANK, [&](int thread) {
+    size_t ifirst = (nimport * thread) / THREADS_PER_MPI_RANK;
+    size_t ilast  = (nimport * (thread + 1)) / THREADS_PER_MPI_RANK;
+
+    for(size_t i = ifirst; i < ilast; i++)
+      {
+        double wx[PM_ASSIGNMENT_ORDER], wy[PM_ASSIGNMENT_ORDER], wz[PM_ASSIGNMENT_ORDER];
+
+        int slab_x = pm_assignment_stencil(partin[i].IntPos[0], GRIDX, wx);
+        int slab_y = pm_assignment_stencil(partin[i].IntPos[1], GRIDY, wy);
+        int slab_z = pm_assignment_stencil(partin[i].IntPos[2], GRIDZ, wz);
+
+        int yy[PM_ASSIGNMENT_ORDER], zz[PM_ASSIGNMENT_ORDER];
+        for(int k = 0; k < PM_ASSIGNMENT_ORDER; k++)
+          {
+            yy[k] = (slab_y + k < GRIDY) ? slab_y + k : slab_y + k - GRIDY;
+            zz[k] = (slab_z + k < GRIDZ) ? slab_z + k : slab_z + k - GRIDZ;
+          }
+
+        /* offsets of the local slabs the particle overlaps with, the others are covered by other tasks */
+        large_array_offset plane[PM_ASSIGNMENT_ORDER];
+        double wplane[PM_ASSIGNMENT_ORDER];
+        int nplanes = 0;
+
+        for(int ix = 0; ix < PM_ASSIGNMENT_ORDER; ix++)
+          {
+            int x = (slab_x + ix < GRIDX) ? slab_x + ix : slab_x + ix - GRIDX;
+
+            if(myplan.slab_to_task[x] == ThisTask)
+              {
+                plane[nplanes]    = FI(x - firstslab, 0, 0);
+                wplane[nplanes++] = wx[ix];
+              }
+          }
+
+        for(int n = 0; n < ngrids; n++)
+          {
+            fft_real *g  = grid[n];
+            double value = 0;
+
+            for(int ip = 0; ip < nplanes; ip++)
+              for(int iy = 0; iy < PM_ASSIGNMENT_ORDER; iy++)
+                {
+                  fft_real *row = g + plane[ip] + ((large_array_offset)GRID2) * yy[iy];
+                  double wxy    = wplane[ip] * wy[iy];
+
+                  for(int iz = 0; iz < PM_ASSIGNMENT_ORDER; iz++)
+                    value += row[zz[iz]] * wxy * wz[iz];
+                }
+
+            flistin[ngrids * i + n] = value;
+          }
+      }
+  });
+#else
   int columns = GRIDX * GRIDY;
   int avg = (columns - 1) / NTask + 1;
   int exc = NTask * avg - columns;
   int tasklastsection = NTask - exc;
   int pivotcol = tasklastsection * avg;
-#endif
 
   for(size_t i = 0; i < nimport; i++)
     {
-      flistin[i] = 0;
-
       int slab_x = partin[i].IntPos[0] / INTCELL;
       int slab_y = partin[i].IntPos[1] / INTCELL;
       int slab_z = partin[i].IntPos[2] / INTCELL;
@@ -1008,60 +1285,48 @@ void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_xy(fft_r
       if(slab_zz >= GRIDZ)
         slab_zz = 0;
 
-#ifndef FFT_COLUMN_BASED
-      if(myplan.slab_to_task[slab_x] == ThisTask)
-        {
-          slab_x -= myplan.first_slab_x_of_task[ThisTask];
-
-          flistin[i] += grid[FI(slab_x, slab_y, slab_z)] * (1.0 - dx) * (1.0 - dy) * (1.0 - dz) +
-                        grid[FI(slab_x, slab_y, slab_zz)] * (1.0 - dx) * (1.0 - dy) * (dz) +
-                        grid[FI(slab_x, slab_yy, slab_z)] * (1.0 - dx) * (dy) * (1.0 - dz) +
-                        grid[FI(slab_x, slab_yy, slab_zz)] * (1.0 - dx) * (dy) * (dz);
-        }
-
-      if(myplan.slab_to_task[slab_xx] == ThisTask)
-        {
-          slab_xx -= myplan.first_slab_x_of_task[ThisTask];
-
-          flistin[i] += grid[FI(slab_xx, slab_y, slab_z)] * (dx) * (1.0 - dy) * (1.0 - dz) +
-                        grid[FI(slab_xx, slab_y, slab_zz)] * (dx) * (1.0 - dy) * (dz) +
-                        grid[FI(slab_xx, slab_yy, slab_z)] * (dx) * (dy) * (1.0 - dz) +
-                        grid[FI(slab_xx, slab_yy, slab_zz)] * (dx) * (dy) * (dz);
-        }
-#else
       int column0 = slab_x * GRIDY + slab_y;
       int column1 = slab_x * GRIDY + slab_yy;
       int column2 = slab_xx * GRIDY + slab_y;
       int column3 = slab_xx * GRIDY + slab_yy;
 
-      if(column0 >= myplan.firstcol_XY && column0 <= myplan.lastcol_XY)
+      for(int n = 0; n < ngrids; n++)
         {
-          flistin[i] += grid[FCxy(column0, slab_z)] * (1.0 - dx) * (1.0 - dy) * (1.0 - dz) +
-                        grid[FCxy(column0, slab_zz)] * (1.0 - dx) * (1.0 - dy) * (dz);
-        }
-      if(column1 >= myplan.firstcol_XY && column1 <= myplan.lastcol_XY)
-        {
-          flistin[i] +=
-              grid[FCxy(column1, slab_z)] * (1.0 - dx) * (dy) * (1.0 - dz) + grid[FCxy(column1, slab_zz)] * (1.0 - dx) * (dy) * (dz);
-        }
+          fft_real *g = grid[n];
+          MyFloat &value = flistin[ngrids * i + n];
 
-      if(column2 >= myplan.firstcol_XY && column2 <= myplan.lastcol_XY)
-        {
-          flistin[i] +=
-              grid[FCxy(column2, slab_z)] * (dx) * (1.0 - dy) * (1.0 - dz) + grid[FCxy(column2, slab_zz)] * (dx) * (1.0 - dy) * (dz);
-        }
+          value = 0;
 
-      if(column3 >= myplan.firstcol_XY && column3 <= myplan.lastcol_XY)
-        {
-          flistin[i] += grid[FCxy(column3, slab_z)] * (dx) * (dy) * (1.0 - dz) + grid[FCxy(column3, slab_zz)] * (dx) * (dy) * (dz);
+          if(column0 >= myplan.firstcol_XY && column0 <= myplan.lastcol_XY)
+            {
+              value += g[FCxy(column0, slab_z)] * (1.0 - dx) * (1.0 - dy) * (1.0 - dz) +
+                       g[FCxy(column0, slab_zz)] * (1.0 - dx) * (1.0 - dy) * (dz);
+            }
+          if(column1 >= myplan.firstcol_XY && column1 <= myplan.lastcol_XY)
+            {
+              value +=
+                  g[FCxy(column1, slab_z)] * (1.0 - dx) * (dy) * (1.0 - dz) + g[FCxy(column1, slab_zz)] * (1.0 - dx) * (dy) * (dz);
+            }
+
+          if(column2 >= myplan.firstcol_XY && column2 <= myplan.lastcol_XY)
+            {
+              value +=
+                  g[FCxy(column2, slab_z)] * (dx) * (1.0 - dy) * (1.0 - dz) + g[FCxy(column2, slab_zz)] * (dx) * (1.0 - dy) * (dz);
+            }
+
+          if(column3 >= myplan.firstcol_XY && column3 <= myplan.lastcol_XY)
+            {
+              value += g[FCxy(column3, slab_z)] * (dx) * (dy) * (1.0 - dz) + g[FCxy(column3, slab_zz)] * (dx) * (dy) * (dz);
+            }
         }
-#endif
     }
 
+#endif
+
   /* exchange the potential component data */
   int flag_big = 0, flag_big_all;
   for(int i = 0; i < NTask; i++)
-    if(Sndpm_count[i] * sizeof(MyFloat) > MPI_MESSAGE_SIZELIMIT_IN_BYTES)
+    if(Sndpm_count[i] * ngrids * sizeof(MyFloat) > MPI_MESSAGE_SIZELIMIT_IN_BYTES)
       flag_big = 1;
 
   /* produce a flag if any of the send sizes is above our transfer limit, in this case we will
@@ -1070,7 +1335,7 @@ void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_xy(fft_r
   MPI_Allreduce(&flag_big, &flag_big_all, 1, MPI_INT, MPI_MAX, Communicator);
 
   /* exchange  data */
-  myMPI_Alltoallv(flistin, Rcvpm_count, Rcvpm_offset, flistout, Sndpm_count, Sndpm_offset, sizeof(MyFloat), flag_big_all,
+  myMPI_Alltoallv(flistin, Rcvpm_count, Rcvpm_offset, flistout, Sndpm_count, Sndpm_offset, ngrids * sizeof(MyFloat), flag_big_all,
                   Communicator);
 
   /* each threads needs to do the loop to clear its send_count[] array */
@@ -1081,21 +1346,25 @@ void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_xy(fft_r
     {
       int i = Sp->get_active_index(idx);
 
+      /* positions in flistout of the contributions of the different tasks to the particle */
+      size_t off[4];
+      int noff = 0;
+
+#ifndef FFT_COLUMN_BASED
+      int slab_x = pm_assignment_first_cell(P[i].IntPos[0], GRIDX);
+
+      int tasks[PM_ASSIGNMENT_ORDER];
+      int ntasks = pmforce_get_slab_tasks(slab_x, tasks);
+
+      for(int k = 0; k < ntasks; k++)
+        off[noff++] = Sndpm_offset[tasks[k]] + Sndpm_count[tasks[k]]++;
+#else
       int slab_x = P[i].IntPos[0] / INTCELL;
       int slab_xx = slab_x + 1;
 
       if(slab_xx >= GRIDX)
         slab_xx = 0;
 
-#ifndef FFT_COLUMN_BASED
-      int task0 = myplan.slab_to_task[slab_x];
-      int task1 = myplan.slab_to_task[slab_xx];
-
-      double value = flistout[Sndpm_offset[task0] + Sndpm_count[task0]++];
-
-      if(task0 != task1)
-        value += flistout[Sndpm_offset[task1] + Sndpm_count[task1]++];
-#else
       int slab_y = P[i].IntPos[1] / INTCELL;
       int slab_yy = slab_y + 1;
 
@@ -1129,16 +1398,16 @@ void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_xy(fft_r
       else
         task3 = (column3 - pivotcol) / (avg - 1) + tasklastsection;
 
-      double value = flistout[Sndpm_offset[task0] + Sndpm_count[task0]++];
+      off[noff++] = Sndpm_offset[task0] + Sndpm_count[task0]++;
 
       if(task1 != task0)
-        value += flistout[Sndpm_offset[task1] + Sndpm_count[task1]++];
+        off[noff++] = Sndpm_offset[task1] + Sndpm_count[task1]++;
 
       if(task2 != task1 && task2 != task0)
-        value += flistout[Sndpm_offset[task2] + Sndpm_count[task2]++];
+        off[noff++] = Sndpm_offset[task2] + Sndpm_count[task2]++;
 
       if(task3 != task0 && task3 != task1 && task3 != task2)
-        value += flistout[Sndpm_offset[task3] + Sndpm_count[task3]++];
+        off[noff++] = Sndpm_offset[task3] + Sndpm_count[task3]++;
 #endif
 
 #if !defined(HIERARCHICAL_GRAVITY) && defined(TREEPM_NOTIMESPLIT)
@@ -1146,23 +1415,31 @@ void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_xy(fft_r
         continue;
 #endif
 
-      if(dim < 0)
+      for(int n = 0; n < ngrids; n++)
         {
+          double value = flistout[ngrids * off[0] + n];
+
+          for(int k = 1; k < noff; k++)
+            value += flistout[ngrids * off[k] + n];
+
+          if(dim[n] < 0)
+            {
 #ifdef EVALPOTENTIAL
 #if defined(PERIODIC) && !defined(TREEPM_NOTIMESPLIT)
-          Sp->P[i].PM_Potential += value * fac;
+              Sp->P[i].PM_Potential += value * fac;
 #else
-          Sp->P[i].Potential += value * fac;
+              Sp->P[i].Potential += value * fac;
 #endif
 #endif
-        }
-      else
-        {
+            }
+          else
+            {
 #if defined(PERIODIC) && !defined(TREEPM_NOTIMESPLIT)
-          Sp->P[i].GravPM[dim] += value;
+              Sp->P[i].GravPM[dim[n]] += value;
 #else
-          Sp->P[i].GravAccel[dim] += value;
+              Sp->P[i].GravAccel[dim[n]] += value;
 #endif
+            }
         }
     }
 
@@ -1794,7 +2071,9 @@ void pm_periodic::pmforce_uniform_optimized_readout_forces_or_potential_zy(fft_r
  *  potential by fast Fourier transform methods. The potential is finite-differenced
  *  using a 4-point finite differencing formula, and the forces are
  *  interpolated tri-linearly to the particle positions. The CIC kernel is
- *  deconvolved.
+ *  deconvolved. With PM_SPECTRAL_DIFFERENCING, the force components are instead
+ *  obtained in Fourier space, and read out together with the potential in a single
+ *  sweep over the particles.
  *
  *  For mode=0, normal force calculation, mode=1, only density field construction
  *  for a power spectrum calculation. In the later case, typelist flags the particle
@@ -1836,6 +2115,10 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
   double fac = 4 * M_PI * (LONG_X * LONG_Y * LONG_Z) / pow(All.BoxSize, 3); /* to get potential  */
 #endif
 
+#ifdef PM_SPECTRAL_DIFFERENCING
+  double fac_spectral = fac; /* the force is obtained as -i k times the potential in Fourier space */
+#endif
+
   fac *= 1 / (2 * d); /* for finite differencing */
 
 #ifdef PM_ZOOM_OPTIMIZED
@@ -1844,6 +2127,8 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
   pmforce_uniform_optimized_prepare_density(mode, typelist);
 #endif
 
+  double tdensity = Logs.second();
+
   /* note: after density, we still keep the field 'partin' from the density assignment,
    * as we can use this later on to return potential and z-force
    */
@@ -1867,6 +2152,8 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
   my_column_based_fft(&myplan, rhogrid, workspace, 1); /* result is in workspace, not in rhogrid ! */
 #endif
 
+  double tforward = Logs.second(), tgreen = 0, tinverse = 0;
+
   if(mode != 0)
     {
       pmforce_measure_powerspec(mode - 1, typelist);
@@ -1884,6 +2171,18 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
       double kfacy = 2.0 * M_PI / (GRIDY * d);
       double kfacz = 2.0 * M_PI / (GRIDZ * d);
 
+#ifdef PM_SPECTRAL_DIFFERENCING
+      /* fields for the three force components, which are computed together with the potential */
+      fft_real *accgrid[3];
+      fft_complex *fft_of_accgrid[3];
+
+      for(int dim = 0; dim < 3; dim++)
+        {
+          accgrid[dim]        = (fft_real *)Mem.mymalloc("accgrid", maxfftsize * sizeof(fft_real));
+          fft_of_accgrid[dim] = (fft_complex *)accgrid[dim];
+        }
+#endif
+
 #ifdef FFT_COLUMN_BASED
       for(large_array_offset ip = 0; ip < myplan.second_transposed_ncells; ip++)
         {
@@ -1946,7 +2245,7 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
                 }
 
               double ff = 1 / (fx * fy * fz);
-              deconv    = ff * ff * ff * ff;
+              deconv    = pm_deconvolution_factor(ff);
 
               smth *= deconv; /* deconvolution */
             }
@@ -1965,6 +2264,17 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
               fft_of_rhogrid[ip][0] *= smth;
               fft_of_rhogrid[ip][1] *= smth;
 #endif
+
+#ifdef PM_SPECTRAL_DIFFERENCING
+          /* the Nyquist frequencies have no well-defined derivative and are left out */
+          double kdiff[3] = {(2 * x == GRIDX) ? 0 : kx, (2 * y == GRIDY) ? 0 : ky, (2 * z == GRIDZ) ? 0 : kz};
+
+          for(int dim = 0; dim < 3; dim++)
+            {
+              fft_of_accgrid[dim][ip][0] = fac_spectral * kdiff[dim] * fft_of_rhogrid[ip][1];
+              fft_of_accgrid[dim][ip][1] = -fac_spectral * kdiff[dim] * fft_of_rhogrid[ip][0];
+            }
+#endif
         }
 
 #ifndef GRAVITY_TALLBOX
@@ -1977,7 +2287,67 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
 #endif
 #endif
 
-        /* Do the inverse FFT to get the potential/forces */
+      tgreen = Logs.second();
+
+#ifdef PM_SPECTRAL_DIFFERENCING
+      /* Do the inverse FFTs of the force components, and of the potential if needed, and read them all out in one go */
+
+#ifdef EVALPOTENTIAL
+      int nfields = 4;
+#else
+      int nfields = 3;
+#endif
+      int dims[4] = {0, 1, 2, -1};
+      fft_real *result[4];
+
+#ifndef FFT_COLUMN_BASED
+      /* the slab-based transforms are done one after the other, hence they can all use the same workspace */
+      void *fields[4] = {accgrid[0], accgrid[1], accgrid[2], rhogrid};
+      void *workspc[4] = {workspace, workspace, workspace, workspace};
+
+      my_slab_based_fft_batched(&myplan, nfields, fields, workspc, -1);
+
+      for(int n = 0; n < nfields; n++)
+        result[n] = (fft_real *)fields[n];
+#else
+      fft_real *accout[3];
+
+      for(int dim = 0; dim < 3; dim++)
+        accout[dim] = (fft_real *)Mem.mymalloc("accout", maxfftsize * sizeof(fft_real));
+
+      void *fields[4] = {accgrid[0], accgrid[1], accgrid[2], workspace};
+      void *workspc[4] = {accout[0], accout[1], accout[2], rhogrid};
+
+      my_column_based_fft_batched(&myplan, nfields, fields, workspc, -1); /* result is in workspc, not in fields */
+
+      for(int n = 0; n < nfields; n++)
+        result[n] = (fft_real *)workspc[n];
+#endif
+
+      tinverse = Logs.second();
+
+#ifdef PM_ZOOM_OPTIMIZED
+      pmforce_zoom_optimized_readout_forces_or_potential(nfields, result, dims);
+#else
+      pmforce_uniform_optimized_readout_forces_or_potential_xy(nfields, result, dims);
+#endif
+
+#ifdef FFT_COLUMN_BASED
+      for(int dim = 2; dim >= 0; dim--)
+        Mem.myfree(accout[dim]);
+#endif
+
+      for(int dim = 2; dim >= 0; dim--)
+        Mem.myfree(accgrid[dim]);
+
+#if defined(FFT_COLUMN_BASED) && !defined(PM_ZOOM_OPTIMIZED)
+      Mem.myfree_movable(partin);
+      partin = NULL;
+#endif
+
+#else
+
+      /* Do the inverse FFT to get the potential/forces */
 
 #ifndef FFT_COLUMN_BASED
       my_slab_based_fft(&myplan, &rhogrid[0], &workspace[0], -1);
@@ -1985,6 +2355,8 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
       my_column_based_fft(&myplan, workspace, rhogrid, -1);
 #endif
 
+      tinverse = Logs.second();
+
       /* Now rhogrid holds the potential/forces */
 
 #ifdef EVALPOTENTIAL
@@ -2208,9 +2580,12 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
       pmforce_uniform_optimized_readout_forces_or_potential_zy(rhogrid, 0);
 #endif
 
+#endif
 #endif
     }
 
+  double tforces = Logs.second();
+
   /* free stuff */
 
   Mem.myfree(forcegrid);
@@ -2237,7 +2612,36 @@ void pm_periodic::pmforce_periodic(int mode, int *typelist)
   double tend = Logs.second();
 
   if(mode == 0)
-    mpi_printf("PM-PERIODIC: done.  (took %g seconds)\n", Logs.timediff(tstart, tend));
+    {
+      mpi_printf("PM-PERIODIC: done.  (took %g seconds)\n", Logs.timediff(tstart, tend));
+
+      /* record how the time was spent in the different parts of the calculation */
+      double timer[5], tisum[5], timax[5];
+
+      timer[0] = Logs.timediff(tstart, tdensity);   /* density assignment */
+      timer[1] = Logs.timediff(tdensity, tforward); /* forward FFT */
+      timer[2] = Logs.timediff(tforward, tgreen);   /* multiplication with Green's function */
+      timer[3] = Logs.timediff(tgreen, tinverse);   /* inverse FFT(s) */
+      timer[4] = Logs.timediff(tinverse, tforces);  /* differencing and readout of potential and forces */
+
+      MPI_Reduce(timer, tisum, 5, MPI_DOUBLE, MPI_SUM, 0, Communicator);
+      MPI_Reduce(timer, timax, 5, MPI_DOUBLE, MPI_MAX, 0, Communicator);
+
+      if(ThisTask == 0)
+        {
+#ifdef PM_SPECTRAL_DIFFERENCING
+          const char *method = "spectral";
+#else
+          const char *method = "finite differences";
+#endif
+          fprintf(Logs.FdTimings,
+                  "PM-PERIODIC (%s): avg times: <density>=%g  <fft>=%g  <green>=%g  <inverse-fft>=%g  <forces>=%g sec\n", method,
+                  tisum[0] / NTask, tisum[1] / NTask, tisum[2] / NTask, tisum[3] / NTask, tisum[4] / NTask);
+          fprintf(Logs.FdTimings, "   max times: <density>=%g  <fft>=%g  <green>=%g  <inverse-fft>=%g  <forces>=%g sec\n", timax[0],
+                  timax[1], timax[2], timax[3], timax[4]);
+          myflush(Logs.FdTimings);
+        }
+    }
 }
 
 #ifdef GRAVITY_TALLBOX
@@ -2629,10 +3033,10 @@ void pm_periodic::pmforce_measure_powerspec(int flag, int *typeflag)
               fz = sin(fz) / fz;
             }
           double ff   = 1 / (fx * fy * fz);
-          double smth = ff * ff * ff * ff;
+          double smth = pm_deconvolution_factor(ff);
           /*
-           * Note: The Fourier-transform of the density field (rho_hat) must be multiplied with ff^2
-           * in order to do the de-convolution. Thats why po = rho_hat^2 gains a factor of ff^4.
+           * Note: The Fourier-transform of the density field (rho_hat) must be multiplied with ff^PM_ASSIGNMENT_ORDER
+           * in order to do the de-convolution. Thats why po = rho_hat^2 gains a factor of ff^(2*PM_ASSIGNMENT_ORDER).
            */
           /* end deconvolution */
 
@@ -174,6 +174,7 @@ class pm_periodic : public pm_mpi_fft
 
   void pmforce_zoom_optimized_prepare_density(int mode, int *typelist);
   void pmforce_zoom_optimized_readout_forces_or_potential(fft_real *grid, int dim);
+  void pmforce_zoom_optimized_readout_forces_or_potential(int ngrids, fft_real **grid, int *dim);
 
 #else
 
@@ -191,14 +192,50 @@ class pm_periodic : public pm_mpi_fft
   size_t *Sndpm_count, *Sndpm_offset;
   size_t *Rcvpm_count, *Rcvpm_offset;
 
+#ifndef FFT_COLUMN_BASED
+  int pmforce_get_slab_tasks(int slab, int *tasks);
+  void pmforce_uniform_optimized_deposit_slabs(int mode);
+#endif
+
   void pmforce_uniform_optimized_prepare_density(int mode, int *typelist);
 
   void pmforce_uniform_optimized_readout_forces_or_potential_xy(fft_real *grid, int dim);
+  void pmforce_uniform_optimized_readout_forces_or_potential_xy(int ngrids, fft_real **grid, int *dim);
 
   void pmforce_uniform_optimized_readout_forces_or_potential_xz(fft_real *grid, int dim);
   void pmforce_uniform_optimized_readout_forces_or_potential_zy(fft_real *grid, int dim);
 #endif
 
+#ifdef DENSITYGRID_ON_OUTPUT
+  /* particle data that is sent to the tasks holding the slabs a particle contributes to when a field is deposited onto an output grid
+   */
+  struct gridpart_data
+  {
+    double Pos[3]; /* position in units of the grid spacing, with the cell centers lying at integer values */
+    MyFloat Hsml;  /* kernel support radius for the SPH fields, zero means that the value is assigned to the nearest cell */
+    MyFloat Value; /* quantity to be deposited, the grid receives Value * W for SPH fields, and Value / cell volume otherwise */
+  };
+
+  /* the fields that can be requested in the DensityGridFields parameter */
+  enum densitygrid_field
+  {
+    GRID_GAS_DENSITY,
+    GRID_GAS_INTERNAL_ENERGY,
+    GRID_MATTER_DENSITY_CIC,
+    GRID_MATTER_DENSITY_TSC,
+    GRID_NFIELDS
+  };
+
+  int DensityGridNumFields;
+  int DensityGridFieldList[GRID_NFIELDS];
+
+  void densitygrid_parse_fields(void);
+  bool densitygrid_get_particle(int field, int i, double *cellsize, gridpart_data *gp);
+  void densitygrid_get_cell_range(int field, gridpart_data *gp, int dim, double *cellsize, int ngrid, int *lo, int *hi);
+  void densitygrid_deposit(int field, int ngrid, int *slab_to_task, int firstslab, int nslab, double *grid);
+  void densitygrid_write(const char *fname, int ngrid, int firstslab, int nslab, double *grid, double fac);
+#endif
+
  public:
   simparticles *Sp;
 
@@ -207,6 +244,10 @@ class pm_periodic : public pm_mpi_fft
 
   void calculate_power_spectra(int num);
 
+#ifdef DENSITYGRID_ON_OUTPUT
+  void write_density_grids(int num);
+#endif
+
   static double growthfactor_integrand(double a, void *param)
   {
     return pow(a / (All.Omega0 + (1 - All.Omega0 - All.OmegaLambda) * a + All.OmegaLambda * a * a * a), 1.5);
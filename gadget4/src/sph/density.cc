@@ -97,7 +97,9 @@ inline void sph::sph_density_check_particle_particle_interaction(pinfo &pdat, in
       double posdiff[3];
       Tp->nearest_image_intpos_to_pos(P->IntPos, pdat.searchcenter, posdiff); /* converts the integer distance to floating point */
 
-      if(posdiff[0] * posdiff[0] + posdiff[1] * posdiff[1] + posdiff[2] * posdiff[2] > pdat.hsml2)
+      double r2 = posdiff[0] * posdiff[0] + posdiff[1] * posdiff[1] + posdiff[2] * posdiff[2];
+
+      if(r2 > pdat.hsml2)
         return;
 
       if(pdat.numngb >= MAX_NGBS)
@@ -108,6 +110,9 @@ inline void sph::sph_density_check_particle_particle_interaction(pinfo &pdat, in
       Ngbdensdat[n].IntPos  = P->IntPos;
       Ngbdensdat[n].VelPred = SphP->VelPred;
       Ngbdensdat[n].Mass    = P->getMass();
+#ifdef SPH_KNN_HSML
+      Ngbdensdat[n].R = sqrt(r2);
+#endif
 #ifdef PRESSURE_ENTROPY_SPH
       Ngbdensdat[n].EntropyToInvGammaPred = SphP->EntropyToInvGammaPred;
 #endif
@@ -123,7 +128,9 @@ inline void sph::sph_density_check_particle_particle_interaction(pinfo &pdat, in
       double posdiff[3];
       Tp->nearest_image_intpos_to_pos(foreignpoint->IntPos, pdat.searchcenter, posdiff);
 
-      if(posdiff[0] * posdiff[0] + posdiff[1] * posdiff[1] + posdiff[2] * posdiff[2] > pdat.hsml2)
+      double r2 = posdiff[0] * posdiff[0] + posdiff[1] * posdiff[1] + posdiff[2] * posdiff[2];
+
+      if(r2 > pdat.hsml2)
         return;
 
       if(pdat.numngb >= MAX_NGBS)
@@ -134,6 +141,9 @@ inline void sph::sph_density_check_particle_particle_interaction(pinfo &pdat, in
       Ngbdensdat[n].IntPos  = foreignpoint->IntPos;
       Ngbdensdat[n].VelPred = foreignpoint->SphCore.VelPred;
       Ngbdensdat[n].Mass    = foreignpoint->Mass;
+#ifdef SPH_KNN_HSML
+      Ngbdensdat[n].R = sqrt(r2);
+#endif
 #ifdef PRESSURE_ENTROPY_SPH
       Ngbdensdat[n].EntropyToInvGammaPred = foreignpoint->SphCore.EntropyToInvGammaPred;
 #endif
@@ -345,7 +355,12 @@ void sph::densities_determine(int ntarget, int *targetlist)
                   item++;
 
                   pinfo pdat;
+#ifdef SPH_KNN_HSML
+                  get_pinfo_knn(target, pdat);
+                  int new_on_workstack = NewOnWorkStack;
+#else
                   get_pinfo(target, pdat);
+#endif
 
                   if(no == MaxPart)
                     {
@@ -365,6 +380,16 @@ void sph::densities_determine(int ntarget, int *targetlist)
                         sph_density_open_node(pdat, nop, mintopleaf, committed);
                     }
 
+#ifdef SPH_KNN_HSML
+                  /* if the walk of a pristine particle was completed, we have all candidate neighbours and can pick the
+                   * smoothing length directly, otherwise the remaining parts of the walk use the present smoothing length
+                   */
+                  if(no == MaxPart && NewOnWorkStack == new_on_workstack)
+                    density_knn_select_hsml(pdat);
+                  else
+                    density_knn_discard_outside_hsml(pdat);
+#endif
+
                   density_evaluate_kernel(pdat);
                 }
               else
@@ -1044,6 +1069,124 @@ void sph::density_evaluate_kernel(pinfo &pdat)
 }
 #endif
 
+#ifdef SPH_KNN_HSML
+
+/* Determines the smoothing length of the particle referenced in pdat from the complete list of candidate neighbours that
+ * has been collected within SPH_KNN_SEARCH_FACTOR times its previous smoothing length. The kernel-weighted neighbour number
+ * is brought to DesNumNgb with a Newton-Raphson iteration that is safeguarded by bisection, starting from the previous
+ * smoothing length, and only the neighbours inside the new smoothing length are then kept in Ngbdensdat[]. If even the full
+ * search radius contains too few neighbours, the smoothing length is set to the search radius, and the iteration in
+ * density() enlarges it further for the next walk.
+ */
+void sph::density_knn_select_hsml(pinfo &pdat)
+{
+#ifdef PRESERVE_SHMEM_BINARY_INVARIANCE
+  if(skip_actual_force_computation)
+    return;
+#endif
+
+  sph_particle_data *targetSphP = &Tp->SphP[pdat.target];
+  double mass                   = Tp->P[pdat.target].getMass();
+
+  double desnumngb  = All.DesNumNgb;
+  double hmax       = pdat.hsml;
+  bool hmax_checked = false;
+
+  double left = 0, right = hmax;
+  double h = std::min<double>(targetSphP->Hsml, hmax);
+
+  for(int iter = 0; iter < SPH_KNN_MAXITER; iter++)
+    {
+      double dnumngb_dh;
+      double numngb = density_knn_numngb(pdat, h, mass, &dnumngb_dh);
+
+      if(fabs(numngb - desnumngb) <= SPH_KNN_TOLERANCE * All.MaxNumNgbDeviation)
+        break;
+
+      if(numngb < desnumngb)
+        left = h;
+      else
+        right = h;
+
+      double hnew = (dnumngb_dh > 0) ? h - (numngb - desnumngb) / dnumngb_dh : 0;
+
+      if(hnew >= right && !hmax_checked)
+        {
+          /* make sure that the root is inside the search radius before we continue, otherwise leave the particle to density() */
+          hmax_checked = true;
+
+          if(right == hmax && density_knn_numngb(pdat, hmax, mass, &dnumngb_dh) <= desnumngb)
+            {
+              h = hmax;
+              break;
+            }
+        }
+
+      if(hnew <= left || hnew >= right)
+        hnew = 0.5 * (left + right);
+
+      h = hnew;
+    }
+
+  targetSphP->Hsml = h;
+
+  density_knn_discard_outside_hsml(pdat);
+}
+
+/* Removes the candidate neighbours outside the present smoothing length of the particle referenced in pdat from Ngbdensdat[]
+ */
+void sph::density_knn_discard_outside_hsml(pinfo &pdat)
+{
+  double h = Tp->SphP[pdat.target].Hsml;
+
+  int count = 0;
+
+  for(int n = 0; n < pdat.numngb; n++)
+    if(Ngbdensdat[n].R <= h)
+      Ngbdensdat[count++] = Ngbdensdat[n];
+
+  pdat.numngb = count;
+}
+
+/* Returns the kernel-weighted neighbour number of a particle of the given mass for smoothing length h, as it is computed
+ * in density(), together with its derivative with respect to h.
+ */
+double sph::density_knn_numngb(pinfo &pdat, double h, double mass, double *dnumngb_dh)
+{
+  double hinv, hinv3, hinv4;
+  kernel_hinv(h, &hinv, &hinv3, &hinv4);
+
+  double rho = 0, drho = 0;
+
+  for(int n = 0; n < pdat.numngb; n++)
+    {
+      if(Ngbdensdat[n].R > h)
+        continue;
+
+      double u = Ngbdensdat[n].R * hinv;
+
+      double wk, dwk;
+      kernel_main(u, hinv3, hinv4, &wk, &dwk, COMPUTE_WK_AND_DWK);
+
+      rho += Ngbdensdat[n].Mass * wk;
+      drho -= Ngbdensdat[n].Mass * u * dwk; /* derivative of h^NUMDIMS * rho, divided by h^NUMDIMS */
+    }
+
+#ifdef WENDLAND_BIAS_CORRECTION
+  rho -= get_density_bias(h, mass, All.DesNumNgb);
+#endif
+
+  double hfac = 1;
+  for(int i = 0; i < NUMDIMS; i++)
+    hfac *= h;
+
+  *dnumngb_dh = NORM_COEFF * hfac * drho / mass;
+
+  return NORM_COEFF * hfac * rho / mass;
+}
+
+#endif
+
 /* this routine clears the fields in the SphP particle structure that are additively computed by the SPH density loop
  * by summing over neighbours
  */
@@ -19,6 +19,12 @@
 
 #define MAX_NGBS 500000
 
+#ifdef SPH_KNN_HSML
+#define SPH_KNN_SEARCH_FACTOR 1.03 /* search radius of the density walk in units of the current smoothing length */
+#define SPH_KNN_MAXITER 100        /* maximum number of root finding steps for the smoothing length of one particle */
+#define SPH_KNN_TOLERANCE 0.01     /* accuracy of the neighbour number in units of MaxNumNgbDeviation */
+#endif
+
 class sph : public ngbtree
 {
  public:
@@ -74,6 +80,26 @@ class sph : public ngbtree
     pdat.numngb = 0;
   }
 
+#ifdef SPH_KNN_HSML
+  /* like get_pinfo(), but with a search region enlarged by SPH_KNN_SEARCH_FACTOR, such that the candidate neighbours found
+   * in a single walk normally suffice to determine the smoothing length
+   */
+  inline void get_pinfo_knn(int i, pinfo &pdat)
+  {
+    get_pinfo(i, pdat);
+
+    pdat.hsml    = SPH_KNN_SEARCH_FACTOR * Tp->SphP[i].Hsml;
+    pdat.hsml2   = pdat.hsml * pdat.hsml;
+    pdat.inthsml = pdat.hsml * Tp->FacCoordToInt;
+
+    for(int i = 0; i < 3; i++)
+      {
+        pdat.search_min[i]   = pdat.searchcenter[i] - pdat.inthsml;
+        pdat.search_range[i] = pdat.inthsml + pdat.inthsml;
+      }
+  }
+#endif
+
   struct ngbdata_density
   {
     MyIntPosType *IntPos;
@@ -84,6 +110,9 @@ class sph : public ngbtree
 #endif
 #ifdef TIMEDEP_ART_VISC
     MyDouble Csnd;
+#endif
+#ifdef SPH_KNN_HSML
+    double R; /* distance to the target */
 #endif
   };
 
@@ -111,6 +140,11 @@ class sph : public ngbtree
   inline int sph_density_evaluate_particle_node_opening_criterion(pinfo &pdat, ngbnode *nop);
   inline void sph_density_check_particle_particle_interaction(pinfo &pdat, int p, int p_type, unsigned char shmrank);
   inline void clear_density_result(sph_particle_data *SphP);
+#ifdef SPH_KNN_HSML
+  void density_knn_select_hsml(pinfo &pdat);
+  void density_knn_discard_outside_hsml(pinfo &pdat);
+  double density_knn_numngb(pinfo &pdat, double h, double mass, double *dnumngb_dh);
+#endif
 
   void hydro_evaluate_kernel(pinfo &pdat);
   inline void sph_hydro_interact(pinfo &pdat, int no, char no_type, unsigned char shmrank, int mintopleafnode, int committed);
@@ -344,6 +344,14 @@ void fof<partset>::subfind_find_subhalos(int num, const char *basename, const ch
   // some log-variables
   count_decisions           = 0;
   count_different_decisions = 0;
+  unbind_count_calls        = 0;
+  unbind_count_phases_full  = 0;
+  unbind_count_phases_delta = 0;
+  unbind_count_pot_full     = 0;
+  unbind_count_pot_delta    = 0;
+  unbind_time_pot_full      = 0;
+  unbind_time_pot_delta     = 0;
+  unbind_time_energies      = 0;
 
   /* allocate storage space for locally found subhalos */
   Nsubhalos = 0;
@@ -418,6 +426,17 @@ void fof<partset>::subfind_find_subhalos(int num, const char *basename, const ch
 
 #endif
 
+  long long unbind_counts[5] = {unbind_count_calls, unbind_count_phases_full, unbind_count_phases_delta, unbind_count_pot_full,
+                                unbind_count_pot_delta};
+  double unbind_times[3]     = {unbind_time_pot_full, unbind_time_pot_delta, unbind_time_energies};
+  MPI_Allreduce(MPI_IN_PLACE, unbind_counts, 5, MPI_LONG_LONG, MPI_SUM, Communicator);
+  MPI_Allreduce(MPI_IN_PLACE, unbind_times, 3, MPI_DOUBLE, MPI_SUM, Communicator);
+  mpi_printf(
+      "SUBFIND: unbinding: %lld calls, full potential for %lld particles in %lld phases (%g sec), delta updates for %lld particles in "
+      "%lld phases (%g sec), binding energies %g sec (times summed over tasks)\n",
+      unbind_counts[0], unbind_counts[3], unbind_counts[1], unbind_times[0], unbind_counts[4], unbind_counts[2], unbind_times[1],
+      unbind_times[2]);
+
   /* reestablish consistent global values for Sp.MaxPart/MaxPartSph in case they have diverged
    * in the subcommunicators
    */
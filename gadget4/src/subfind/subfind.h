@@ -22,6 +22,8 @@
 
 #define MAX_ITER_UNBIND 500
 
+#define SUBFIND_MIN_NUM_FOR_THREADS 2000 /* with THREADS_PER_MPI_RANK > 1, smaller groups are still unbound by a single thread */
+
 #define TAG_POLLING_DONE 201
 #define TAG_SET_ALL 202
 #define TAG_GET_NGB_INDICES 204
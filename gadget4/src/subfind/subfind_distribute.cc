@@ -101,21 +101,8 @@ void fof<partset>::subfind_distribute_groups(void)
       Group      = (group_properties *)Mem.myrealloc_movable(Group, sizeof(group_properties) * MaxNgroups);
     }
 
-  for(int ngrp = 1; ngrp < (1 << PTask); ngrp++)
-    {
-      int recvTask = ThisTask ^ ngrp;
-
-      if(recvTask < NTask)
-        {
-          if(Send_count[recvTask] > 0 || Recv_count[recvTask] > 0)
-            {
-              /* get the group info */
-              myMPI_Sendrecv(&send_Group[Send_offset[recvTask]], Send_count[recvTask] * sizeof(group_properties), MPI_BYTE, recvTask,
-                           TAG_DENS_A, &Group[Ngroups + Recv_offset[recvTask]], Recv_count[recvTask] * sizeof(group_properties),
-                           MPI_BYTE, recvTask, TAG_DENS_A, Communicator, MPI_STATUS_IGNORE);
-            }
-        }
-    }
+  myMPI_Sparse_alltoallv(send_Group, Send_count, Send_offset, Group + Ngroups, Recv_count, Recv_offset, sizeof(group_properties),
+                         TAG_DENS_A, Communicator);
 
   Ngroups += nimport;
 
@@ -259,24 +246,9 @@ void fof<partset>::subfind_distribute_particles(MPI_Comm Communicator)
   Mem.myfree(requests);
 
 #else
-  for(int ngrp = 1; ngrp < (1 << PTask); ngrp++)
-    {
-      int target = CommThisTask ^ ngrp;
-
-      if(target < CommNTask)
-        {
-          if(Send_count[target] > 0 || Recv_count[target] > 0)
-            {
-              myMPI_Sendrecv(partBuf + Send_offset[target], Send_count[target] * sizeof(typename partset::pdata), MPI_BYTE, target,
-                             TAG_PDATA, Tp->P + Recv_offset[target], Recv_count[target] * sizeof(typename partset::pdata), MPI_BYTE,
-                             target, TAG_PDATA, Communicator, MPI_STATUS_IGNORE);
-
-              myMPI_Sendrecv(subBuf + Send_offset[target], Send_count[target] * sizeof(subfind_data), MPI_BYTE, target, TAG_KEY,
-                             Tp->PS + Recv_offset[target], Recv_count[target] * sizeof(subfind_data), MPI_BYTE, target, TAG_KEY,
-                             Communicator, MPI_STATUS_IGNORE);
-            }
-        }
-    }
+  myMPI_Sparse_alltoallv(partBuf, Send_count, Send_offset, Tp->P, Recv_count, Recv_offset, sizeof(typename partset::pdata), TAG_PDATA,
+                         Communicator);
+  myMPI_Sparse_alltoallv(subBuf, Send_count, Send_offset, Tp->PS, Recv_count, Recv_offset, sizeof(subfind_data), TAG_KEY, Communicator);
 #endif
 
   Tp->NumPart += nimport;
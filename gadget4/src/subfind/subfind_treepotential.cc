@@ -297,6 +297,15 @@ void fof<partset>::subfind_potential_compute(domain<partset> *SubDomain, int num
   /* create an object for handling the communication */
   potdata_comm<gravtree<partset>, domain<partset>, partset> commpattern{SubDomain, &FoFGravTree, Tp};
 
+#if THREADS_PER_MPI_RANK > 1
+  /* groups processed by a single task need no exports, hence their particles can be shared out among threads */
+  if(SubDomain->NTask == 1 && num >= SUBFIND_MIN_NUM_FOR_THREADS)
+    {
+      commpattern.execute_local_threads(num, darg, THREADS_PER_MPI_RANK);
+      return;
+    }
+#endif
+
   commpattern.execute(num, darg, MODE_DEFAULT);
 }
 
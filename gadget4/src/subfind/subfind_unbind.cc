@@ -28,6 +28,7 @@
 #include "../domain/domain.h"
 #include "../fof/fof.h"
 #include "../gravtree/gravtree.h"
+#include "../logs/logs.h"
 #include "../logs/timer.h"
 #include "../main/simulation.h"
 #include "../mpi_utils/mpi_utils.h"
@@ -36,6 +37,7 @@
 #include "../sort/peano.h"
 #include "../subfind/subfind.h"
 #include "../system/system.h"
+#include "../system/worker_threads.h"
 
 #define MAX_UNBOUND_FRAC_BEFORE_BULK_VELOCITY_UPDATE 0.02
 #define MAX_UNBOUND_FRAC_BEFORE_POTENTIAL_UPDATE 0.20
@@ -72,8 +74,13 @@ int fof<partset>::subfind_unbind(domain<partset> *D, MPI_Comm Communicator, int
   int *dremoved  = (int *)Mem.mymalloc("dremoved", num * sizeof(int));
   double *potold = (double *)Mem.mymalloc("potold", num * sizeof(double));
 
+  if(commThisTask == 0)
+    unbind_count_calls++;
+
   do
     {
+      double t0 = Logs.second();
+
       FoFGravTree.treeallocate(Tp->NumPart, Tp, D);
 
       if(phaseflag == RECOMPUTE_ALL)
@@ -93,6 +100,23 @@ int fof<partset>::subfind_unbind(domain<partset> *D, MPI_Comm Communicator, int
 
       FoFGravTree.treefree();
 
+      double t1 = Logs.second();
+
+      if(phaseflag == RECOMPUTE_ALL)
+        {
+          unbind_count_pot_full += num;
+          unbind_time_pot_full += Logs.timediff(t0, t1);
+          if(commThisTask == 0)
+            unbind_count_phases_full++;
+        }
+      else
+        {
+          unbind_count_pot_delta += num;
+          unbind_time_pot_delta += Logs.timediff(t0, t1);
+          if(commThisTask == 0)
+            unbind_count_phases_delta++;
+        }
+
       if(phaseflag == RECOMPUTE_ALL)
         {
           /* subtract self-potential and convert to physical potential */
@@ -192,36 +216,47 @@ int fof<partset>::subfind_unbind(domain<partset> *D, MPI_Comm Communicator, int
           int_cm[1] = off[1] + intpos[1];
           int_cm[2] = off[2] + intpos[2];
 
+          double t2 = Logs.second();
+
           double *bnd_energy = (double *)Mem.mymalloc("bnd_energy", num * sizeof(double));
 
           /* calculate the binding energies */
-          for(int i = 0; i < num; i++)
-            {
-              int part_index = d[i];
-
-              /* distance to center of mass */
-              double dx[3];
-              Tp->nearest_image_intpos_to_pos(P[part_index].IntPos, int_cm, dx);
-
-              /* get physical velocity relative to center of mass */
-              double dv[3];
-              for(int j = 0; j < 3; j++)
-                {
-                  dv[j] = fac_vel_to_phys * (P[part_index].Vel[j] - v[j]);
-                  dv[j] += fac_hubbleflow * fac_comov_to_phys * dx[j];
-                }
-
-              PS[part_index].v.DM_BindingEnergy =
-                  PS[part_index].u.s.u.DM_Potential + 0.5 * (dv[0] * dv[0] + dv[1] * dv[1] + dv[2] * dv[2]);
+          auto binding_energies = [&](int first, int last) {
+            for(int i = first; i < last; i++)
+              {
+                int part_index = d[i];
+
+                /* distance to center of mass */
+                double dx[3];
+                Tp->nearest_image_intpos_to_pos(P[part_index].IntPos, int_cm, dx);
+
+                /* get physical velocity relative to center of mass */
+                double dv[3];
+                for(int j = 0; j < 3; j++)
+                  {
+                    dv[j] = fac_vel_to_phys * (P[part_index].Vel[j] - v[j]);
+                    dv[j] += fac_hubbleflow * fac_comov_to_phys * dx[j];
+                  }
+
+                PS[part_index].v.DM_BindingEnergy =
+                    PS[part_index].u.s.u.DM_Potential + 0.5 * (dv[0] * dv[0] + dv[1] * dv[1] + dv[2] * dv[2]);
 #ifndef LEAN
-              if(P[part_index].getType() == 0)
-                PS[part_index].v.DM_BindingEnergy += PS[part_index].Utherm;
+                if(P[part_index].getType() == 0)
+                  PS[part_index].v.DM_BindingEnergy += PS[part_index].Utherm;
 #endif
-              bnd_energy[i] = PS[part_index].v.DM_BindingEnergy;
-            }
-
-          /* sort by binding energy, highest energies (num_unbound / most weakly bound) first */
-          mycxxsort_parallel(bnd_energy, bnd_energy + num, subfind_compare_binding_energy, Communicator);
+                bnd_energy[i] = PS[part_index].v.DM_BindingEnergy;
+              }
+          };
+
+#if THREADS_PER_MPI_RANK > 1
+          if(num >= SUBFIND_MIN_NUM_FOR_THREADS)
+            run_worker_threads(THREADS_PER_MPI_RANK, [&](int thread) {
+              binding_energies((((long long)num) * thread) / THREADS_PER_MPI_RANK,
+                               (((long long)num) * (thread + 1)) / THREADS_PER_MPI_RANK);
+            });
+          else
+#endif
+            binding_energies(0, num);
 
           int *npart = (int *)Mem.mymalloc("npart", commNTask * sizeof(int));
           MPI_Allgather(&num, 1, MPI_INT, npart, 1, MPI_INT, Communicator);
@@ -238,6 +273,14 @@ int fof<partset>::subfind_unbind(domain<partset> *D, MPI_Comm Communicator, int
               task++;
             }
 
+          /* sort by binding energy, highest energies (num_unbound / most weakly bound) first. On a single task, we only
+           * need the energy at index j, which a partial selection delivers in linear time.
+           */
+          if(commNTask == 1 && j < num)
+            std::nth_element(bnd_energy, bnd_energy + j, bnd_energy + num, subfind_compare_binding_energy);
+          else
+            mycxxsort_parallel(bnd_energy, bnd_energy + num, subfind_compare_binding_energy, Communicator);
+
           double energy_limit = MAX_DOUBLE_NUMBER;
 
           if(commThisTask == task)
@@ -267,6 +310,8 @@ int fof<partset>::subfind_unbind(domain<partset> *D, MPI_Comm Communicator, int
           Mem.myfree(npart);
           Mem.myfree(bnd_energy);
 
+          unbind_time_energies += Logs.timediff(t2, Logs.second());
+
           totunbound = num_unbound;
           totremoved = num_removed;
           totnum     = num;
@@ -282,11 +327,15 @@ int fof<partset>::subfind_unbind(domain<partset> *D, MPI_Comm Communicator, int
       if(iter > MAX_ITER_UNBIND)
         Terminate("too many iterations");
 
+      /* unless SUBFIND_UNBIND_DELTA_UPDATES is set, a converged sequence of update phases is verified with a final
+       * recomputation of the potential from scratch
+       */
       if(phaseflag == RECOMPUTE_ALL)
         {
           if(totremoved > 0)
             phaseflag = UPDATE_ALL;
         }
+#ifndef SUBFIND_UNBIND_DELTA_UPDATES
       else
         {
           if(totremoved == 0)
@@ -295,6 +344,7 @@ int fof<partset>::subfind_unbind(domain<partset> *D, MPI_Comm Communicator, int
               totremoved = 1;             /* to make the code check once more all particles */
             }
         }
+#endif
     }
   while(totremoved > 0 && totnum >= All.DesLinkNgb);
 
@@ -11,6 +11,7 @@
 
 #include "gadgetconfig.h"
 
+#include <algorithm>
 #include <gsl/gsl_rng.h>
 #include <math.h>
 #include <mpi.h>
@@ -163,6 +164,22 @@ void pinning::pin_to_core_set(setcomm *sc)
   hwloc_obj_t obj            = hwloc_get_obj_by_depth(topology, depth, cid);
   hwloc_cpuset_t current_cpu = hwloc_bitmap_dup(obj->cpuset);
 
+#if THREADS_PER_MPI_RANK > 1
+  /* the threads of this task should be able to run on the following available logical cores as well */
+  int nbind = std::min<int>(THREADS_PER_MPI_RANK, pus_per_task);
+
+  for(int n = 1, id = cid + 1; n < nbind && id < pus; id++)
+    {
+      hwloc_obj_t obj_next = hwloc_get_obj_by_depth(topology, depth, id);
+
+      if(hwloc_bitmap_isincluded(obj_next->cpuset, cpuset))
+        {
+          hwloc_bitmap_or(current_cpu, current_cpu, obj_next->cpuset);
+          n++;
+        }
+    }
+#endif
+
   hwloc_set_proc_cpubind(topology, getpid(), current_cpu, HWLOC_CPUBIND_PROCESS);
 #endif
 }
@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * \copyright   This file is part of the GADGET4 N-body/SPH code developed
+ * \copyright   by Volker Springel. Copyright (C) 2014-2020 by Volker Springel
+ * \copyright   (vspringel@mpa-garching.mpg.de) and all contributing authors.
+ *******************************************************************************/
+
+/*! \file  worker_threads.h
+ *
+ *  \brief declares a simple fork/join helper for worker threads and a work-stealing scheduler for index ranges
+ */
+
+#ifndef WORKER_THREADS_H
+#define WORKER_THREADS_H
+
+#include "gadgetconfig.h"
+
+#include <atomic>
+#include <thread>
+
+#include "../data/constants.h"
+
+/*! Runs func(thread_index) on nthreads threads and returns once all of them have finished. The calling thread takes part
+ *  in the work as thread 0, so that for nthreads=1 no extra thread is ever created. Worker threads must not issue MPI calls
+ *  and must not allocate memory through the Mem object.
+ */
+template <typename Func>
+inline void run_worker_threads(int nthreads, Func func)
+{
+  std::thread workers[MAX_THREADS];
+
+  for(int t = 1; t < nthreads; t++)
+    workers[t] = std::thread(func, t);
+
+  func(0);
+
+  for(int t = 1; t < nthreads; t++)
+    workers[t].join();
+}
+
+/*! This class hands out the indices 0...N-1 to a set of threads. Initially, every thread owns a contiguous range of
+ *  indices which it works through from the front. Once its range is exhausted, a thread steals the upper half of the range
+ *  of the thread that has most remaining work. A spin lock per range protects it against concurrent modification.
+ */
+class workstealing_scheduler
+{
+ private:
+  struct alignas(64) range /* aligned such that different threads do not share cache lines */
+  {
+    std::atomic_flag lock;
+    int next;
+    int end;
+  };
+
+  range Ranges[MAX_THREADS];
+  int NThreads;
+
+  inline void lock_range(range &r)
+  {
+    while(r.lock.test_and_set(std::memory_order_acquire))
+      ;
+  }
+
+  inline void unlock_range(range &r) { r.lock.clear(std::memory_order_release); }
+
+ public:
+  void init(int nitems, int nthreads)
+  {
+    NThreads = nthreads;
+
+    for(int t = 0; t < nthreads; t++)
+      {
+        Ranges[t].lock.clear();
+        Ranges[t].next = (int)((((long long)nitems) * t) / nthreads);
+        Ranges[t].end  = (int)((((long long)nitems) * (t + 1)) / nthreads);
+      }
+  }
+
+  /*! Gives the next index to be processed by thread 'thread'. Returns false if no work is left anywhere. */
+  bool get_next(int thread, int &index)
+  {
+    range &own = Ranges[thread];
+
+    lock_range(own);
+    if(own.next < own.end)
+      {
+        index = own.next++;
+        unlock_range(own);
+        return true;
+      }
+    unlock_range(own);
+
+    while(true)
+      {
+        /* find the victim with the largest number of remaining items (this is only a hint, it is checked again under the lock) */
+        int victim = -1, maxleft = 0;
+
+        for(int t = 0; t < NThreads; t++)
+          if(t != thread)
+            {
+              int left = Ranges[t].end - Ranges[t].next;
+              if(left > maxleft)
+                {
+                  maxleft = left;
+                  victim  = t;
+                }
+            }
+
+        if(victim < 0)
+          return false;
+
+        range &vic = Ranges[victim];
+
+        lock_range(vic);
+        int left = vic.end - vic.next;
+        if(left <= 0)
+          {
+            unlock_range(vic);
+            continue;
+          }
+        int nsteal = (left + 1) / 2;
+        int end    = vic.end;
+        vic.end -= nsteal;
+        unlock_range(vic);
+
+        lock_range(own);
+        own.next = end - nsteal;
+        own.end  = end;
+        index    = own.next++;
+        unlock_range(own);
+
+        return true;
+      }
+  }
+};
+
+#endif
@@ -452,6 +452,9 @@ void sim::do_hydro_step_first_half(void)
     {
       Sp.mark_active_timebins();
 
+#ifdef GRAVITY_TREE_REUSE
+      gravity_free_kept_tree();
+#endif
       NgbTree.treefree();
 
       Domain.domain_free();
@@ -0,0 +1,201 @@
+/*******************************************************************************
+ * \copyright   This file is part of the GADGET4 N-body/SPH code developed
+ * \copyright   by Volker Springel. Copyright (C) 2014-2020 by Volker Springel
+ * \copyright   (vspringel@mpa-garching.mpg.de) and all contributing authors.
+ *******************************************************************************/
+
+/*! \file test_particle_layout.cc
+ *
+ * \brief test routines comparing the drift/kick throughput of the particle structure with hot/cold split and SoA layouts
+ */
+
+#include "gadgetconfig.h"
+
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../data/allvars.h"
+#include "../data/dtypes.h"
+#include "../data/mymalloc.h"
+#include "../logs/logs.h"
+#include "../mpi_utils/mpi_utils.h"
+#include "../system/system.h"
+#include "../time_integration/test_particle_layout.h"
+
+/*! \brief Measures the drift+kick throughput for three storage layouts of the same particle set
+ *
+ * The particles are synthetic, and each sweep kicks the velocities with a fixed acceleration and then drifts the integer
+ * positions, which is the memory access pattern of the collisionless part of kicks.cc and predict.cc. The layouts are the
+ * full particle_data structure used by the code, a structure holding only the fields touched here, and separate arrays for
+ * each field. All three have to end up with identical positions, which is checked via a checksum.
+ */
+void test_particle_layout::measure_particle_layout(void)
+{
+  RegionLen     = (All.BoxSize > 0) ? All.BoxSize : 1.0;
+  FacCoordToInt = pow(2.0, BITS_FOR_POSITIONS) / RegionLen;
+  FacIntToCoord = RegionLen / pow(2.0, BITS_FOR_POSITIONS);
+
+  Npart = LAYOUT_TEST_NPART;
+
+  mpi_printf("LAYOUT: Measuring drift+kick throughput for %d particles per task, %d sweeps per layout\n", Npart,
+             LAYOUT_TEST_REPEAT);
+  mpi_printf("LAYOUT: sizeof(particle_data)=%d  sizeof(hot_particle_data)=%d  [bytes]\n", (int)sizeof(particle_data),
+             (int)sizeof(hot_particle_data));
+
+  particle_data *P       = (particle_data *)Mem.mymalloc_clear("P", Npart * sizeof(particle_data));
+  hot_particle_data *Hot = (hot_particle_data *)Mem.mymalloc_clear("Hot", Npart * sizeof(hot_particle_data));
+
+  soa_particle_data Soa;
+  for(int j = 0; j < 3; j++)
+    {
+      Soa.IntPos[j]    = (MyIntPosType *)Mem.mymalloc("Soa.IntPos", Npart * sizeof(MyIntPosType));
+      Soa.Vel[j]       = (MyFloat *)Mem.mymalloc("Soa.Vel", Npart * sizeof(MyFloat));
+      Soa.GravAccel[j] = (MyFloat *)Mem.mymalloc("Soa.GravAccel", Npart * sizeof(MyFloat));
+    }
+  Soa.Ti_Current = (integertime *)Mem.mymalloc("Soa.Ti_Current", Npart * sizeof(integertime));
+
+  /* set up identical initial conditions in all three layouts */
+  for(int i = 0; i < Npart; i++)
+    {
+      unsigned long long seed = (unsigned long long)(ThisTask + 1) * 6364136223846793005ULL + i * 1442695040888963407ULL;
+
+      for(int j = 0; j < 3; j++)
+        {
+          seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+          MyIntPosType pos = (MyIntPosType)(seed >> (64 - BITS_FOR_POSITIONS));
+          MyFloat vel      = ((seed >> 11) & 0xffff) / 65536.0 - 0.5;
+          MyFloat acc      = ((seed >> 27) & 0xffff) / 65536.0 - 0.5;
+
+          P[i].IntPos[j] = Hot[i].IntPos[j] = Soa.IntPos[j][i] = pos;
+          P[i].Vel[j] = Hot[i].Vel[j] = Soa.Vel[j][i] = vel;
+          P[i].GravAccel[j] = Hot[i].GravAccel[j] = Soa.GravAccel[j][i] = acc;
+        }
+
+      P[i].Ti_Current = Hot[i].Ti_Current = Soa.Ti_Current[i] = 0;
+    }
+
+  double dt_drift = 1.0e-3 * RegionLen;
+  double dt_kick  = 1.0e-3;
+
+  for(int layout = 0; layout < 3; layout++)
+    {
+      /* one untimed sweep to fault in the pages and warm the caches equally for all layouts */
+      if(layout == 0)
+        drift_kick_full(P, dt_drift, dt_kick, 0);
+      else if(layout == 1)
+        drift_kick_hot(Hot, dt_drift, dt_kick, 0);
+      else
+        drift_kick_soa(&Soa, dt_drift, dt_kick, 0);
+
+      MPI_Barrier(Communicator);
+      double t0 = Logs.second();
+
+      for(int rep = 1; rep <= LAYOUT_TEST_REPEAT; rep++)
+        {
+          if(layout == 0)
+            drift_kick_full(P, dt_drift, dt_kick, rep);
+          else if(layout == 1)
+            drift_kick_hot(Hot, dt_drift, dt_kick, rep);
+          else
+            drift_kick_soa(&Soa, dt_drift, dt_kick, rep);
+        }
+
+      double t1 = Logs.second();
+
+      unsigned long long checksum = 0;
+      for(int i = 0; i < Npart; i++)
+        for(int j = 0; j < 3; j++)
+          {
+            MyIntPosType pos = (layout == 0) ? P[i].IntPos[j] : (layout == 1 ? Hot[i].IntPos[j] : Soa.IntPos[j][i]);
+            checksum         = checksum * 31 + (unsigned long long)pos;
+          }
+
+      if(layout == 0)
+        report("particle_data", Logs.timediff(t0, t1), sizeof(particle_data), checksum);
+      else if(layout == 1)
+        report("hot/cold split", Logs.timediff(t0, t1), sizeof(hot_particle_data), checksum);
+      else
+        report("SoA", Logs.timediff(t0, t1), 3 * sizeof(MyIntPosType) + 6 * sizeof(MyFloat) + sizeof(integertime), checksum);
+    }
+
+  Mem.myfree(Soa.Ti_Current);
+  for(int j = 2; j >= 0; j--)
+    {
+      Mem.myfree(Soa.GravAccel[j]);
+      Mem.myfree(Soa.Vel[j]);
+      Mem.myfree(Soa.IntPos[j]);
+    }
+  Mem.myfree(Hot);
+  Mem.myfree(P);
+
+  mpi_printf("\n\nLAYOUT: Completed.\n");
+
+  fflush(stdout);
+}
+
+void test_particle_layout::drift_kick_full(particle_data *P, double dt_drift, double dt_kick, integertime ti)
+{
+  for(int i = 0; i < Npart; i++)
+    {
+      for(int j = 0; j < 3; j++)
+        {
+          P[i].Vel[j] += P[i].GravAccel[j] * dt_kick;
+          P[i].IntPos[j] += pos_to_signedintpos(P[i].Vel[j] * dt_drift);
+        }
+
+      P[i].Ti_Current = ti;
+    }
+}
+
+void test_particle_layout::drift_kick_hot(hot_particle_data *Hot, double dt_drift, double dt_kick, integertime ti)
+{
+  for(int i = 0; i < Npart; i++)
+    {
+      for(int j = 0; j < 3; j++)
+        {
+          Hot[i].Vel[j] += Hot[i].GravAccel[j] * dt_kick;
+          Hot[i].IntPos[j] += pos_to_signedintpos(Hot[i].Vel[j] * dt_drift);
+        }
+
+      Hot[i].Ti_Current = ti;
+    }
+}
+
+void test_particle_layout::drift_kick_soa(soa_particle_data *Soa, double dt_drift, double dt_kick, integertime ti)
+{
+  for(int j = 0; j < 3; j++)
+    {
+      MyIntPosType *intpos = Soa->IntPos[j];
+      MyFloat *vel         = Soa->Vel[j];
+      MyFloat *acc         = Soa->GravAccel[j];
+
+      for(int i = 0; i < Npart; i++)
+        {
+          vel[i] += acc[i] * dt_kick;
+          intpos[i] += pos_to_signedintpos(vel[i] * dt_drift);
+        }
+    }
+
+  for(int i = 0; i < Npart; i++)
+    Soa->Ti_Current[i] = ti;
+}
+
+void test_particle_layout::report(const char *layout, double t, size_t bytes_per_particle, unsigned long long checksum)
+{
+  double tmax;
+  MPI_Allreduce(&t, &tmax, 1, MPI_DOUBLE, MPI_MAX, Communicator);
+
+  unsigned long long checksum_all;
+  MPI_Allreduce(&checksum, &checksum_all, 1, MPI_UNSIGNED_LONG_LONG, MPI_BXOR, Communicator);
+
+  double nsweep = ((double)Npart) * NTask * LAYOUT_TEST_REPEAT;
+
+  mpi_printf(
+      "LAYOUT: %-16s  took %8.4f sec, %9.3f Mparticles/sec per task, %3d bytes per particle (%8.1f MB/sec per task)  checksum=%llx\n",
+      layout, tmax, nsweep / NTask / tmax / 1.0e6, (int)bytes_per_particle,
+      nsweep / NTask * bytes_per_particle / tmax / (1024.0 * 1024.0), checksum_all);
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * \copyright   This file is part of the GADGET4 N-body/SPH code developed
+ * \copyright   by Volker Springel. Copyright (C) 2014-2020 by Volker Springel
+ * \copyright   (vspringel@mpa-garching.mpg.de) and all contributing authors.
+ *******************************************************************************/
+
+/*! \file test_particle_layout.h
+ *
+ * \brief declares a class that measures the drift/kick throughput of different particle storage layouts
+ */
+
+#ifndef TEST_PARTICLE_LAYOUT_H
+#define TEST_PARTICLE_LAYOUT_H
+
+#include "gadgetconfig.h"
+
+#include <mpi.h>
+
+#include "../data/dtypes.h"
+#include "../data/intposconvert.h"
+#include "../data/particle_data.h"
+#include "../mpi_utils/setcomm.h"
+
+#define LAYOUT_TEST_NPART (1 << 20) /* number of synthetic particles per MPI rank */
+#define LAYOUT_TEST_REPEAT 10       /* number of drift/kick sweeps timed for each layout */
+
+class test_particle_layout : public intposconvert, public virtual setcomm
+{
+ public:
+  test_particle_layout(MPI_Comm comm) : setcomm(comm) {}
+
+  void measure_particle_layout(void);
+
+ private:
+  /* only the fields touched by drift and kick, stored contiguously per particle (hot/cold split) */
+  struct hot_particle_data
+  {
+    MyIntPosType IntPos[3];
+    MyFloat Vel[3];
+    MyFloat GravAccel[3];
+    integertime Ti_Current;
+  };
+
+  /* the same fields as separate arrays (structure of arrays) */
+  struct soa_particle_data
+  {
+    MyIntPosType *IntPos[3];
+    MyFloat *Vel[3];
+    MyFloat *GravAccel[3];
+    integertime *Ti_Current;
+  };
+
+  int Npart;
+
+  void drift_kick_full(particle_data *P, double dt_drift, double dt_kick, integertime ti);
+  void drift_kick_hot(hot_particle_data *Hot, double dt_drift, double dt_kick, integertime ti);
+  void drift_kick_soa(soa_particle_data *Soa, double dt_drift, double dt_kick, integertime ti);
+
+  void report(const char *layout, double t, size_t bytes_per_particle, unsigned long long checksum);
+};
+
+#endif
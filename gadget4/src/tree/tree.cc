@@ -116,6 +116,545 @@ int tree<node, partset, point_data, foreign_point_data>::treebuild(int ninsert,
 
   TIMER_STOPSTART(CPU_TREEBUILD, CPU_TREEBUILD_BRANCHES);
 
+  treebuild_node_properties();
+
+  double t1 = Logs.second();
+  Buildtime = Logs.timediff(t0, t1);
+
+  report_log_message();
+
+  TIMER_STOP(CPU_TREEBUILD_TOPLEVEL);
+
+  return NumNodes;
+}
+
+#ifdef GRAVITY_TREE_REUSE
+/*! This function tries to update a tree that was constructed on an earlier step for the current particle positions, instead of
+ *  constructing it from scratch. All particles are drifted, and every particle that is still contained in the node it is
+ *  attached to stays in place. The other particles (as well as all imported points, which are exchanged anew) are unlinked from
+ *  their node, and are then linked directly into the smallest existing node that contains their new position. This may be in a
+ *  different top-level node, or on a different task, in which case the particle is exported. Only if this would put more than
+ *  TREE_NUM_BEFORE_NODESPLIT particles into the same octant of a node, the branch below this node is constructed anew.
+ *  Finally, the multipole moments of all nodes are recomputed. The update is refused (and a full construction is required) if
+ *  the particle set has changed, if more than a fraction TREE_MAX_REINSERT_FRAC of all particles would need to be relinked,
+ *  or if the storage for the nodes is exhausted.
+ *
+ *  \return number of local nodes (including top level nodes, and unused nodes left behind by earlier updates) if successful \n
+ *          -1 if a full tree construction is needed
+ */
+template <typename node, typename partset, typename point_data, typename foreign_point_data>
+int tree<node, partset, point_data, foreign_point_data>::treeupdate(void)
+{
+  /* the update is only possible if the tree was built for all particles, and the particle set is still the same */
+  int flag_single = 0, flag;
+  if(MaxPart == 0 || Nodes == NULL || IndexList != NULL || Ninsert != Tp->NumPart)
+    flag_single = 1;
+
+  MPI_Allreduce(&flag_single, &flag, 1, MPI_INT, MPI_MAX, D->Communicator);
+  if(flag)
+    return -1;
+
+  TIMER_START(CPU_TREEBUILD);
+
+  double t0 = Logs.second();
+
+  TIMER_START(CPU_TREEBUILD_INSERT);
+
+  int *node_list = (int *)Mem.mymalloc_movable(&node_list, "node_list", Tp->NumPart * sizeof(int));
+  int *task_list = (int *)Mem.mymalloc_movable(&task_list, "task_list", Tp->NumPart * sizeof(int));
+  int *target    = (int *)Mem.mymalloc_movable(&target, "target", Tp->NumPart * sizeof(int));
+
+  for(int j = 0; j < D->NTask; j++)
+    Send_count[j] = 0;
+
+  /* drift the particles, and unlink those that have left their node. target[] is set to the top-level node for particles that
+   * need to be linked in again locally, and is -1 otherwise. For particles that are inserted on another task, Father[] holds
+   * this task.
+   */
+  int nmoved = 0;
+
+  for(int i = 0; i < Tp->NumPart; i++)
+    {
+      if(Tp->P[i].get_Ti_Current() != All.Ti_Current)
+        Tp->drift_particle(&Tp->P[i], &Tp->SphP[i], All.Ti_Current);
+
+      int no, task;
+      tree_get_node_and_task(i, no, task);
+
+      node_list[i] = no;
+      task_list[i] = task;
+      target[i]    = -1;
+
+      if(task != D->ThisTask)
+        Send_count[task]++;
+
+      if(Father[i] >= 0)
+        {
+          if(tree_node_contains_point(Father[i], Tp->P[i].IntPos))
+            continue;
+
+          treeupdate_unlink_point(i);
+          nmoved++;
+        }
+      else if(task == D->ThisTask)
+        nmoved++;
+
+      if(task == D->ThisTask)
+        target[i] = NodeIndex[no];
+      else
+        Father[i] = -1 - task;
+    }
+
+  /* the previously imported points are all replaced */
+  for(int n = 0; n < NumPartImported; n++)
+    treeupdate_unlink_point(n + ImportedNodeOffset);
+
+  /* now exchange the points that need to be inserted on other tasks */
+  myMPI_Alltoall(Send_count, 1, MPI_INT, Recv_count, 1, MPI_INT, D->Communicator);
+
+  NumPartImported = 0;
+  NumPartExported = 0;
+  Recv_offset[0]  = 0;
+  Send_offset[0]  = 0;
+
+  for(int j = 0; j < D->NTask; j++)
+    {
+      NumPartImported += Recv_count[j];
+      NumPartExported += Send_count[j];
+      if(j > 0)
+        {
+          Send_offset[j] = Send_offset[j - 1] + Send_count[j - 1];
+          Recv_offset[j] = Recv_offset[j - 1] + Recv_count[j - 1];
+        }
+    }
+
+  Points   = (point_data *)Mem.myrealloc_movable(Points, NumPartImported * sizeof(point_data));
+  Nextnode = (int *)Mem.myrealloc_movable(Nextnode, (MaxPart + D->NTopleaves + NumPartImported) * sizeof(int));
+  Father   = (int *)Mem.myrealloc_movable(Father, (MaxPart + NumPartImported) * sizeof(int));
+
+  point_data *export_Points =
+      (point_data *)Mem.mymalloc_movable(&export_Points, "export_Points", NumPartExported * sizeof(point_data));
+
+  for(int j = 0; j < D->NTask; j++)
+    Send_count[j] = 0;
+
+  for(int i = 0; i < Tp->NumPart; i++)
+    if(task_list[i] != D->ThisTask)
+      {
+        int task = task_list[i];
+        int n    = Send_offset[task] + Send_count[task]++;
+
+        fill_in_export_points(&export_Points[n], i, node_list[i]);
+      }
+
+  myMPI_Sparse_alltoallv(export_Points, Send_count, Send_offset, Points, Recv_count, Recv_offset, sizeof(point_data), TAG_DENS_A,
+                         D->Communicator);
+
+  Mem.myfree_movable(export_Points);
+
+  MPI_Allreduce(&NumPartImported, &EndOfTreePoints, 1, MPI_INT, MPI_MAX, D->Communicator);
+  EndOfTreePoints += ImportedNodeOffset;
+  EndOfForeignNodes = EndOfTreePoints + (INT_MAX - EndOfTreePoints) / 2;
+
+  /* link the moved particles and the imported points into the smallest node containing them. If this is not possible because
+   * the node would have to be split, the node is marked, and the particle is inserted when the node is constructed anew */
+  int numnodes       = NextFreeNode - MaxPart;
+  int *node_mark     = (int *)Mem.mymalloc_movable_clear(&node_mark, "node_mark", numnodes * sizeof(int));
+  int *import_target = (int *)Mem.mymalloc_movable(&import_target, "import_target", NumPartImported * sizeof(int));
+
+  for(int i = 0; i < Tp->NumPart; i++)
+    if(target[i] >= 0)
+      {
+        int no = treeupdate_find_node(target[i], Tp->P[i].IntPos);
+
+        if(treeupdate_link_point(i, no))
+          {
+            node_mark[no - MaxPart] = 1;
+            target[i]               = no;
+          }
+        else
+          target[i] = -1;
+      }
+
+  for(int n = 0; n < NumPartImported; n++)
+    {
+      int no = treeupdate_find_node(NodeIndex[Points[n].no], Points[n].IntPos);
+
+      if(treeupdate_link_point(n + ImportedNodeOffset, no))
+        {
+          node_mark[no - MaxPart] = 1;
+          import_target[n]        = no;
+        }
+      else
+        import_target[n] = -1;
+    }
+
+  /* only the outermost marked nodes need to be reconstructed, as they contain all other marked nodes. These are enumerated
+   * by setting their mark to 2 + index in the list of nodes to reconstruct */
+  int nrebuild      = 0;
+  int *rebuild_list = (int *)Mem.mymalloc_movable(&rebuild_list, "rebuild_list", numnodes * sizeof(int));
+
+  for(int k = 0; k < numnodes; k++)
+    if(node_mark[k])
+      {
+        int no = MaxPart + k;
+
+        while(no >= FirstNonTopLevelNode)
+          {
+            no = get_nodep(no)->father;
+
+            if(node_mark[no - MaxPart])
+              break;
+          }
+
+        if(no == MaxPart + k || !node_mark[no - MaxPart])
+          rebuild_list[nrebuild++] = MaxPart + k;
+      }
+
+  for(int k = 0; k < nrebuild; k++)
+    node_mark[rebuild_list[k] - MaxPart] = 2 + k;
+
+  /* collect the particles below these nodes, and those that still need to go into them, labelled by the node they go to */
+  index_data *index_list =
+      (index_data *)Mem.mymalloc_movable(&index_list, "index_list", (Tp->NumPart + NumPartImported) * sizeof(index_data));
+  int count = 0;
+
+  for(int k = 0; k < nrebuild; k++)
+    {
+      node *nop = get_nodep(rebuild_list[k]);
+
+      int p = nop->nextnode;
+
+      while(p != nop->sibling)
+        {
+          if(p < MaxPart || p >= ImportedNodeOffset) /* a particle or an imported point */
+            {
+              index_list[count].p       = p;
+              index_list[count].subnode = k;
+              count++;
+            }
+
+          if(p < MaxPart) /* a particle */
+            p = Nextnode[p];
+          else if(p < MaxPart + MaxNodes) /* an internal node */
+            p = get_nodep(p)->nextnode;
+          else /* a pseudo particle or an imported point */
+            p = Nextnode[p - MaxNodes];
+        }
+    }
+
+  for(int i = 0; i < Tp->NumPart; i++)
+    if(target[i] >= 0)
+      {
+        index_list[count].p       = i;
+        index_list[count].subnode = treeupdate_find_rebuild_index(target[i], node_mark);
+        count++;
+      }
+
+  for(int n = 0; n < NumPartImported; n++)
+    if(import_target[n] >= 0)
+      {
+        index_list[count].p       = n + ImportedNodeOffset;
+        index_list[count].subnode = treeupdate_find_rebuild_index(import_target[n], node_mark);
+        count++;
+      }
+
+  /* check whether the number of particles that are relinked or reinserted is still small enough */
+  long long loc_count = nmoved + NumPartImported + count, totreinsert, totinsert;
+  MPI_Allreduce(&loc_count, &totreinsert, 1, MPI_LONG_LONG, MPI_SUM, D->Communicator);
+  sumup_large_ints(1, &Ninsert, &totinsert, D->Communicator);
+
+  if(totreinsert <= TREE_MAX_REINSERT_FRAC * totinsert)
+    {
+      /* sort according to node so that the particles that go into the same node are grouped together */
+      mycxxsort(index_list, index_list + count, compare_index_data_subnode);
+
+      for(int k = 0, start = 0; k < nrebuild; k++)
+        {
+          int num = 0;
+          while(start + num < count && index_list[start + num].subnode == k)
+            num++;
+
+          node *nop = get_nodep(rebuild_list[k]);
+
+          if(treebuild_insert_group_of_points(num, &index_list[start], rebuild_list[k], nop->level, nop->sibling))
+            {
+              flag_single = 1; /* we are out of space */
+              break;
+            }
+
+          start += num;
+        }
+    }
+  else
+    flag_single = 1;
+
+  Mem.myfree_movable(index_list);
+  Mem.myfree_movable(rebuild_list);
+  Mem.myfree_movable(import_target);
+  Mem.myfree_movable(node_mark);
+  Mem.myfree_movable(target);
+  Mem.myfree_movable(task_list);
+  Mem.myfree_movable(node_list);
+
+  NumNodes = NextFreeNode - MaxPart;
+
+  MPI_Allreduce(&flag_single, &flag, 1, MPI_INT, MPI_MAX, D->Communicator);
+
+  TIMER_STOP(CPU_TREEBUILD_INSERT);
+
+  if(flag)
+    {
+      D->mpi_printf("TREE: Tree update not possible (particles to relink=%lld of %lld), full construction needed.\n", totreinsert,
+                    totinsert);
+
+      TIMER_STOP(CPU_TREEBUILD);
+
+      return -1;
+    }
+
+  TIMER_STOPSTART(CPU_TREEBUILD, CPU_TREEBUILD_BRANCHES);
+
+  treebuild_node_properties();
+
+  double t1 = Logs.second();
+  Buildtime = Logs.timediff(t0, t1);
+
+  int max_numnodes;
+  MPI_Reduce(&NumNodes, &max_numnodes, 1, MPI_INT, MPI_MAX, 0, D->Communicator);
+
+  D->mpi_printf("TREE: Tree update done, relinked %lld of %lld particles. took %g sec  max(numnodes)=%d  MaxNodes=%d\n", totreinsert,
+                totinsert, Buildtime, max_numnodes, MaxNodes);
+
+  TIMER_STOP(CPU_TREEBUILD_TOPLEVEL);
+
+  return NumNodes;
+}
+
+/*! Starting from the local top-level leaf node 'no', this descends along the daughter nodes of the tree to find the smallest
+ *  existing node that contains the given position.
+ */
+template <typename node, typename partset, typename point_data, typename foreign_point_data>
+int tree<node, partset, point_data, foreign_point_data>::treeupdate_find_node(int no, MyIntPosType *intpos)
+{
+  int p = get_nodep(no)->nextnode;
+
+  while(p >= MaxPart && p < MaxPart + MaxNodes && get_nodep(p)->father == no)
+    {
+      if(tree_node_contains_point(p, intpos))
+        {
+          no = p;
+          p  = get_nodep(no)->nextnode;
+        }
+      else
+        p = get_nodep(p)->sibling;
+    }
+
+  return no;
+}
+
+/*! Removes the particle or imported point 'p' from the list of points attached to its father node. If the node is a
+ *  top-level leaf that becomes empty in this way, the marker of the leaf is put back in place.
+ */
+template <typename node, typename partset, typename point_data, typename foreign_point_data>
+void tree<node, partset, point_data, foreign_point_data>::treeupdate_unlink_point(int p)
+{
+  int *nextp   = (p < MaxPart) ? &Nextnode[p] : &Nextnode[p - MaxNodes];
+  int father   = (p < MaxPart) ? Father[p] : Father[p - MaxNodes - D->NTopleaves];
+  node *fatherp = get_nodep(father);
+
+  if(fatherp->nextnode == p)
+    fatherp->nextnode = *nextp;
+  else
+    {
+      int q = fatherp->nextnode;
+
+      while(true)
+        {
+          if(q == fatherp->sibling)
+            Terminate("point p=%d not found in the list of its father node %d", p, father);
+
+          if(q >= MaxPart && q < MaxPart + MaxNodes) /* a daughter node */
+            {
+              node *nop = get_nodep(q);
+
+              if(nop->sibling == p)
+                {
+                  treeupdate_replace_link(q, p, *nextp);
+                  break;
+                }
+              q = nop->sibling;
+            }
+          else
+            {
+              int *nextq = (q < MaxPart) ? &Nextnode[q] : &Nextnode[q - MaxNodes];
+
+              if(*nextq == p)
+                {
+                  *nextq = *nextp;
+                  break;
+                }
+              q = *nextq;
+            }
+        }
+    }
+
+  if(fatherp->nextnode == fatherp->sibling && father < FirstNonTopLevelNode)
+    {
+      for(int n = 0; n < D->NumTopleafOfTask[D->ThisTask]; n++)
+        {
+          int leaf = D->ListOfTopleaves[D->FirstTopleafOfTask[D->ThisTask] + n];
+
+          if(NodeIndex[leaf] == father)
+            fatherp->nextnode = MaxPart + MaxNodes + leaf;
+        }
+    }
+}
+
+/*! Links the particle or imported point 'p' into the list of points attached to node 'no', which must not contain a daughter
+ *  node in the octant of the point. This is refused if there would be more than TREE_NUM_BEFORE_NODESPLIT points in this
+ *  octant afterwards.
+ *
+ *  \return 0 if the point was linked in \n
+ *          1 if the node needs to be split
+ */
+template <typename node, typename partset, typename point_data, typename foreign_point_data>
+int tree<node, partset, point_data, foreign_point_data>::treeupdate_link_point(int p, int no)
+{
+  node *nop = get_nodep(no);
+
+  MyIntPosType *intpos = (p < MaxPart) ? Tp->P[p].IntPos : Points[p - ImportedNodeOffset].IntPos;
+  MyIntPosType mask    = (((MyIntPosType)1) << (BITS_FOR_POSITIONS - 1 - nop->level));
+
+  /* skip the daughter nodes, they come first in the list */
+  int last_daughter = -1, q = nop->nextnode;
+
+  while(q >= MaxPart && q < MaxPart + MaxNodes && get_nodep(q)->father == no)
+    {
+      last_daughter = q;
+      q             = get_nodep(q)->sibling;
+    }
+
+  if(q >= MaxPart + MaxNodes && q < ImportedNodeOffset) /* the marker of an empty top-level leaf */
+    q = Nextnode[q - MaxNodes];
+
+  /* count the points in the same octant */
+  int count = 0;
+
+  for(int r = q; r != nop->sibling;)
+    {
+      MyIntPosType *intpos_r = (r < MaxPart) ? Tp->P[r].IntPos : Points[r - ImportedNodeOffset].IntPos;
+
+      if((intpos_r[0] & mask) == (intpos[0] & mask) && (intpos_r[1] & mask) == (intpos[1] & mask) &&
+         (intpos_r[2] & mask) == (intpos[2] & mask))
+        count++;
+
+      r = (r < MaxPart) ? Nextnode[r] : Nextnode[r - MaxNodes];
+    }
+
+  if(count >= TREE_NUM_BEFORE_NODESPLIT)
+    return 1;
+
+  int *nextp = (p < MaxPart) ? &Nextnode[p] : &Nextnode[p - MaxNodes];
+
+  if(q != nop->sibling)
+    {
+      /* put it behind the first point attached to the node */
+      int *nextq = (q < MaxPart) ? &Nextnode[q] : &Nextnode[q - MaxNodes];
+
+      *nextp = *nextq;
+      *nextq = p;
+    }
+  else if(last_daughter >= 0)
+    {
+      /* put it behind the daughter nodes, the whole branch below the last of them then needs to continue with it */
+      *nextp = q;
+      treeupdate_replace_link(last_daughter, q, p);
+    }
+  else
+    {
+      *nextp                = q;
+      nop->nextnode         = p;
+      nop->nextnode_shmrank = TreeSharedMem_ThisTask;
+    }
+
+  if(p < MaxPart)
+    Father[p] = no;
+  else
+    Father[p - MaxNodes - D->NTopleaves] = no;
+
+  return 0;
+}
+
+/*! In the threaded tree, the last entry of a branch refers to the entry that follows the branch. If this changes from 'old_next'
+ *  to 'new_next' for the branch below node 'no', this function updates all the references to it.
+ */
+template <typename node, typename partset, typename point_data, typename foreign_point_data>
+void tree<node, partset, point_data, foreign_point_data>::treeupdate_replace_link(int no, int old_next, int new_next)
+{
+  node *nop = get_nodep(no);
+
+  if(nop->nextnode == old_next) /* an empty node */
+    nop->nextnode = new_next;
+
+  int p = nop->nextnode;
+
+  while(p != new_next)
+    {
+      if(p >= MaxPart && p < MaxPart + MaxNodes) /* a daughter node */
+        {
+          if(get_nodep(p)->sibling == old_next) /* the last entry of the branch */
+            treeupdate_replace_link(p, old_next, new_next);
+
+          p = get_nodep(p)->sibling;
+        }
+      else
+        {
+          int *nextp = (p < MaxPart) ? &Nextnode[p] : &Nextnode[p - MaxNodes];
+
+          if(*nextp == old_next)
+            *nextp = new_next;
+
+          p = *nextp;
+        }
+    }
+
+  nop->sibling         = new_next;
+  nop->sibling_shmrank = TreeSharedMem_ThisTask;
+}
+
+/*! Returns the index of the outermost node to be reconstructed in a tree update that contains the node 'no'.
+ */
+template <typename node, typename partset, typename point_data, typename foreign_point_data>
+int tree<node, partset, point_data, foreign_point_data>::treeupdate_find_rebuild_index(int no, int *node_mark)
+{
+  int index = -1;
+
+  while(true)
+    {
+      if(node_mark[no - MaxPart] >= 2)
+        index = node_mark[no - MaxPart] - 2;
+
+      if(no < FirstNonTopLevelNode)
+        break;
+
+      no = get_nodep(no)->father;
+    }
+
+  if(index < 0)
+    Terminate("no node to be reconstructed found");
+
+  return index;
+}
+#endif
+
+/*! Computes the properties of the tree nodes once the particles have been linked into the tree. This is done first for the
+ *  branches below the local top leaves, then for the top-level nodes after the top-leaf data has been exchanged. Finally, the
+ *  access information needed by the tree walks is reset.
+ */
+template <typename node, typename partset, typename point_data, typename foreign_point_data>
+void tree<node, partset, point_data, foreign_point_data>::treebuild_node_properties(void)
+{
   /* first, construct the properties of the tree branches below the top leaves */
 
   int ntopleaves = D->NumTopleafOfTask[D->ThisTask];
@@ -159,15 +698,6 @@ int tree<node, partset, point_data, foreign_point_data>::treebuild(int ninsert,
     }
 
   tree_initialize_leaf_node_access_info();
-
-  double t1 = Logs.second();
-  Buildtime = Logs.timediff(t0, t1);
-
-  report_log_message();
-
-  TIMER_STOP(CPU_TREEBUILD_TOPLEVEL);
-
-  return NumNodes;
 }
 
 template <typename node, typename partset, typename point_data, typename foreign_point_data>
@@ -350,19 +880,16 @@ int tree<node, partset, point_data, foreign_point_data>::treebuild_construct(voi
           int n = Send_offset[task] + Send_count[task]++;
 
           fill_in_export_points(&export_Points[n], i, no);
+
+#ifdef GRAVITY_TREE_REUSE
+          Father[i] = -1 - task; /* remember where the particle went, this is needed for a later tree update */
+#endif
         }
     }
 
   /* exchange data */
-  for(int ngrp = 1; ngrp < (1 << D->PTask); ngrp++)
-    {
-      int recvTask = D->ThisTask ^ ngrp;
-      if(recvTask < D->NTask)
-        if(Send_count[recvTask] > 0 || Recv_count[recvTask] > 0)
-          myMPI_Sendrecv(&export_Points[Send_offset[recvTask]], Send_count[recvTask] * sizeof(point_data), MPI_BYTE, recvTask,
-                         TAG_DENS_A, &Points[Recv_offset[recvTask]], Recv_count[recvTask] * sizeof(point_data), MPI_BYTE, recvTask,
-                         TAG_DENS_A, D->Communicator, MPI_STATUS_IGNORE);
-    }
+  myMPI_Sparse_alltoallv(export_Points, Send_count, Send_offset, Points, Recv_count, Recv_offset, sizeof(point_data), TAG_DENS_A,
+                         D->Communicator);
 
   Mem.myfree(export_Points);
 
@@ -23,9 +23,12 @@
 
 #define TREE_MAX_ITER 100
 
+#define TREE_MAX_REINSERT_FRAC 0.25  // a tree update is replaced by a new construction beyond this fraction of relinked points
+
 #include "gadgetconfig.h"
 
 #include <mpi.h>
+#include <string.h>
 
 #include "../domain/domain.h"
 #include "../mpi_utils/shared_mem_handler.h"
@@ -248,6 +251,113 @@ class tree
     NewOnWorkStack++;
   }
 
+  /* When a tree walk is carried out by several threads, each of them gets its own slice of the buffers for new work stack entries
+   * and nodes to fetch. The slices are joined together again once all threads have finished a walk cycle.
+   */
+  struct walkthread_data
+  {
+    fetch_data *StackToFetch;
+    int NumOnFetchStack;
+    int MaxOnFetchStack;
+
+    workstack_data *NewWorkStack;
+    int NewOnWorkStack;
+    int MaxNewOnWorkStack;
+  };
+
+  inline int tree_get_free_stack_space(walkthread_data &wt)
+  {
+    return std::min<int>(wt.MaxNewOnWorkStack - wt.NewOnWorkStack, wt.MaxOnFetchStack - wt.NumOnFetchStack);
+  }
+
+  void tree_add_to_fetch_stack(walkthread_data &wt, node *nop, int nodetoopen, unsigned char shmrank)
+  {
+    if(wt.NumOnFetchStack >= wt.MaxOnFetchStack)
+      Terminate("we shouldn't get here");
+
+    node_bit_field mybit = (((node_bit_field)1) << Shmem.Island_ThisTask);
+
+    node_bit_field oldval = nop->flag_already_fetched.fetch_or(mybit);
+
+    if((oldval & mybit) == 0)  // it wasn't fetched by me (or one of my threads) yet
+      {
+        int ghostrank = Shmem.GetGhostRankForSimulCommRank[nop->OriginTask];
+
+        wt.StackToFetch[wt.NumOnFetchStack].NodeToOpen = nodetoopen;
+        wt.StackToFetch[wt.NumOnFetchStack].ShmRank    = shmrank;
+        wt.StackToFetch[wt.NumOnFetchStack].GhostRank  = ghostrank;
+
+        wt.NumOnFetchStack++;
+      }
+  }
+
+  void tree_add_to_work_stack(walkthread_data &wt, int target, int no, unsigned char shmrank, int mintopleafnode)
+  {
+    if(wt.NewOnWorkStack >= wt.MaxNewOnWorkStack)
+      Terminate("we shouldn't get here");
+
+    wt.NewWorkStack[wt.NewOnWorkStack].Target         = target;
+    wt.NewWorkStack[wt.NewOnWorkStack].Node           = no;
+    wt.NewWorkStack[wt.NewOnWorkStack].ShmRank        = shmrank;
+    wt.NewWorkStack[wt.NewOnWorkStack].MinTopLeafNode = mintopleafnode;
+
+    wt.NewOnWorkStack++;
+  }
+
+  /* divides the free part of the work stack and the fetch stack into equal slices, one for each thread that participates in the
+   * next cycle of a tree walk (thread_data needs to be derived from walkthread_data)
+   */
+  template <typename thread_data>
+  void tree_walkthreads_setup(thread_data *wt, int nthreads)
+  {
+    int newspace   = (MaxOnWorkStack - NumOnWorkStack) / nthreads;
+    int fetchspace = MaxOnFetchStack / nthreads;
+
+    for(int t = 0; t < nthreads; t++)
+      {
+        wt[t].NewWorkStack      = WorkStack + NumOnWorkStack + t * newspace;
+        wt[t].NewOnWorkStack    = 0;
+        wt[t].MaxNewOnWorkStack = newspace;
+
+        wt[t].StackToFetch    = StackToFetch + t * fetchspace;
+        wt[t].NumOnFetchStack = 0;
+        wt[t].MaxOnFetchStack = fetchspace;
+      }
+  }
+
+  /* after a cycle of a threaded tree walk, this removes the work stack entries that have been processed (they are marked with a
+   * negative target), and appends the new entries of all threads behind the remaining ones, preserving their order. Likewise, the
+   * nodes to be fetched are joined into one contiguous fetch stack. The number of processed entries is returned.
+   */
+  template <typename thread_data>
+  int tree_walkthreads_collect(thread_data *wt, int nthreads)
+  {
+    int nkeep = 0;
+
+    for(int i = 0; i < NumOnWorkStack; i++)
+      if(WorkStack[i].Target >= 0)
+        WorkStack[nkeep++] = WorkStack[i];
+
+    int nprocessed = NumOnWorkStack - nkeep;
+
+    NumOnFetchStack = 0;
+
+    for(int t = 0; t < nthreads; t++)
+      {
+        // note: the slices are located behind the old end of the stack, hence nkeep can never overtake the start of a slice
+        memmove(WorkStack + nkeep, wt[t].NewWorkStack, wt[t].NewOnWorkStack * sizeof(workstack_data));
+        nkeep += wt[t].NewOnWorkStack;
+
+        memmove(StackToFetch + NumOnFetchStack, wt[t].StackToFetch, wt[t].NumOnFetchStack * sizeof(fetch_data));
+        NumOnFetchStack += wt[t].NumOnFetchStack;
+      }
+
+    NumOnWorkStack = nkeep;
+    NewOnWorkStack = 0;
+
+    return nprocessed;
+  }
+
   struct node_count_info
   {
     int count_nodes;
@@ -321,6 +431,9 @@ class tree
 
   /** public functions */
   int treebuild(int ninsert, int *indexlist);
+#ifdef GRAVITY_TREE_REUSE
+  int treeupdate(void);
+#endif
   void treefree(void);
   void treeallocate(int max_partindex, partset *Pptr, domain<partset> *Dptr);
   void treeallocate_share_topnode_addresses(void);
@@ -411,10 +524,31 @@ class tree
     task = D->TaskOfLeaf[no];
   }
 
+  /* checks whether the given integer position lies inside the cube of the tree node 'no' */
+  inline bool tree_node_contains_point(int no, MyIntPosType *intpos)
+  {
+    node *nop         = get_nodep(no);
+    MyIntPosType mask = ~(~((MyIntPosType)0) >> nop->level);
+
+    for(int j = 0; j < 3; j++)
+      if((intpos[j] & mask) != (nop->center[j] & mask))
+        return false;
+
+    return true;
+  }
+
  private:
   /* private member functions */
 
   int treebuild_construct(void);
+  void treebuild_node_properties(void);
+#ifdef GRAVITY_TREE_REUSE
+  int treeupdate_find_node(int no, MyIntPosType *intpos);
+  void treeupdate_unlink_point(int p);
+  int treeupdate_link_point(int p, int no);
+  void treeupdate_replace_link(int no, int old_next, int new_next);
+  int treeupdate_find_rebuild_index(int no, int *node_mark);
+#endif
   int treebuild_insert_group_of_points(int num, index_data *index_list, int th, unsigned char level, int sibling);
   int create_empty_nodes(int no, int level, int topnode, int bits, int sibling, MyIntPosType x, MyIntPosType y, MyIntPosType z);
 
@@ -219,6 +219,8 @@ int Nyx::runlog_precision_terse = 6;
 int Nyx::write_parameters_in_plotfile = true;
 int Nyx::write_skip_prepost = 0;
 int Nyx::write_hdf5 = 0;
+int Nyx::write_raw_grids = 0;
+std::string Nyx::raw_grid_dir = "raw_grids";
 
 // Do we use separate SPH particles to initialize
 //  the density and momentum on the grid?
@@ -377,6 +379,13 @@ Nyx::read_params ()
     pp_nyx.query("runlog_precision_terse",runlog_precision_terse);
 
     pp_nyx.query("write_parameter_file",write_parameters_in_plotfile);
+    pp_nyx.query("write_raw_grids",write_raw_grids);
+    pp_nyx.query("raw_grid_dir",raw_grid_dir);
+    if (write_raw_grids < 0 || write_raw_grids > 2)
+        amrex::Error("write_raw_grids must be 0, 1 or 2");
+    // When only raw grids are wanted, don't write particles either
+    if (write_raw_grids == 2)
+        write_skip_prepost = 1;
     if(pp_nyx.query("write_hdf5",write_hdf5))
         write_skip_prepost = write_hdf5;
     else
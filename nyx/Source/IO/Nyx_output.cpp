@@ -105,29 +105,10 @@ Nyx::writePlotFilePre (const std::string& /*dir*/, ostream& /*os*/)
 #endif
 }
 
-void
-Nyx::writePlotFile (const std::string& dir,
-                    ostream&           os,
-                    VisMF::How         how)
+std::unique_ptr<MultiFab>
+Nyx::plotVarsMF (Vector<std::string>& varnames, Real cur_time)
 {
-
-#ifdef AMREX_USE_HDF5
-    if(write_hdf5==1 && parent->finestLevel() == 0)
-    {
-#ifdef NO_HYDRO
-    Real cur_time = state[PhiGrav_Type].curTime();
-#else
-    Real cur_time = state[State_Type].curTime();
-#endif
-
-    std::string dir_final = dir;
-    if(!amrex::AsyncOut::UseAsyncOut())
-    {
-        auto start_position_to_erase = dir_final.find(".temp");
-        dir_final.erase(start_position_to_erase,5);
-    }
-
-    int i, n;
+    int i;
     //
     // The list of indices of State to write to plotfile.
     // first component of pair is state_type,
@@ -212,9 +193,9 @@ Nyx::writePlotFile (const std::string& dir,
     // but a derived variable is allowed to have multiple components.
     int cnt = 0;
     const int nGrow = 0;
-    MultiFab plotMF(grids, dmap, n_data_items, nGrow);
+    auto plotMF = std::make_unique<MultiFab>(grids, dmap, n_data_items, nGrow);
     MultiFab* this_dat = 0;
-    Vector<std::string> varnames;
+    varnames.clear();
     //
     // Cull data from state variables -- use no ghost cells.
     //
@@ -224,26 +205,91 @@ Nyx::writePlotFile (const std::string& dir,
         int comp = plot_var_map[i].second;
         varnames.push_back(desc_lst[typ].name(comp));
         this_dat = &state[typ].newData();
-        MultiFab::Copy(plotMF, *this_dat, comp, cnt, 1, nGrow);
+        MultiFab::Copy(*plotMF, *this_dat, comp, cnt, 1, nGrow);
         cnt++;
     }
     //
     // Cull data from derived variables.
     //
-    if (derive_names.size() > 0)
+    for (std::list<std::string>::const_iterator it = derive_names.begin();
+         it != derive_names.end(); ++it)
     {
-      for (std::list<DeriveRec>::const_iterator it = derive_lst.dlist().begin();
-           it != derive_lst.dlist().end(); ++it)
-        {
-            varnames.push_back(it->name());
-            const auto& derive_dat = derive(it->name(), cur_time, nGrow);
-            MultiFab::Copy(plotMF, *derive_dat, 0, cnt, 1, nGrow);
-            cnt++;
-        }
+        varnames.push_back(*it);
+        const auto& derive_dat = derive(*it, cur_time, nGrow);
+        MultiFab::Copy(*plotMF, *derive_dat, 0, cnt, 1, nGrow);
+        cnt++;
+    }
+
+    return plotMF;
+}
+
+void
+Nyx::writeRawGrids (const std::string& dir)
+{
+    BL_PROFILE("Nyx::writeRawGrids()");
+
+#ifdef NO_HYDRO
+    Real cur_time = state[PhiGrav_Type].curTime();
+#else
+    Real cur_time = state[State_Type].curTime();
+#endif
+
+    //
+    // Name the files after the step number in the plotfile name, i.e.
+    // plt00100 gives raw_grid_dir/<variable>/00100.raw
+    //
+    std::string pltfile = dir;
+    auto start_position_to_erase = pltfile.rfind(".temp");
+    if (start_position_to_erase != std::string::npos)
+        pltfile.erase(start_position_to_erase, 5);
+    pltfile = pltfile.substr(pltfile.find_last_of('/') + 1);
+    std::string filename = pltfile.substr(pltfile.find_last_not_of("0123456789") + 1) + ".raw";
+
+    Vector<std::string> varnames;
+    auto plotMF = plotVarsMF(varnames, cur_time);
+
+    WriteRawGrids(raw_grid_dir, filename, *plotMF, varnames, geom.Domain());
+
+    if (verbose > 0)
+        amrex::Print() << "Wrote raw grids of " << varnames.size() << " variables to "
+                       << raw_grid_dir << "/<variable>/" << filename << '\n';
+}
+
+void
+Nyx::writePlotFile (const std::string& dir,
+                    ostream&           os,
+                    VisMF::How         how)
+{
+    //
+    // Raw grids are only written for level 0, which covers the whole domain.
+    //
+    if (write_raw_grids > 0 && level == 0)
+        writeRawGrids(dir);
+
+    if (write_raw_grids == 2)
+        return;
+
+#ifdef AMREX_USE_HDF5
+    if(write_hdf5==1 && parent->finestLevel() == 0)
+    {
+#ifdef NO_HYDRO
+    Real cur_time = state[PhiGrav_Type].curTime();
+#else
+    Real cur_time = state[State_Type].curTime();
+#endif
+
+    std::string dir_final = dir;
+    if(!amrex::AsyncOut::UseAsyncOut())
+    {
+        auto start_position_to_erase = dir_final.find(".temp");
+        dir_final.erase(start_position_to_erase,5);
     }
 
+    Vector<std::string> varnames;
+    auto plotMF = plotVarsMF(varnames, cur_time);
+
     WriteSingleLevelPlotfileHDF5(dir_final,
-                          plotMF, varnames,
+                          *plotMF, varnames,
                           Geom(), cur_time, nStep());
 //                          const std::string &versionName,
 //                          const std::string &levelPrefix,